@@ -36,11 +36,15 @@ public class MidiExtensions : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"AssetRegistry",
+				"Json",
 				"Slate",
 				"SlateCore",
 				"Harmonix",
 				"HarmonixMidi",
                 "AudioExtensions",
+				"AudioMixer",
+				"AudioMixerCore",
 				"DeveloperSettings"
 				// ... add private dependencies that you statically link with here ...	
 			}
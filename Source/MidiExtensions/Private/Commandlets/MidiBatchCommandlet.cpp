@@ -0,0 +1,407 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "Commandlets/MidiBatchCommandlet.h"
+#include "Commandlets/MidiNotesCacheCommandlet.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiFile/MidiNotesCache.h"
+#include "MidiFile/MidiFileStreamWriter.h"
+#include "HarmonixMidi/MidiFile.h"
+#include "HarmonixMidi/MidiTrack.h"
+#include "HarmonixMidi/MidiEvent.h"
+#include "HarmonixMidi/MidiMsg.h"
+#include "HarmonixMidi/SongMaps.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+namespace MidiBatch
+{
+	/** Files loaded and processed together, bounds how many are in memory at once */
+	static constexpr int32 DefaultBatchSize = 32;
+
+	double MsSince(double StartSeconds)
+	{
+		return (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+	}
+
+	FString GetPackageRelativePath(FName PackageName)
+	{
+		FString RelativePath = PackageName.ToString();
+		RelativePath.RemoveFromStart(TEXT("/"));
+		return RelativePath;
+	}
+
+	FString EscapeCsv(const FString& Value)
+	{
+		if (!Value.Contains(TEXT(",")) && !Value.Contains(TEXT("\"")) && !Value.Contains(TEXT("\n")))
+		{
+			return Value;
+		}
+		return TEXT("\"") + Value.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+	}
+
+	/** Adds Message to Error, a file can fail more than one output */
+	void AppendError(FString& Error, const FString& Message)
+	{
+		Error += Error.IsEmpty() ? Message : TEXT("; ") + Message;
+	}
+}
+
+UMidiBatchCommandlet::UMidiBatchCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UMidiBatchCommandlet::Main(const FString& Params)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	FString SearchPath = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Path="), SearchPath);
+
+	FString Ops = TEXT("Validate,Stats");
+	FParse::Value(*Params, TEXT("Ops="), Ops, false);
+
+	FOptions Options;
+	Options.bValidate = Ops.Contains(TEXT("Validate"));
+	Options.bStats = Ops.Contains(TEXT("Stats"));
+	Options.bExport = Ops.Contains(TEXT("Export"));
+	Options.bCache = Ops.Contains(TEXT("Cache"));
+
+	if (!FParse::Value(*Params, TEXT("OutputDir="), Options.OutputDir))
+	{
+		Options.OutputDir = FPaths::ProjectSavedDir() / TEXT("MidiBatch");
+	}
+	if (!FParse::Value(*Params, TEXT("CacheDir="), Options.CacheDir))
+	{
+		Options.CacheDir = FMidiNotesCacheWriter::GetDefaultCacheDirectory();
+	}
+
+	FString ReportPath;
+	if (!FParse::Value(*Params, TEXT("Report="), ReportPath))
+	{
+		ReportPath = Options.OutputDir / TEXT("MidiBatchReport.json");
+	}
+
+	int32 BatchSize = MidiBatch::DefaultBatchSize;
+	FParse::Value(*Params, TEXT("BatchSize="), BatchSize);
+	BatchSize = FMath::Max(1, BatchSize);
+
+	const bool bFailOnIssues = FParse::Param(*Params, TEXT("FailOnIssues"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UMidiFile::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.PackagePaths.Add(*SearchPath);
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+	UE_LOG(LogTemp, Display, TEXT("MidiBatch: %d MIDI files under %s, batches of %d"), Assets.Num(), *SearchPath, BatchSize);
+
+	TArray<FMidiBatchFileResult> Results;
+	Results.SetNum(Assets.Num());
+
+	for (int32 BatchStart = 0; BatchStart < Assets.Num(); BatchStart += BatchSize)
+	{
+		const int32 BatchEnd = FMath::Min(BatchStart + BatchSize, Assets.Num());
+
+		// Loading and proxy creation touch UObjects and stay on the game thread, the async loader reads the packages in parallel
+		const double BatchLoadStartSeconds = FPlatformTime::Seconds();
+		for (int32 AssetIndex = BatchStart; AssetIndex < BatchEnd; ++AssetIndex)
+		{
+			FMidiBatchFileResult& Result = Results[AssetIndex];
+			Result.PackageName = Assets[AssetIndex].PackageName;
+
+			// Timed from this file's own request, the loader works on the whole batch at once
+			const double LoadStartSeconds = FPlatformTime::Seconds();
+			LoadPackageAsync(Result.PackageName.ToString(), FLoadPackageAsyncDelegate::CreateLambda(
+				[&Result, LoadStartSeconds](const FName&, UPackage*, EAsyncLoadingResult::Type)
+				{
+					Result.LoadMs = MidiBatch::MsSince(LoadStartSeconds);
+				}));
+		}
+		FlushAsyncLoading();
+		UE_LOG(LogTemp, Display, TEXT("MidiBatch: Loaded files %d-%d in %.1f ms"), BatchStart, BatchEnd - 1, MidiBatch::MsSince(BatchLoadStartSeconds));
+
+		TArray<UMidiFile*> MidiFiles;
+		TArray<TSharedPtr<Audio::IProxyData>> ExportProxies;
+		TArray<const FMidiFileData*> ExportData;
+		MidiFiles.SetNumZeroed(BatchEnd - BatchStart);
+		ExportProxies.SetNum(BatchEnd - BatchStart);
+		ExportData.SetNumZeroed(BatchEnd - BatchStart);
+		for (int32 AssetIndex = BatchStart; AssetIndex < BatchEnd; ++AssetIndex)
+		{
+			const int32 BatchIndex = AssetIndex - BatchStart;
+			MidiFiles[BatchIndex] = Cast<UMidiFile>(Assets[AssetIndex].FastGetAsset(false));
+			Results[AssetIndex].bLoaded = MidiFiles[BatchIndex] != nullptr;
+			if (!MidiFiles[BatchIndex])
+			{
+				Results[AssetIndex].Error = TEXT("Failed to load");
+				continue;
+			}
+
+			if (Options.bCache)
+			{
+				Results[AssetIndex].SourceStamp = UMidiNotesCacheCommandlet::GetPackageSourceStamp(Results[AssetIndex].PackageName);
+			}
+
+			if (Options.bExport)
+			{
+				// The proxy holds a complete copy of the file's data that stays valid while the workers write it
+				Audio::FProxyDataInitParams InitParams{ TEXT("MidiBatch") };
+				ExportProxies[BatchIndex] = MidiFiles[BatchIndex]->CreateProxyData(InitParams);
+				ExportData[BatchIndex] = &*StaticCastSharedPtr<FMidiFileProxy>(ExportProxies[BatchIndex])->GetMidiFile();
+			}
+		}
+
+		// The files are only read from here on, nothing collects garbage until the batch is done
+		ParallelFor(BatchEnd - BatchStart, [&](int32 BatchIndex)
+		{
+			if (UMidiFile* MidiFile = MidiFiles[BatchIndex])
+			{
+				ProcessFile(MidiFile, ExportData[BatchIndex], Options, Results[BatchStart + BatchIndex]);
+			}
+		}, EParallelForFlags::Unbalanced);
+
+		ExportProxies.Reset();
+		ExportData.Reset();
+		MidiFiles.Reset();
+		CollectGarbage(RF_NoFlags);
+
+		UE_LOG(LogTemp, Display, TEXT("MidiBatch: %d / %d files processed"), BatchEnd, Assets.Num());
+	}
+
+	const double TotalSeconds = FPlatformTime::Seconds() - StartSeconds;
+	const bool bReportWritten = ReportPath.EndsWith(TEXT(".csv"), ESearchCase::IgnoreCase)
+		? WriteCsvReport(ReportPath, Results)
+		: WriteJsonReport(ReportPath, Results, TotalSeconds);
+
+	int32 NumFailed = 0;
+	int32 NumWithIssues = 0;
+	for (const FMidiBatchFileResult& Result : Results)
+	{
+		NumFailed += Result.Error.IsEmpty() ? 0 : 1;
+		NumWithIssues += Result.Issues.IsEmpty() ? 0 : 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("MidiBatch: %d files in %.1f s, %d failed, %d with issues, report in '%s'"), Results.Num(), TotalSeconds, NumFailed, NumWithIssues, *ReportPath);
+	if (!bReportWritten)
+	{
+		UE_LOG(LogTemp, Error, TEXT("MidiBatch: Could not write the report to %s"), *ReportPath);
+	}
+
+	return bReportWritten && NumFailed == 0 && (!bFailOnIssues || NumWithIssues == 0) ? 0 : 1;
+}
+
+void UMidiBatchCommandlet::ProcessFile(UMidiFile* MidiFile, const FMidiFileData* ExportData, const FOptions& Options, FMidiBatchFileResult& Result)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMidiBatchCommandlet::ProcessFile);
+	const double ProcessStartSeconds = FPlatformTime::Seconds();
+
+	double StepStartSeconds = FPlatformTime::Seconds();
+	const TSharedPtr<FMidiNotesData> NotesData = FMidiNotesData::BuildFromMidiFile(MidiFile);
+	Result.BuildMs = MidiBatch::MsSince(StepStartSeconds);
+
+	if (Options.bValidate)
+	{
+		StepStartSeconds = FPlatformTime::Seconds();
+
+		int32 NumFileNotes = 0;
+		for (const FMidiNotesTrack& Track : NotesData->Tracks)
+		{
+			NumFileNotes += Track.Notes.Num();
+
+			// The notes are sorted by onset, a note starting before the previous note of its pitch ended overlaps it
+			int32 NumWithoutLength = 0;
+			int32 NumOverlapping = 0;
+			int32 LastNoteOffTicks[128];
+			for (int32& LastNoteOffTick : LastNoteOffTicks)
+			{
+				LastNoteOffTick = TNumericLimits<int32>::Lowest();
+			}
+			for (const FLinkedMidiNote& Note : Track.Notes)
+			{
+				NumWithoutLength += Note.NoteOffTick <= Note.NoteOnTick ? 1 : 0;
+				int32& LastNoteOffTick = LastNoteOffTicks[FLinkedMidiNote::ClampNoteNumber(Note.NoteNumber)];
+				NumOverlapping += Note.NoteOnTick < LastNoteOffTick ? 1 : 0;
+				LastNoteOffTick = FMath::Max(LastNoteOffTick, Note.NoteOffTick);
+			}
+
+			if (NumWithoutLength > 0)
+			{
+				Result.Issues.Add(FString::Printf(TEXT("Track %d '%s' channel %d: %d notes without length"), Track.TrackIndex, *Track.TrackName, Track.ChannelIndex, NumWithoutLength));
+			}
+			if (NumOverlapping > 0)
+			{
+				Result.Issues.Add(FString::Printf(TEXT("Track %d '%s' channel %d: %d notes overlap a note of the same pitch"), Track.TrackIndex, *Track.TrackName, Track.ChannelIndex, NumOverlapping));
+			}
+		}
+
+		if (NumFileNotes == 0)
+		{
+			Result.Issues.Add(TEXT("No notes"));
+		}
+
+		Result.ValidateMs = MidiBatch::MsSince(StepStartSeconds);
+	}
+
+	if (Options.bStats)
+	{
+		Result.NumTracks = MidiFile->GetNumTracks();
+		Result.NumNoteTracks = NotesData->Tracks.Num();
+		Result.LengthTicks = NotesData->LastNoteOffTick;
+		for (const FMidiNotesTrack& Track : NotesData->Tracks)
+		{
+			Result.NumNotes += Track.Notes.Num();
+			if (Track.LowestNoteNumber != INDEX_NONE)
+			{
+				Result.LowestNoteNumber = Result.LowestNoteNumber == INDEX_NONE ? Track.LowestNoteNumber : FMath::Min(Result.LowestNoteNumber, Track.LowestNoteNumber);
+				Result.HighestNoteNumber = FMath::Max(Result.HighestNoteNumber, Track.HighestNoteNumber);
+			}
+		}
+		for (const FMidiControllerLane& Lane : NotesData->ControllerLanes)
+		{
+			Result.NumControllerPoints += Lane.Ticks.Num();
+		}
+		for (int32 TrackIndex = 0; TrackIndex < Result.NumTracks; ++TrackIndex)
+		{
+			if (const FMidiTrack* Track = MidiFile->GetTrack(TrackIndex))
+			{
+				for (const FMidiEvent& Event : Track->GetEvents())
+				{
+					Result.NumTempoChanges += Event.GetMsg().IsTempo() ? 1 : 0;
+				}
+			}
+		}
+		if (const FSongMaps* SongMaps = MidiFile->GetSongMaps())
+		{
+			Result.LengthMs = SongMaps->TickToMs(Result.LengthTicks);
+		}
+	}
+
+	if (Options.bExport && ExportData)
+	{
+		StepStartSeconds = FPlatformTime::Seconds();
+		const FString ExportPath = Options.OutputDir / MidiBatch::GetPackageRelativePath(Result.PackageName) + TEXT(".mid");
+		Result.bExported = FMidiFileStreamWriter::WriteToFile(*ExportData, ExportPath);
+		if (!Result.bExported)
+		{
+			MidiBatch::AppendError(Result.Error, FString::Printf(TEXT("Failed to export to %s"), *ExportPath));
+		}
+		Result.ExportMs = MidiBatch::MsSince(StepStartSeconds);
+	}
+
+	if (Options.bCache)
+	{
+		StepStartSeconds = FPlatformTime::Seconds();
+		const FString CachePath = FMidiNotesCacheWriter::GetCacheFilePath(Options.CacheDir, Result.PackageName);
+		Result.bCached = FMidiNotesCacheWriter::WriteToFile(MidiFile, *NotesData, CachePath, Result.SourceStamp);
+		if (!Result.bCached)
+		{
+			MidiBatch::AppendError(Result.Error, FString::Printf(TEXT("Failed to write the cache to %s"), *CachePath));
+		}
+		Result.CacheMs = MidiBatch::MsSince(StepStartSeconds);
+	}
+
+	Result.ProcessMs = MidiBatch::MsSince(ProcessStartSeconds);
+}
+
+bool UMidiBatchCommandlet::WriteJsonReport(const FString& ReportPath, TConstArrayView<FMidiBatchFileResult> Results, double TotalSeconds)
+{
+	FString Json;
+	const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("numFiles"), Results.Num());
+	Writer->WriteValue(TEXT("totalSeconds"), TotalSeconds);
+	Writer->WriteArrayStart(TEXT("files"));
+	for (const FMidiBatchFileResult& Result : Results)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("package"), Result.PackageName.ToString());
+		Writer->WriteValue(TEXT("loaded"), Result.bLoaded);
+		if (!Result.Error.IsEmpty())
+		{
+			Writer->WriteValue(TEXT("error"), Result.Error);
+		}
+
+		Writer->WriteValue(TEXT("tracks"), Result.NumTracks);
+		Writer->WriteValue(TEXT("noteTracks"), Result.NumNoteTracks);
+		Writer->WriteValue(TEXT("notes"), Result.NumNotes);
+		Writer->WriteValue(TEXT("controllerPoints"), Result.NumControllerPoints);
+		Writer->WriteValue(TEXT("tempoChanges"), Result.NumTempoChanges);
+		Writer->WriteValue(TEXT("lowestNote"), Result.LowestNoteNumber);
+		Writer->WriteValue(TEXT("highestNote"), Result.HighestNoteNumber);
+		Writer->WriteValue(TEXT("lengthTicks"), Result.LengthTicks);
+		Writer->WriteValue(TEXT("lengthMs"), Result.LengthMs);
+		Writer->WriteValue(TEXT("exported"), Result.bExported);
+		Writer->WriteValue(TEXT("cached"), Result.bCached);
+
+		Writer->WriteArrayStart(TEXT("issues"));
+		for (const FString& Issue : Result.Issues)
+		{
+			Writer->WriteValue(Issue);
+		}
+		Writer->WriteArrayEnd();
+
+		Writer->WriteObjectStart(TEXT("timingsMs"));
+		Writer->WriteValue(TEXT("load"), Result.LoadMs);
+		Writer->WriteValue(TEXT("build"), Result.BuildMs);
+		Writer->WriteValue(TEXT("validate"), Result.ValidateMs);
+		Writer->WriteValue(TEXT("export"), Result.ExportMs);
+		Writer->WriteValue(TEXT("cache"), Result.CacheMs);
+		Writer->WriteValue(TEXT("process"), Result.ProcessMs);
+		Writer->WriteObjectEnd();
+
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	return FFileHelper::SaveStringToFile(Json, *ReportPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+bool UMidiBatchCommandlet::WriteCsvReport(const FString& ReportPath, TConstArrayView<FMidiBatchFileResult> Results)
+{
+	TStringBuilder<4096> Csv;
+	Csv << TEXT("Package,Loaded,Error,Tracks,NoteTracks,Notes,ControllerPoints,TempoChanges,LowestNote,HighestNote,LengthTicks,LengthMs,Exported,Cached,Issues,LoadMs,BuildMs,ValidateMs,ExportMs,CacheMs,ProcessMs\n");
+	for (const FMidiBatchFileResult& Result : Results)
+	{
+		Csv.Appendf(TEXT("%s,%d,%s,%d,%d,%d,%d,%d,%d,%d,%d,%.3f,%d,%d,%s,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+			*MidiBatch::EscapeCsv(Result.PackageName.ToString()),
+			Result.bLoaded ? 1 : 0,
+			*MidiBatch::EscapeCsv(Result.Error),
+			Result.NumTracks,
+			Result.NumNoteTracks,
+			Result.NumNotes,
+			Result.NumControllerPoints,
+			Result.NumTempoChanges,
+			Result.LowestNoteNumber,
+			Result.HighestNoteNumber,
+			Result.LengthTicks,
+			Result.LengthMs,
+			Result.bExported ? 1 : 0,
+			Result.bCached ? 1 : 0,
+			*MidiBatch::EscapeCsv(FString::Join(Result.Issues, TEXT("; "))),
+			Result.LoadMs,
+			Result.BuildMs,
+			Result.ValidateMs,
+			Result.ExportMs,
+			Result.CacheMs,
+			Result.ProcessMs);
+	}
+
+	return FFileHelper::SaveStringToFile(Csv.ToView(), *ReportPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
@@ -0,0 +1,91 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "Commandlets/MidiNotesCacheCommandlet.h"
+#include "MidiFile/MidiNotesCache.h"
+#include "HarmonixMidi/MidiFile.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+
+UMidiNotesCacheCommandlet::UMidiNotesCacheCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+uint64 UMidiNotesCacheCommandlet::GetPackageSourceStamp(FName PackageName)
+{
+	FString PackageFilename;
+	if (!FPackageName::DoesPackageExist(PackageName.ToString(), &PackageFilename))
+	{
+		return 0;
+	}
+
+	const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*PackageFilename);
+	return TimeStamp == FDateTime::MinValue() ? 0 : static_cast<uint64>(TimeStamp.GetTicks());
+}
+
+int32 UMidiNotesCacheCommandlet::Main(const FString& Params)
+{
+	FString SearchPath = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Path="), SearchPath);
+
+	FString OutputDir;
+	if (!FParse::Value(*Params, TEXT("OutputDir="), OutputDir))
+	{
+		OutputDir = FMidiNotesCacheWriter::GetDefaultCacheDirectory();
+	}
+
+	const bool bForce = FParse::Param(*Params, TEXT("Force"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UMidiFile::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.PackagePaths.Add(*SearchPath);
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	int32 NumWritten = 0;
+	int32 NumUpToDate = 0;
+	int32 NumFailed = 0;
+	int32 NumLoaded = 0;
+	for (const FAssetData& Asset : Assets)
+	{
+		const FString CachePath = FMidiNotesCacheWriter::GetCacheFilePath(OutputDir, Asset.PackageName);
+		const uint64 SourceStamp = GetPackageSourceStamp(Asset.PackageName);
+
+		if (!bForce && SourceStamp != 0 && FMidiNotesCacheFile::Open(CachePath, SourceStamp).IsValid())
+		{
+			++NumUpToDate;
+			continue;
+		}
+
+		UMidiFile* MidiFile = Cast<UMidiFile>(Asset.GetAsset());
+		if (MidiFile && FMidiNotesCacheWriter::WriteToFile(MidiFile, CachePath, SourceStamp))
+		{
+			++NumWritten;
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("MidiNotesCache: Failed to write the cache of %s"), *Asset.GetObjectPathString());
+			++NumFailed;
+		}
+
+		// Catalogues can hold thousands of files, don't keep them all loaded
+		if (++NumLoaded % 100 == 0)
+		{
+			CollectGarbage(RF_NoFlags);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("MidiNotesCache: %d written, %d up to date, %d failed, caches in '%s'"), NumWritten, NumUpToDate, NumFailed, *OutputDir);
+	return NumFailed == 0 ? 0 : 1;
+}
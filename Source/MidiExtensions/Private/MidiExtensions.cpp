@@ -1,6 +1,17 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MidiExtensions.h"
+#include "MidiExtensionsStats.h"
+
+DEFINE_STAT(STAT_MidiExtensions_BuildFromMidiFile);
+DEFINE_STAT(STAT_MidiExtensions_ModifyNotes);
+DEFINE_STAT(STAT_MidiExtensions_BuildQueryIndex);
+DEFINE_STAT(STAT_MidiExtensions_TransformNotes);
+DEFINE_STAT(STAT_MidiExtensions_Quantize);
+DEFINE_STAT(STAT_MidiExtensions_ReadStandardMidiFile);
+DEFINE_STAT(STAT_MidiExtensions_WriteStandardMidiFile);
+DEFINE_STAT(STAT_MidiExtensions_PackedNotesMemory);
+DEFINE_STAT(STAT_MidiExtensions_PackedNotesUnpackedMemory);
 
 #define LOCTEXT_NAMESPACE "FMidiExtensionsModule"
 
@@ -2,10 +2,53 @@
 
 
 #include "MidiExtensionsHelperLib.h"
+#include "MidiFile/MidiNotesDataHandle.h"
+#include "MidiFile/MutableMidiFile.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
 
-FMidiFileIterator UMidiExtensionsHelperLib::MakeMidiFileIterator(FMidiNotesData MidiDataPtr)
+FMidiFileIterator UMidiExtensionsHelperLib::MakeMidiFileIterator(UMidiFile* MidiFile)
 {
-	return FMidiFileIterator();
+	if (!MidiFile)
+	{
+		return FMidiFileIterator();
+	}
+
+	return FMidiFileIterator(FMidiNotesData::BuildFromMidiFile(MidiFile));
+}
+
+bool UMidiExtensionsHelperLib::IsMidiFileIteratorValid(const FMidiFileIterator& Iterator)
+{
+	return Iterator.IsValid();
+}
+
+bool UMidiExtensionsHelperLib::GetMidiFileIteratorNote(const FMidiFileIterator& Iterator, int32& TrackIndex, int32& NoteOnTick, int32& NoteOffTick, int32& NoteNumber, int32& Velocity)
+{
+	if (!Iterator.IsValid())
+	{
+		TrackIndex = INDEX_NONE;
+		NoteOnTick = NoteOffTick = NoteNumber = Velocity = 0;
+		return false;
+	}
+
+	const FLinkedMidiNote& Note = Iterator.GetCurrentNote();
+	TrackIndex = Iterator.GetCurrentTrackIndex();
+	NoteOnTick = Note.NoteOnTick;
+	NoteOffTick = Note.NoteOffTick;
+	NoteNumber = Note.NoteNumber;
+	Velocity = Note.Velocity;
+	return true;
+}
+
+bool UMidiExtensionsHelperLib::AdvanceMidiFileIterator(FMidiFileIterator& Iterator)
+{
+	Iterator.Advance();
+	return Iterator.IsValid();
+}
+
+void UMidiExtensionsHelperLib::SeekMidiFileIterator(FMidiFileIterator& Iterator, int32 Tick)
+{
+	Iterator.SeekToTick(Tick);
 }
 
 FMidiNotesData UMidiExtensionsHelperLib::MakeMidiNotesData(UMidiFile* MidiFile)
@@ -14,3 +57,23 @@ FMidiNotesData UMidiExtensionsHelperLib::MakeMidiNotesData(UMidiFile* MidiFile)
 
 	return *MidiNotesData;
 }
+
+UMidiNotesDataHandle* UMidiExtensionsHelperLib::MakeMidiNotesDataHandle(UMidiFile* MidiFile)
+{
+	return UMidiNotesDataHandle::Create(MidiFile, FMidiNotesData::BuildFromMidiFile(MidiFile));
+}
+
+UMutableMidiFile* UMidiExtensionsHelperLib::LoadMidiFileFromDisk(const FString& FilePath)
+{
+	const FName ObjectName = MakeUniqueObjectName(GetTransientPackage(), UMutableMidiFile::StaticClass(), FName(FPaths::GetBaseFilename(FilePath)));
+	UMutableMidiFile* MidiFile = NewObject<UMutableMidiFile>(GetTransientPackage(), ObjectName);
+	return MidiFile->InitializeFromStandardMidiFile(FilePath) ? MidiFile : nullptr;
+}
+
+void UMidiExtensionsHelperLib::BreakLinkedMidiNote(const FLinkedMidiNote& Note, int32& NoteOnTick, int32& NoteOffTick, int32& NoteNumber, int32& Velocity)
+{
+	NoteOnTick = Note.NoteOnTick;
+	NoteOffTick = Note.NoteOffTick;
+	NoteNumber = Note.NoteNumber;
+	Velocity = Note.Velocity;
+}
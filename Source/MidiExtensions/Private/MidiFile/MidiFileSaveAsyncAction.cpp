@@ -0,0 +1,44 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiFileSaveAsyncAction.h"
+#include "MidiFile/MutableMidiFile.h"
+
+UMidiFileSaveAsyncAction* UMidiFileSaveAsyncAction::SaveMidiFileAsAssetAsync(UMutableMidiFile* MidiFile, const FString& PackagePath, const FString& AssetName)
+{
+	UMidiFileSaveAsyncAction* Action = NewObject<UMidiFileSaveAsyncAction>();
+	Action->MidiFile = MidiFile;
+	Action->PackagePath = PackagePath;
+	Action->AssetName = AssetName;
+	return Action;
+}
+
+void UMidiFileSaveAsyncAction::Activate()
+{
+	if (!MidiFile)
+	{
+		HandleSaved(nullptr, false);
+		return;
+	}
+
+	// Editor utilities have no game instance to register with, so the action roots itself until the save completes
+	AddToRoot();
+	MidiFile->SaveAsAssetAsync(PackagePath, AssetName, FOnMidiFileSaved::CreateUObject(this, &UMidiFileSaveAsyncAction::HandleSaved));
+}
+
+void UMidiFileSaveAsyncAction::HandleSaved(UMidiFile* SavedFile, bool bSuccess)
+{
+	if (bSuccess)
+	{
+		OnSaved.Broadcast(SavedFile);
+	}
+	else
+	{
+		OnFailed.Broadcast(nullptr);
+	}
+
+	if (IsRooted())
+	{
+		RemoveFromRoot();
+	}
+	SetReadyToDestroy();
+}
@@ -0,0 +1,666 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiFileStreamReader.h"
+#include "HarmonixMidi/MidiConstants.h"
+#include "HarmonixMidi/MidiEvent.h"
+#include "HarmonixMidi/MidiMsg.h"
+#include "HarmonixMidi/SongMaps.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Algo/Sort.h"
+#include "MidiExtensionsStats.h"
+
+namespace
+{
+	constexpr uint32 HeaderChunkId = 0x4D546864; // MThd
+	constexpr uint32 TrackChunkId = 0x4D54726B; // MTrk
+	constexpr uint32 ChunkHeaderSize = 8;
+
+	constexpr int32 NumChannels = 16;
+	constexpr int32 NumKeys = 128;
+
+	// Controller lane lookup per track: control changes and poly aftertouch per number, then pitch bend and channel aftertouch
+	constexpr int32 LaneLookupPerChannel = NumKeys * 2 + 2;
+
+	constexpr int32 DefaultMicrosecondsPerQuarterNote = 500000;
+
+	/** Big endian reader over one chunk, reads past the end return 0 and set bFailed */
+	struct FSmfByteReader
+	{
+		const uint8* Cursor;
+		const uint8* End;
+		bool bFailed = false;
+
+		explicit FSmfByteReader(TConstArrayView<uint8> Bytes)
+			: Cursor(Bytes.GetData())
+			, End(Bytes.GetData() + Bytes.Num())
+		{
+		}
+
+		bool HasData() const { return Cursor < End && !bFailed; }
+
+		int64 Remaining() const { return End - Cursor; }
+
+		uint8 PeekByte() const { return Cursor < End ? *Cursor : 0; }
+
+		uint8 ReadByte()
+		{
+			if (Cursor < End)
+			{
+				return *Cursor++;
+			}
+			bFailed = true;
+			return 0;
+		}
+
+		uint16 ReadUInt16()
+		{
+			const uint16 High = ReadByte();
+			return (High << 8) | ReadByte();
+		}
+
+		uint32 ReadUInt32()
+		{
+			const uint32 High = ReadUInt16();
+			return (High << 16) | ReadUInt16();
+		}
+
+		/** Variable length quantity, at most four bytes */
+		uint32 ReadVarLen()
+		{
+			uint32 Value = 0;
+			for (int32 ByteIndex = 0; ByteIndex < 4; ++ByteIndex)
+			{
+				const uint8 Byte = ReadByte();
+				Value = (Value << 7) | (Byte & 0x7F);
+				if ((Byte & 0x80) == 0)
+				{
+					return Value;
+				}
+			}
+			bFailed = true;
+			return Value;
+		}
+
+		TConstArrayView<uint8> ReadBytes(uint32 Num)
+		{
+			if (Num > Remaining())
+			{
+				bFailed = true;
+				Cursor = End;
+				return TConstArrayView<uint8>();
+			}
+			const TConstArrayView<uint8> Bytes(Cursor, Num);
+			Cursor += Num;
+			return Bytes;
+		}
+	};
+
+	/** Accumulates the result while the chunks of a file are parsed */
+	class FSmfBuilder
+	{
+	public:
+		FSmfBuilder(FMidiFileStreamResult& InResult, EMidiFileStreamFlags Flags)
+			: Result(InResult)
+			, bBuildMidiTracks(EnumHasAnyFlags(Flags, EMidiFileStreamFlags::BuildMidiTracks))
+		{
+			Result.NotesData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>();
+			Result.SongMaps = MakeShared<FSongMaps, ESPMode::ThreadSafe>();
+			Result.MidiTracks.Reset();
+
+			ActiveNoteOnTicks.SetNumUninitialized(NumChannels * NumKeys);
+			ActiveNoteVelocities.SetNumUninitialized(NumChannels * NumKeys);
+			LaneLookup.SetNumUninitialized(NumChannels * LaneLookupPerChannel);
+		}
+
+		bool HasHeader() const { return TicksPerQuarterNote > 0; }
+
+		bool ParseHeader(TConstArrayView<uint8> Body)
+		{
+			FSmfByteReader Reader(Body);
+			Result.Format = Reader.ReadUInt16();
+			const int32 DeclaredNumTracks = Reader.ReadUInt16();
+			const uint16 Division = Reader.ReadUInt16();
+
+			if (Reader.bFailed)
+			{
+				Result.Error = TEXT("Truncated header chunk");
+				return false;
+			}
+			if (Result.Format > 2)
+			{
+				Result.Error = FString::Printf(TEXT("Unsupported SMF format %d"), Result.Format);
+				return false;
+			}
+			if ((Division & 0x8000) != 0 || Division == 0)
+			{
+				Result.Error = TEXT("SMPTE time division is not supported");
+				return false;
+			}
+
+			TicksPerQuarterNote = Division;
+			Result.FileTicksPerQuarterNote = Division;
+			TrackNames.Reserve(DeclaredNumTracks);
+			if (bBuildMidiTracks)
+			{
+				Result.MidiTracks.Reserve(DeclaredNumTracks);
+			}
+			return true;
+		}
+
+		bool ParseTrack(TConstArrayView<uint8> Body)
+		{
+			const int32 TrackIndex = Result.NumTracks++;
+
+			FMemory::Memset(ActiveNoteOnTicks.GetData(), 0xFF, ActiveNoteOnTicks.Num() * sizeof(int32));
+			FMemory::Memset(LaneLookup.GetData(), 0xFF, LaneLookup.Num() * sizeof(int32));
+			for (int32& NotesTrackIndex : ChannelNotesTracks)
+			{
+				NotesTrackIndex = INDEX_NONE;
+			}
+
+			FString TrackName;
+			int32 PrimaryChannel = INDEX_NONE;
+			TArray<FMidiEvent> TrackEvents;
+
+			FSmfByteReader Reader(Body);
+			uint64 FileTick = 0;
+			uint8 RunningStatus = 0;
+
+			while (Reader.HasData())
+			{
+				FileTick += Reader.ReadVarLen();
+				const int32 Tick = ToTick(FileTick);
+
+				uint8 Status = Reader.PeekByte();
+				if (Status & 0x80)
+				{
+					Reader.ReadByte();
+				}
+				else if (RunningStatus != 0)
+				{
+					Status = RunningStatus;
+				}
+				else
+				{
+					Result.Error = FString::Printf(TEXT("Track %d: data byte without running status"), TrackIndex);
+					return false;
+				}
+
+				if (Status == 0xFF)
+				{
+					// Running status is kept across meta and sysex events, some writers rely on it even though the spec cancels it
+					const uint8 MetaType = Reader.ReadByte();
+					const TConstArrayView<uint8> Data = Reader.ReadBytes(Reader.ReadVarLen());
+					if (MetaType == 0x2F)
+					{
+						break;
+					}
+					HandleMetaEvent(MetaType, Data, Tick, TrackName, TrackEvents);
+					continue;
+				}
+
+				if (Status == 0xF0 || Status == 0xF7)
+				{
+					Reader.ReadBytes(Reader.ReadVarLen());
+					continue;
+				}
+
+				if (Status > 0xF0)
+				{
+					// System common and real-time messages have no place in a file, skip them with their data bytes:
+					// MTC quarter frame and song select carry one, song position two, the rest none
+					const uint32 NumDataBytes = (Status == 0xF1 || Status == 0xF3) ? 1 : (Status == 0xF2 ? 2 : 0);
+					Reader.ReadBytes(NumDataBytes);
+					continue;
+				}
+
+				RunningStatus = Status;
+				const uint8 Command = Status & 0xF0;
+				const int32 Channel = Status & 0x0F;
+				const uint8 Data1 = Reader.ReadByte() & 0x7F;
+				const uint8 Data2 = (Command == 0xC0 || Command == 0xD0) ? 0 : (Reader.ReadByte() & 0x7F);
+				if (Reader.bFailed)
+				{
+					// The data bytes ran past the end of the track, don't emit an event built from zeroes
+					break;
+				}
+
+				if (PrimaryChannel == INDEX_NONE)
+				{
+					PrimaryChannel = Channel;
+				}
+				if (bBuildMidiTracks)
+				{
+					TrackEvents.Emplace(Tick, FMidiMsg(Status, Data1, Data2));
+				}
+
+				HandleChannelEvent(TrackIndex, Command, Channel, Data1, Data2, Tick);
+			}
+
+			if (Reader.bFailed)
+			{
+				// A truncated last event is common enough in the wild to keep everything before it
+				UE_LOG(LogTemp, Warning, TEXT("FMidiFileStreamReader: Track %d is truncated or malformed, events after the damage are ignored"), TrackIndex);
+			}
+
+			NameNotesTracks(TrackName, PrimaryChannel);
+			TrackNames.Add(TrackName);
+			PrimaryChannels.Add(PrimaryChannel == INDEX_NONE ? 0 : PrimaryChannel);
+
+			if (bBuildMidiTracks)
+			{
+				FMidiTrack& MidiTrack = Result.MidiTracks.Emplace_GetRef(TrackName);
+				for (FMidiEvent& Event : TrackEvents)
+				{
+					MidiTrack.AddEvent(MoveTemp(Event));
+				}
+			}
+			return true;
+		}
+
+		void Finish()
+		{
+			FMidiNotesData& NotesData = *Result.NotesData;
+
+			// Same fallback as BuildFromMidiFile, a file without notes gets one entry per track
+			if (NotesData.Tracks.IsEmpty())
+			{
+				for (int32 TrackIndex = 0; TrackIndex < Result.NumTracks; ++TrackIndex)
+				{
+					FMidiNotesTrack& NotesTrack = NotesData.Tracks.AddDefaulted_GetRef();
+					NotesTrack.TrackIndex = TrackIndex;
+					NotesTrack.ChannelIndex = PrimaryChannels[TrackIndex];
+					NotesTrack.TrackName = TrackNames[TrackIndex].IsEmpty() ? FString::Printf(TEXT("Track Ch:%d"), NotesTrack.ChannelIndex) : TrackNames[TrackIndex];
+				}
+			}
+			NotesData.FinishBuild();
+
+			// Harmonix expects a tempo and a time signature at tick 0
+			Algo::StableSortBy(TempoChanges, [](const FTempoChange& Change) { return Change.Tick; });
+			Algo::StableSortBy(TimeSigChanges, [](const FTimeSigChange& Change) { return Change.Tick; });
+			if (TempoChanges.IsEmpty() || TempoChanges[0].Tick > 0)
+			{
+				TempoChanges.Insert({ 0, DefaultMicrosecondsPerQuarterNote }, 0);
+				if (bBuildMidiTracks && !Result.MidiTracks.IsEmpty())
+				{
+					Result.MidiTracks[0].AddEvent(FMidiEvent(0, FMidiMsg::CreateTempo(DefaultMicrosecondsPerQuarterNote)));
+				}
+			}
+			if (TimeSigChanges.IsEmpty() || TimeSigChanges[0].Tick > 0)
+			{
+				TimeSigChanges.Insert({ 0, 4, 4 }, 0);
+				if (bBuildMidiTracks && !Result.MidiTracks.IsEmpty())
+				{
+					Result.MidiTracks[0].AddEvent(FMidiEvent(0, FMidiMsg::CreateTimeSig(4, 4)));
+				}
+			}
+
+			FSongMaps& SongMaps = *Result.SongMaps;
+			SongMaps.Init(Harmonix::Midi::Constants::GTicksPerQuarterNoteInt);
+			for (const FTempoChange& Change : TempoChanges)
+			{
+				SongMaps.AddTempoChange(Change.Tick, Change.MicrosecondsPerQuarterNote);
+			}
+			for (const FTimeSigChange& Change : TimeSigChanges)
+			{
+				SongMaps.AddTimeSigChange(Change.Tick, Change.Numerator, Change.Denominator);
+			}
+		}
+
+	private:
+		struct FTempoChange
+		{
+			int32 Tick;
+			int32 MicrosecondsPerQuarterNote;
+		};
+
+		struct FTimeSigChange
+		{
+			int32 Tick;
+			int32 Numerator;
+			int32 Denominator;
+		};
+
+		/** File ticks to Harmonix ticks, rounded to the nearest */
+		int32 ToTick(uint64 FileTick) const
+		{
+			const uint64 Scaled = (FileTick * Harmonix::Midi::Constants::GTicksPerQuarterNoteInt + TicksPerQuarterNote / 2) / TicksPerQuarterNote;
+			return static_cast<int32>(FMath::Min<uint64>(Scaled, MAX_int32));
+		}
+
+		void HandleMetaEvent(uint8 MetaType, TConstArrayView<uint8> Data, int32 Tick, FString& OutTrackName, TArray<FMidiEvent>& TrackEvents)
+		{
+			switch (MetaType)
+			{
+			case 0x03:
+				if (OutTrackName.IsEmpty())
+				{
+					OutTrackName = FString(Data.Num(), reinterpret_cast<const ANSICHAR*>(Data.GetData()));
+				}
+				break;
+
+			case 0x51:
+				if (Data.Num() >= 3)
+				{
+					const int32 MicrosecondsPerQuarterNote = (Data[0] << 16) | (Data[1] << 8) | Data[2];
+					if (MicrosecondsPerQuarterNote > 0)
+					{
+						TempoChanges.Add({ Tick, MicrosecondsPerQuarterNote });
+						if (bBuildMidiTracks)
+						{
+							TrackEvents.Emplace(Tick, FMidiMsg::CreateTempo(MicrosecondsPerQuarterNote));
+						}
+					}
+				}
+				break;
+
+			case 0x58:
+				if (Data.Num() >= 2 && Data[0] > 0 && Data[1] < 8)
+				{
+					const int32 Numerator = Data[0];
+					const int32 Denominator = 1 << Data[1];
+					TimeSigChanges.Add({ Tick, Numerator, Denominator });
+					if (bBuildMidiTracks)
+					{
+						TrackEvents.Emplace(Tick, FMidiMsg::CreateTimeSig(Numerator, Denominator));
+					}
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		void HandleChannelEvent(int32 TrackIndex, uint8 Command, int32 Channel, uint8 Data1, uint8 Data2, int32 Tick)
+		{
+			const int32 KeySlot = Channel * NumKeys + Data1;
+			switch (Command)
+			{
+			case 0x90:
+				if (Data2 > 0)
+				{
+					// A second note-on for a sounding key restarts it, as in BuildFromMidiFile
+					GetNotesTrack(TrackIndex, Channel);
+					ActiveNoteOnTicks[KeySlot] = Tick;
+					ActiveNoteVelocities[KeySlot] = Data2;
+					break;
+				}
+				// Note-on with zero velocity is a note-off
+				[[fallthrough]];
+
+			case 0x80:
+				if (ActiveNoteOnTicks[KeySlot] != INDEX_NONE)
+				{
+					FLinkedMidiNote Note;
+					Note.NoteOnTick = ActiveNoteOnTicks[KeySlot];
+					Note.NoteOffTick = Tick;
+					Note.Velocity = static_cast<int8>(ActiveNoteVelocities[KeySlot]);
+					Note.NoteNumber = static_cast<int8>(Data1);
+					Result.NotesData->Tracks[GetNotesTrack(TrackIndex, Channel)].Notes.Add(Note);
+					ActiveNoteOnTicks[KeySlot] = INDEX_NONE;
+				}
+				break;
+
+			case 0xA0:
+				AddControllerChange(TrackIndex, Channel, EMidiControllerType::PolyAftertouch, Data1, Tick, Data2);
+				break;
+
+			case 0xB0:
+				AddControllerChange(TrackIndex, Channel, EMidiControllerType::ControlChange, Data1, Tick, Data2);
+				break;
+
+			case 0xD0:
+				AddControllerChange(TrackIndex, Channel, EMidiControllerType::ChannelAftertouch, 0, Tick, Data1);
+				break;
+
+			case 0xE0:
+				AddControllerChange(TrackIndex, Channel, EMidiControllerType::PitchBend, 0, Tick, ((Data2 << 7) | Data1) - 8192);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		/** Notes track of a channel of the current track, created on its first note-on */
+		int32 GetNotesTrack(int32 TrackIndex, int32 Channel)
+		{
+			int32& NotesTrackIndex = ChannelNotesTracks[Channel];
+			if (NotesTrackIndex == INDEX_NONE)
+			{
+				FMidiNotesTrack& NotesTrack = Result.NotesData->Tracks.AddDefaulted_GetRef();
+				NotesTrack.TrackIndex = TrackIndex;
+				NotesTrack.ChannelIndex = Channel;
+				NotesTrackIndex = Result.NotesData->Tracks.Num() - 1;
+			}
+			return NotesTrackIndex;
+		}
+
+		void AddControllerChange(int32 TrackIndex, int32 Channel, EMidiControllerType Type, int32 Number, int32 Tick, int32 Value)
+		{
+			int32 Slot = Channel * LaneLookupPerChannel;
+			switch (Type)
+			{
+			case EMidiControllerType::ControlChange: Slot += Number; break;
+			case EMidiControllerType::PolyAftertouch: Slot += NumKeys + Number; break;
+			case EMidiControllerType::PitchBend: Slot += NumKeys * 2; break;
+			case EMidiControllerType::ChannelAftertouch: Slot += NumKeys * 2 + 1; break;
+			}
+
+			int32& LaneIndex = LaneLookup[Slot];
+			if (LaneIndex == INDEX_NONE)
+			{
+				FMidiControllerLane& Lane = Result.NotesData->ControllerLanes.AddDefaulted_GetRef();
+				Lane.TrackIndex = TrackIndex;
+				Lane.ChannelIndex = Channel;
+				Lane.Type = Type;
+				Lane.Number = Number;
+				LaneIndex = Result.NotesData->ControllerLanes.Num() - 1;
+			}
+			Result.NotesData->ControllerLanes[LaneIndex].AddChange(Tick, Value);
+		}
+
+		/** Names the notes tracks of the current track once its name and primary channel are known */
+		void NameNotesTracks(const FString& TrackName, int32 PrimaryChannel)
+		{
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				if (ChannelNotesTracks[Channel] == INDEX_NONE)
+				{
+					continue;
+				}
+
+				FMidiNotesTrack& NotesTrack = Result.NotesData->Tracks[ChannelNotesTracks[Channel]];
+				if (Channel == PrimaryChannel && !TrackName.IsEmpty())
+				{
+					NotesTrack.TrackName = TrackName;
+				}
+				else
+				{
+					NotesTrack.TrackName = FString::Printf(TEXT("%s Ch:%d"), TrackName.IsEmpty() ? TEXT("Track") : *TrackName, Channel);
+				}
+			}
+		}
+
+		FMidiFileStreamResult& Result;
+		const bool bBuildMidiTracks;
+		int32 TicksPerQuarterNote = 0;
+
+		TArray<FString> TrackNames;
+		TArray<int32> PrimaryChannels;
+		TArray<FTempoChange> TempoChanges;
+		TArray<FTimeSigChange> TimeSigChanges;
+
+		// Per track state, flat tables indexed by channel and key instead of maps to keep the event loop tight
+		TArray<int32> ActiveNoteOnTicks;
+		TArray<uint8> ActiveNoteVelocities;
+		TArray<int32> LaneLookup;
+		int32 ChannelNotesTracks[NumChannels];
+	};
+
+	/** Chunks of a file that is entirely in memory, e.g. memory mapped */
+	class FMemoryChunkSource
+	{
+	public:
+		explicit FMemoryChunkSource(TConstArrayView<uint8> InBytes)
+			: Reader(InBytes)
+		{
+		}
+
+		bool ReadChunkHeader(uint32& OutId, uint32& OutLength)
+		{
+			if (Reader.Remaining() < ChunkHeaderSize)
+			{
+				return false;
+			}
+			OutId = Reader.ReadUInt32();
+			OutLength = Reader.ReadUInt32();
+			return true;
+		}
+
+		bool ReadChunkBody(uint32 Length, TConstArrayView<uint8>& OutBody)
+		{
+			// Truncated files are read up to where they end
+			OutBody = Reader.ReadBytes(static_cast<uint32>(FMath::Min<int64>(Length, Reader.Remaining())));
+			return true;
+		}
+
+		bool SkipChunkBody(uint32 Length)
+		{
+			Reader.ReadBytes(static_cast<uint32>(FMath::Min<int64>(Length, Reader.Remaining())));
+			return true;
+		}
+
+	private:
+		FSmfByteReader Reader;
+	};
+
+	/** Chunks streamed through a file handle, only the current chunk is held in memory */
+	class FFileChunkSource
+	{
+	public:
+		explicit FFileChunkSource(IFileHandle& InFileHandle)
+			: FileHandle(InFileHandle)
+		{
+		}
+
+		bool ReadChunkHeader(uint32& OutId, uint32& OutLength)
+		{
+			uint8 Header[ChunkHeaderSize];
+			if (FileHandle.Size() - FileHandle.Tell() < ChunkHeaderSize || !FileHandle.Read(Header, ChunkHeaderSize))
+			{
+				return false;
+			}
+			FSmfByteReader Reader(MakeArrayView(Header, ChunkHeaderSize));
+			OutId = Reader.ReadUInt32();
+			OutLength = Reader.ReadUInt32();
+			return true;
+		}
+
+		bool ReadChunkBody(uint32 Length, TConstArrayView<uint8>& OutBody)
+		{
+			const int64 Available = FMath::Min<int64>(Length, FileHandle.Size() - FileHandle.Tell());
+			Buffer.SetNumUninitialized(static_cast<int32>(Available), EAllowShrinking::No);
+			if (!FileHandle.Read(Buffer.GetData(), Available))
+			{
+				return false;
+			}
+			OutBody = Buffer;
+			return true;
+		}
+
+		bool SkipChunkBody(uint32 Length)
+		{
+			return FileHandle.Seek(FMath::Min<int64>(FileHandle.Tell() + Length, FileHandle.Size()));
+		}
+
+	private:
+		IFileHandle& FileHandle;
+		TArray<uint8> Buffer;
+	};
+
+	template<typename ChunkSourceType>
+	bool ParseChunks(ChunkSourceType& Source, FMidiFileStreamResult& OutResult, EMidiFileStreamFlags Flags)
+	{
+		FSmfBuilder Builder(OutResult, Flags);
+
+		uint32 ChunkId = 0;
+		uint32 ChunkLength = 0;
+		TConstArrayView<uint8> Body;
+		while (Source.ReadChunkHeader(ChunkId, ChunkLength))
+		{
+			if (ChunkId == HeaderChunkId && !Builder.HasHeader())
+			{
+				if (!Source.ReadChunkBody(ChunkLength, Body) || !Builder.ParseHeader(Body))
+				{
+					return false;
+				}
+			}
+			else if (ChunkId == TrackChunkId && Builder.HasHeader())
+			{
+				if (!Source.ReadChunkBody(ChunkLength, Body) || !Builder.ParseTrack(Body))
+				{
+					return false;
+				}
+			}
+			else if (!Builder.HasHeader())
+			{
+				OutResult.Error = TEXT("Not a Standard MIDI File, missing MThd header");
+				return false;
+			}
+			else if (!Source.SkipChunkBody(ChunkLength))
+			{
+				break;
+			}
+		}
+
+		if (!Builder.HasHeader())
+		{
+			OutResult.Error = TEXT("Not a Standard MIDI File, missing MThd header");
+			return false;
+		}
+
+		Builder.Finish();
+		return true;
+	}
+}
+
+bool FMidiFileStreamReader::ReadFile(const FString& FilePath, FMidiFileStreamResult& OutResult, EMidiFileStreamFlags Flags)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// Mapped files are parsed in place, nothing is copied
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*FilePath));
+	if (MappedFile.IsValid() && MappedFile->GetFileSize() > 0 && MappedFile->GetFileSize() <= MAX_int32)
+	{
+		TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if (MappedRegion.IsValid())
+		{
+			return ReadMemory(TConstArrayView<uint8>(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize())), OutResult, Flags);
+		}
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_ReadStandardMidiFile);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiFileStreamReader::ReadFile);
+
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenRead(*FilePath));
+	if (!FileHandle.IsValid())
+	{
+		OutResult.Error = FString::Printf(TEXT("Could not open %s"), *FilePath);
+		return false;
+	}
+
+	FFileChunkSource Source(*FileHandle);
+	return ParseChunks(Source, OutResult, Flags);
+}
+
+bool FMidiFileStreamReader::ReadMemory(TConstArrayView<uint8> Bytes, FMidiFileStreamResult& OutResult, EMidiFileStreamFlags Flags)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_ReadStandardMidiFile);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiFileStreamReader::ReadMemory);
+
+	FMemoryChunkSource Source(Bytes);
+	return ParseChunks(Source, OutResult, Flags);
+}
@@ -0,0 +1,333 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiFileStreamWriter.h"
+#include "HarmonixMidi/MidiFile.h"
+#include "HarmonixMidi/MidiTrack.h"
+#include "HarmonixMidi/MidiEvent.h"
+#include "HarmonixMidi/MidiMsg.h"
+#include "HAL/FileManager.h"
+#include "Serialization/Archive.h"
+#include "MidiExtensionsStats.h"
+
+namespace
+{
+	/** Counts the bytes a track would take, the first pass over each track */
+	struct FCountingSink
+	{
+		int64 Num = 0;
+
+		void WriteByte(uint8) { ++Num; }
+		void WriteBytes(const uint8*, int32 Count) { Num += Count; }
+	};
+
+	/** Batches bytes into a fixed buffer and hands it to the archive when full */
+	struct FBufferedArchiveSink
+	{
+		FArchive& Ar;
+		TArray<uint8>& Buffer;
+
+		FBufferedArchiveSink(FArchive& InAr, TArray<uint8>& InBuffer)
+			: Ar(InAr)
+			, Buffer(InBuffer)
+		{
+			Buffer.Reset();
+		}
+
+		~FBufferedArchiveSink()
+		{
+			Flush();
+		}
+
+		void WriteByte(uint8 Byte)
+		{
+			if (Buffer.Num() == FMidiFileStreamWriter::StreamBufferSize)
+			{
+				Flush();
+			}
+			Buffer.Add(Byte);
+		}
+
+		void WriteBytes(const uint8* Bytes, int32 Count)
+		{
+			if (Buffer.Num() + Count > FMidiFileStreamWriter::StreamBufferSize)
+			{
+				Flush();
+			}
+			if (Count > FMidiFileStreamWriter::StreamBufferSize)
+			{
+				Ar.Serialize(const_cast<uint8*>(Bytes), Count);
+				return;
+			}
+			Buffer.Append(Bytes, Count);
+		}
+
+		void Flush()
+		{
+			if (!Buffer.IsEmpty())
+			{
+				Ar.Serialize(Buffer.GetData(), Buffer.Num());
+				Buffer.Reset();
+			}
+		}
+	};
+
+	template<typename SinkType>
+	void WriteUInt16(SinkType& Sink, uint16 Value)
+	{
+		Sink.WriteByte(static_cast<uint8>(Value >> 8));
+		Sink.WriteByte(static_cast<uint8>(Value));
+	}
+
+	template<typename SinkType>
+	void WriteUInt32(SinkType& Sink, uint32 Value)
+	{
+		WriteUInt16(Sink, static_cast<uint16>(Value >> 16));
+		WriteUInt16(Sink, static_cast<uint16>(Value));
+	}
+
+	/** Variable length quantity, values are clamped to the 28 bits the format allows */
+	template<typename SinkType>
+	void WriteVarLen(SinkType& Sink, uint32 Value)
+	{
+		Value = FMath::Min<uint32>(Value, 0x0FFFFFFF);
+
+		uint8 Bytes[4];
+		int32 NumBytes = 0;
+		do
+		{
+			Bytes[NumBytes++] = Value & 0x7F;
+			Value >>= 7;
+		} while (Value != 0);
+
+		while (NumBytes > 1)
+		{
+			Sink.WriteByte(Bytes[--NumBytes] | 0x80);
+		}
+		Sink.WriteByte(Bytes[0]);
+	}
+
+	/** Encodes the events of one track chunk, tracks running status and the delta time between written events */
+	template<typename SinkType>
+	class TSmfTrackEncoder
+	{
+	public:
+		explicit TSmfTrackEncoder(SinkType& InSink)
+			: Sink(InSink)
+		{
+		}
+
+		void WriteTrackName(const FString& Name)
+		{
+			if (Name.IsEmpty())
+			{
+				return;
+			}
+			const FTCHARToUTF8 Utf8Name(*Name);
+			WriteMetaEvent(0, 0x03, reinterpret_cast<const uint8*>(Utf8Name.Get()), Utf8Name.Length());
+		}
+
+		void WriteEvent(const FMidiEvent& Event)
+		{
+			const FMidiMsg& Msg = Event.GetMsg();
+			const int32 Tick = Event.GetTick();
+
+			if (Msg.IsStd())
+			{
+				const uint8 Status = Msg.GetStdStatus();
+				if (Status < 0x80 || Status >= 0xF0)
+				{
+					return;
+				}
+
+				WriteDeltaTime(Tick);
+				if (Status != RunningStatus)
+				{
+					Sink.WriteByte(Status);
+					RunningStatus = Status;
+				}
+				Sink.WriteByte(Msg.GetStdData1() & 0x7F);
+
+				const uint8 Command = Status & 0xF0;
+				if (Command != 0xC0 && Command != 0xD0)
+				{
+					Sink.WriteByte(Msg.GetStdData2() & 0x7F);
+				}
+			}
+			else if (Msg.IsTempo())
+			{
+				const uint32 MicrosecondsPerQuarterNote = Msg.GetMicrosecPerQuarterNote();
+				const uint8 Data[3] = { static_cast<uint8>(MicrosecondsPerQuarterNote >> 16), static_cast<uint8>(MicrosecondsPerQuarterNote >> 8), static_cast<uint8>(MicrosecondsPerQuarterNote) };
+				WriteMetaEvent(Tick, 0x51, Data, 3);
+			}
+			else if (Msg.IsTimeSig())
+			{
+				const uint8 Data[4] = { static_cast<uint8>(Msg.GetTimeSigNumerator()), static_cast<uint8>(FMath::FloorLog2(FMath::Max(1, Msg.GetTimeSigDenominator()))), 24, 8 };
+				WriteMetaEvent(Tick, 0x58, Data, 4);
+			}
+		}
+
+		void WriteEndOfTrack()
+		{
+			WriteMetaEvent(LastTick, 0x2F, nullptr, 0);
+		}
+
+	private:
+		void WriteDeltaTime(int32 Tick)
+		{
+			// Tracks are sorted, a stray earlier event is written at the current time rather than underflowing the delta
+			Tick = FMath::Max(Tick, LastTick);
+			WriteVarLen(Sink, static_cast<uint32>(Tick - LastTick));
+			LastTick = Tick;
+		}
+
+		void WriteMetaEvent(int32 Tick, uint8 Type, const uint8* Data, int32 Length)
+		{
+			WriteDeltaTime(Tick);
+			Sink.WriteByte(0xFF);
+			Sink.WriteByte(Type);
+			WriteVarLen(Sink, Length);
+			if (Length > 0)
+			{
+				Sink.WriteBytes(Data, Length);
+			}
+
+			// Meta events cancel running status
+			RunningStatus = 0;
+		}
+
+		SinkType& Sink;
+		int32 LastTick = 0;
+		uint8 RunningStatus = 0;
+	};
+
+	/** Calls Visitor for every event of the given tracks, merged in tick order, ties go to the lower track index */
+	template<typename VisitorType>
+	void ForEachMergedEvent(const TArray<FMidiTrack>& Tracks, VisitorType&& Visitor)
+	{
+		struct FCursor
+		{
+			int32 Tick;
+			int32 TrackIndex;
+			int32 EventIndex;
+
+			bool operator<(const FCursor& Other) const
+			{
+				return Tick < Other.Tick || (Tick == Other.Tick && TrackIndex < Other.TrackIndex);
+			}
+		};
+
+		TArray<FCursor, TInlineAllocator<64>> Heap;
+		for (int32 TrackIndex = 0; TrackIndex < Tracks.Num(); ++TrackIndex)
+		{
+			const auto& Events = Tracks[TrackIndex].GetEvents();
+			if (!Events.IsEmpty())
+			{
+				Heap.HeapPush({ Events[0].GetTick(), TrackIndex, 0 });
+			}
+		}
+
+		while (!Heap.IsEmpty())
+		{
+			FCursor Cursor;
+			Heap.HeapPop(Cursor, EAllowShrinking::No);
+
+			const auto& Events = Tracks[Cursor.TrackIndex].GetEvents();
+			Visitor(Events[Cursor.EventIndex]);
+
+			if (++Cursor.EventIndex < Events.Num())
+			{
+				Cursor.Tick = Events[Cursor.EventIndex].GetTick();
+				Heap.HeapPush(Cursor);
+			}
+		}
+	}
+
+	/** Encodes a track chunk body into Sink, Tracks is the single track for type 1 and every track for type 0 */
+	template<typename SinkType>
+	void EncodeTrackChunk(SinkType& Sink, const TArray<FMidiTrack>& Tracks, int32 TrackIndex, EMidiFileExportFormat Format)
+	{
+		TSmfTrackEncoder<SinkType> Encoder(Sink);
+
+		const FString* Name = Tracks.IsValidIndex(TrackIndex) ? Tracks[TrackIndex].GetName() : nullptr;
+		if (Name)
+		{
+			Encoder.WriteTrackName(*Name);
+		}
+
+		if (Format == EMidiFileExportFormat::SingleTrack)
+		{
+			ForEachMergedEvent(Tracks, [&Encoder](const FMidiEvent& Event) { Encoder.WriteEvent(Event); });
+		}
+		else if (Tracks.IsValidIndex(TrackIndex))
+		{
+			for (const FMidiEvent& Event : Tracks[TrackIndex].GetEvents())
+			{
+				Encoder.WriteEvent(Event);
+			}
+		}
+
+		Encoder.WriteEndOfTrack();
+	}
+}
+
+bool FMidiFileStreamWriter::Write(const FMidiFileData& MidiData, FArchive& Ar, EMidiFileExportFormat Format)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_WriteStandardMidiFile);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiFileStreamWriter::Write);
+
+	if (!Ar.IsSaving())
+	{
+		return false;
+	}
+
+	const TArray<FMidiTrack>& Tracks = MidiData.Tracks;
+	const int32 NumChunks = Format == EMidiFileExportFormat::SingleTrack ? 1 : FMath::Max(1, Tracks.Num());
+	if (NumChunks > MAX_uint16 || MidiData.TicksPerQuarterNote <= 0 || MidiData.TicksPerQuarterNote > 0x7FFF)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FMidiFileStreamWriter: Can't write %d tracks at %d ticks per quarter note"), NumChunks, MidiData.TicksPerQuarterNote);
+		return false;
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.Reserve(StreamBufferSize);
+
+	{
+		FBufferedArchiveSink Sink(Ar, Buffer);
+		Sink.WriteBytes(reinterpret_cast<const uint8*>("MThd"), 4);
+		WriteUInt32(Sink, 6);
+		WriteUInt16(Sink, Format == EMidiFileExportFormat::SingleTrack ? 0 : 1);
+		WriteUInt16(Sink, static_cast<uint16>(NumChunks));
+		WriteUInt16(Sink, static_cast<uint16>(MidiData.TicksPerQuarterNote));
+	}
+
+	for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		// Size the chunk first so its header can be streamed out before the body
+		FCountingSink Counter;
+		EncodeTrackChunk(Counter, Tracks, ChunkIndex, Format);
+		if (Counter.Num > MAX_uint32)
+		{
+			return false;
+		}
+
+		FBufferedArchiveSink Sink(Ar, Buffer);
+		Sink.WriteBytes(reinterpret_cast<const uint8*>("MTrk"), 4);
+		WriteUInt32(Sink, static_cast<uint32>(Counter.Num));
+		EncodeTrackChunk(Sink, Tracks, ChunkIndex, Format);
+	}
+
+	return !Ar.IsError();
+}
+
+bool FMidiFileStreamWriter::WriteToFile(const FMidiFileData& MidiData, const FString& FilePath, EMidiFileExportFormat Format)
+{
+	TUniquePtr<FArchive> FileWriter(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!FileWriter.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FMidiFileStreamWriter: Could not open %s for writing"), *FilePath);
+		return false;
+	}
+
+	const bool bWritten = Write(MidiData, *FileWriter, Format);
+	return FileWriter->Close() && bWritten;
+}
@@ -0,0 +1,172 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiNoteQueryIndex.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "HarmonixMidi/SongMaps.h"
+#include "MidiExtensionsStats.h"
+
+TSharedRef<FMidiNoteQueryIndex, ESPMode::ThreadSafe> FMidiNoteQueryIndex::Build(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InNotesData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_BuildQueryIndex);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiNoteQueryIndex::Build);
+
+	TSharedRef<FMidiNoteQueryIndex, ESPMode::ThreadSafe> Index = MakeShared<FMidiNoteQueryIndex, ESPMode::ThreadSafe>();
+	Index->NotesData = MoveTemp(InNotesData);
+	if (!Index->NotesData.IsValid())
+	{
+		return Index;
+	}
+
+	Index->BuiltRevision = Index->NotesData->Revision;
+	Index->Tracks.SetNum(Index->NotesData->Tracks.Num());
+
+	for (int32 TrackIndex = 0; TrackIndex < Index->Tracks.Num(); ++TrackIndex)
+	{
+		const TArray<FLinkedMidiNote>& Notes = Index->NotesData->Tracks[TrackIndex].Notes;
+		FTrackIndex& Track = Index->Tracks[TrackIndex];
+		const int32 NumNotes = Notes.Num();
+
+		// Edits can leave the notes out of order, so the index keeps its own onset order
+		Track.OnsetOrder.SetNumUninitialized(NumNotes);
+		for (int32 NoteIndex = 0; NoteIndex < NumNotes; ++NoteIndex)
+		{
+			Track.OnsetOrder[NoteIndex] = NoteIndex;
+		}
+		Algo::StableSortBy(Track.OnsetOrder, [&Notes](int32 NoteIndex) { return Notes[NoteIndex].NoteOnTick; });
+
+		Track.OnsetTicks.SetNumUninitialized(NumNotes);
+		Track.SortedOffTicks.SetNumUninitialized(NumNotes);
+		for (int32 Position = 0; Position < NumNotes; ++Position)
+		{
+			const FLinkedMidiNote& Note = Notes[Track.OnsetOrder[Position]];
+			Track.OnsetTicks[Position] = Note.NoteOnTick;
+			Track.SortedOffTicks[Position] = Note.NoteOffTick;
+		}
+		Track.SortedOffTicks.Sort();
+
+		Track.LeafCount = FMath::RoundUpToPowerOfTwo(FMath::Max(NumNotes, 1));
+		Track.MaxOffTree.Init(TNumericLimits<int32>::Lowest(), Track.LeafCount * 2);
+		for (int32 Position = 0; Position < NumNotes; ++Position)
+		{
+			Track.MaxOffTree[Track.LeafCount + Position] = Notes[Track.OnsetOrder[Position]].NoteOffTick;
+		}
+		for (int32 Node = Track.LeafCount - 1; Node >= 1; --Node)
+		{
+			Track.MaxOffTree[Node] = FMath::Max(Track.MaxOffTree[Node * 2], Track.MaxOffTree[Node * 2 + 1]);
+		}
+	}
+
+	return Index;
+}
+
+void FMidiNoteQueryIndex::GetNotesActiveAtTick(int32 TrackIndex, int32 Tick, TArray<int32>& OutNoteIndices) const
+{
+	if (!Tracks.IsValidIndex(TrackIndex))
+	{
+		return;
+	}
+
+	// Only notes starting at or before Tick can sound, the tree prunes every subtree ending before it
+	const FTrackIndex& Track = Tracks[TrackIndex];
+	const int32 OnsetLimit = Algo::UpperBound(Track.OnsetTicks, Tick);
+	if (OnsetLimit > 0)
+	{
+		CollectActive(Track, 1, 0, Track.LeafCount, OnsetLimit, Tick, OutNoteIndices);
+	}
+}
+
+void FMidiNoteQueryIndex::CollectActive(const FTrackIndex& Track, int32 Node, int32 NodeBegin, int32 NodeEnd, int32 OnsetLimit, int32 Tick, TArray<int32>& OutNoteIndices) const
+{
+	if (NodeBegin >= OnsetLimit || Track.MaxOffTree[Node] <= Tick)
+	{
+		return;
+	}
+
+	if (NodeEnd - NodeBegin == 1)
+	{
+		OutNoteIndices.Add(Track.OnsetOrder[NodeBegin]);
+		return;
+	}
+
+	const int32 NodeMiddle = (NodeBegin + NodeEnd) / 2;
+	CollectActive(Track, Node * 2, NodeBegin, NodeMiddle, OnsetLimit, Tick, OutNoteIndices);
+	CollectActive(Track, Node * 2 + 1, NodeMiddle, NodeEnd, OnsetLimit, Tick, OutNoteIndices);
+}
+
+int32 FMidiNoteQueryIndex::CountNotesActiveAtTick(int32 TrackIndex, int32 Tick) const
+{
+	if (!Tracks.IsValidIndex(TrackIndex))
+	{
+		return 0;
+	}
+
+	// Notes started by Tick minus notes ended by Tick, valid as every note ends after it starts
+	const FTrackIndex& Track = Tracks[TrackIndex];
+	return Algo::UpperBound(Track.OnsetTicks, Tick) - Algo::UpperBound(Track.SortedOffTicks, Tick);
+}
+
+int32 FMidiNoteQueryIndex::FindNextNoteOnset(int32 TrackIndex, int32 Tick) const
+{
+	if (!Tracks.IsValidIndex(TrackIndex))
+	{
+		return INDEX_NONE;
+	}
+
+	const FTrackIndex& Track = Tracks[TrackIndex];
+	const int32 Position = Algo::UpperBound(Track.OnsetTicks, Tick);
+	return Track.OnsetOrder.IsValidIndex(Position) ? Track.OnsetOrder[Position] : INDEX_NONE;
+}
+
+int32 FMidiNoteQueryIndex::FindPreviousNoteOnset(int32 TrackIndex, int32 Tick) const
+{
+	if (!Tracks.IsValidIndex(TrackIndex))
+	{
+		return INDEX_NONE;
+	}
+
+	const FTrackIndex& Track = Tracks[TrackIndex];
+	const int32 Position = Algo::LowerBound(Track.OnsetTicks, Tick) - 1;
+	return Track.OnsetOrder.IsValidIndex(Position) ? Track.OnsetOrder[Position] : INDEX_NONE;
+}
+
+int32 FMidiNoteQueryIndex::CountNotesStartingInRange(int32 TrackIndex, int32 StartTick, int32 EndTick) const
+{
+	if (!Tracks.IsValidIndex(TrackIndex) || EndTick <= StartTick)
+	{
+		return 0;
+	}
+
+	const FTrackIndex& Track = Tracks[TrackIndex];
+	return Algo::LowerBound(Track.OnsetTicks, EndTick) - Algo::LowerBound(Track.OnsetTicks, StartTick);
+}
+
+int32 FMidiNoteQueryIndex::MsToQueryTick(const FSongMaps& SongMaps, double Ms)
+{
+	return FMath::FloorToInt32(SongMaps.MsToTick(static_cast<float>(Ms)));
+}
+
+void FMidiNoteQueryIndex::GetNotesActiveAtMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms, TArray<int32>& OutNoteIndices) const
+{
+	GetNotesActiveAtTick(TrackIndex, MsToQueryTick(SongMaps, Ms), OutNoteIndices);
+}
+
+int32 FMidiNoteQueryIndex::CountNotesActiveAtMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms) const
+{
+	return CountNotesActiveAtTick(TrackIndex, MsToQueryTick(SongMaps, Ms));
+}
+
+int32 FMidiNoteQueryIndex::FindNextNoteOnsetAfterMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms) const
+{
+	return FindNextNoteOnset(TrackIndex, MsToQueryTick(SongMaps, Ms));
+}
+
+int32 FMidiNoteQueryIndex::FindPreviousNoteOnsetBeforeMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms) const
+{
+	return FindPreviousNoteOnset(TrackIndex, MsToQueryTick(SongMaps, Ms));
+}
+
+int32 FMidiNoteQueryIndex::CountNotesStartingInMsRange(const FSongMaps& SongMaps, int32 TrackIndex, double StartMs, double EndMs) const
+{
+	return CountNotesStartingInRange(TrackIndex, MsToQueryTick(SongMaps, StartMs), MsToQueryTick(SongMaps, EndMs));
+}
@@ -0,0 +1,198 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiNoteTransform.h"
+#include "Algo/Unique.h"
+#include "Math/VectorRegister.h"
+#include "MidiExtensionsStats.h"
+
+namespace MidiNoteTransformPrivate
+{
+	constexpr int32 Lanes = 4;
+
+	/** Columns padded to a multiple of Lanes so the kernels never need a scalar tail */
+	struct FNoteColumns
+	{
+		TArray<int32, TAlignedHeapAllocator<16>> NoteOnTicks;
+		TArray<int32, TAlignedHeapAllocator<16>> NoteOffTicks;
+		TArray<int32, TAlignedHeapAllocator<16>> NoteNumbers;
+		TArray<int32, TAlignedHeapAllocator<16>> Velocities;
+
+		void SetNum(int32 Num)
+		{
+			const int32 PaddedNum = Align(Num, Lanes);
+			NoteOnTicks.SetNumZeroed(PaddedNum);
+			NoteOffTicks.SetNumZeroed(PaddedNum);
+			NoteNumbers.SetNumZeroed(PaddedNum);
+			Velocities.SetNumZeroed(PaddedNum);
+		}
+	};
+
+	/** round((Value - Pivot) * Scale) + Pivot + Offset, rounding half up like FMath::RoundToInt */
+	FORCEINLINE VectorRegister4Int ScaleOffset(const VectorRegister4Int& Value, const VectorRegister4Int& Pivot, const VectorRegister4Float& Scale, const VectorRegister4Int& PivotPlusOffset)
+	{
+		const VectorRegister4Float Relative = VectorIntToFloat(VectorIntSubtract(Value, Pivot));
+		const VectorRegister4Float Scaled = VectorFloor(VectorMultiplyAdd(Relative, Scale, VectorSetFloat1(0.5f)));
+		return VectorIntAdd(VectorFloatToInt(Scaled), PivotPlusOffset);
+	}
+
+	void TransformTicks(const FMidiNoteTransform& Transform, int32* RESTRICT NoteOnTicks, int32* RESTRICT NoteOffTicks, int32 Num)
+	{
+		const VectorRegister4Int Zero = VectorIntSet1(0);
+		const VectorRegister4Int One = VectorIntSet1(1);
+		const VectorRegister4Int Offset = VectorIntSet1(Transform.TickOffset);
+
+		if (Transform.TickScale == 1.0f)
+		{
+			for (int32 Index = 0; Index < Num; Index += Lanes)
+			{
+				const VectorRegister4Int On = VectorIntMax(VectorIntAdd(VectorIntLoad(NoteOnTicks + Index), Offset), Zero);
+				const VectorRegister4Int Off = VectorIntMax(VectorIntAdd(VectorIntLoad(NoteOffTicks + Index), Offset), VectorIntAdd(On, One));
+				VectorIntStore(On, NoteOnTicks + Index);
+				VectorIntStore(Off, NoteOffTicks + Index);
+			}
+			return;
+		}
+
+		const VectorRegister4Int Pivot = VectorIntSet1(Transform.TickPivot);
+		const VectorRegister4Int PivotPlusOffset = VectorIntSet1(Transform.TickPivot + Transform.TickOffset);
+		const VectorRegister4Float Scale = VectorSetFloat1(FMath::Max(Transform.TickScale, 0.0f));
+		for (int32 Index = 0; Index < Num; Index += Lanes)
+		{
+			const VectorRegister4Int On = VectorIntMax(ScaleOffset(VectorIntLoad(NoteOnTicks + Index), Pivot, Scale, PivotPlusOffset), Zero);
+			const VectorRegister4Int Off = VectorIntMax(ScaleOffset(VectorIntLoad(NoteOffTicks + Index), Pivot, Scale, PivotPlusOffset), VectorIntAdd(On, One));
+			VectorIntStore(On, NoteOnTicks + Index);
+			VectorIntStore(Off, NoteOffTicks + Index);
+		}
+	}
+
+	void TransformPitches(const FMidiNoteTransform& Transform, int32* RESTRICT NoteNumbers, int32 Num)
+	{
+		const VectorRegister4Int Offset = VectorIntSet1(Transform.PitchOffset);
+		const VectorRegister4Int Min = VectorIntSet1(0);
+		const VectorRegister4Int Max = VectorIntSet1(127);
+		for (int32 Index = 0; Index < Num; Index += Lanes)
+		{
+			const VectorRegister4Int Pitch = VectorIntAdd(VectorIntLoad(NoteNumbers + Index), Offset);
+			VectorIntStore(VectorIntMin(VectorIntMax(Pitch, Min), Max), NoteNumbers + Index);
+		}
+	}
+
+	void TransformVelocities(const FMidiNoteTransform& Transform, int32* RESTRICT Velocities, int32 Num)
+	{
+		const VectorRegister4Int Zero = VectorIntSet1(0);
+		const VectorRegister4Int Offset = VectorIntSet1(Transform.VelocityOffset);
+		const VectorRegister4Float Scale = VectorSetFloat1(FMath::Max(Transform.VelocityScale, 0.0f));
+		const VectorRegister4Int Min = VectorIntSet1(1);
+		const VectorRegister4Int Max = VectorIntSet1(127);
+		for (int32 Index = 0; Index < Num; Index += Lanes)
+		{
+			const VectorRegister4Int Velocity = ScaleOffset(VectorIntLoad(Velocities + Index), Zero, Scale, Offset);
+			VectorIntStore(VectorIntMin(VectorIntMax(Velocity, Min), Max), Velocities + Index);
+		}
+	}
+}
+
+TMap<int32, TArray<int32>> FMidiNoteId::GroupByTrack(TConstArrayView<FMidiNoteId> NoteIds)
+{
+	TMap<int32, TArray<int32>> NotesByTrack;
+	for (const FMidiNoteId& NoteId : NoteIds)
+	{
+		NotesByTrack.FindOrAdd(NoteId.TrackIndex).Add(NoteId.NoteIndex);
+	}
+
+	for (auto& [TrackIndex, NoteIndices] : NotesByTrack)
+	{
+		NoteIndices.Sort();
+		NoteIndices.SetNum(Algo::Unique(NoteIndices), EAllowShrinking::No);
+	}
+	return NotesByTrack;
+}
+
+bool FMidiNoteTransform::IsIdentity() const
+{
+	return TickScale == 1.0f && TickOffset == 0 && PitchOffset == 0 && VelocityScale == 1.0f && VelocityOffset == 0;
+}
+
+FMidiNoteTransform FMidiNoteTransform::MakeTranspose(int32 Semitones)
+{
+	FMidiNoteTransform Transform;
+	Transform.PitchOffset = Semitones;
+	return Transform;
+}
+
+FMidiNoteTransform FMidiNoteTransform::MakeShift(int32 Ticks)
+{
+	FMidiNoteTransform Transform;
+	Transform.TickOffset = Ticks;
+	return Transform;
+}
+
+FMidiNoteTransform FMidiNoteTransform::MakeTimeScale(float Scale, int32 PivotTick)
+{
+	FMidiNoteTransform Transform;
+	Transform.TickScale = Scale;
+	Transform.TickPivot = PivotTick;
+	return Transform;
+}
+
+FMidiNoteTransform FMidiNoteTransform::MakeVelocityScale(float Scale)
+{
+	FMidiNoteTransform Transform;
+	Transform.VelocityScale = Scale;
+	return Transform;
+}
+
+void FMidiNoteTransform::Apply(TArray<FLinkedMidiNote>& Notes, TConstArrayView<int32> NoteIndices) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_TransformNotes);
+	using namespace MidiNoteTransformPrivate;
+
+	const int32 Num = NoteIndices.Num();
+	if (Num == 0 || IsIdentity())
+	{
+		return;
+	}
+
+	// Gather the selection into columns, the kernels then run over contiguous memory regardless of the selection
+	FNoteColumns Columns;
+	Columns.SetNum(Num);
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const FLinkedMidiNote& Note = Notes[NoteIndices[Index]];
+		Columns.NoteOnTicks[Index] = Note.NoteOnTick;
+		Columns.NoteOffTicks[Index] = Note.NoteOffTick;
+		Columns.NoteNumbers[Index] = Note.NoteNumber;
+		Columns.Velocities[Index] = Note.Velocity;
+	}
+
+	const int32 PaddedNum = Columns.NoteOnTicks.Num();
+	if (TickScale != 1.0f || TickOffset != 0)
+	{
+		TransformTicks(*this, Columns.NoteOnTicks.GetData(), Columns.NoteOffTicks.GetData(), PaddedNum);
+	}
+	if (PitchOffset != 0)
+	{
+		TransformPitches(*this, Columns.NoteNumbers.GetData(), PaddedNum);
+	}
+	if (VelocityScale != 1.0f || VelocityOffset != 0)
+	{
+		TransformVelocities(*this, Columns.Velocities.GetData(), PaddedNum);
+	}
+
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		FLinkedMidiNote& Note = Notes[NoteIndices[Index]];
+		Note.NoteOnTick = Columns.NoteOnTicks[Index];
+		Note.NoteOffTick = Columns.NoteOffTicks[Index];
+		Note.NoteNumber = static_cast<int8>(Columns.NoteNumbers[Index]);
+		Note.Velocity = static_cast<int8>(Columns.Velocities[Index]);
+	}
+}
+
+FLinkedMidiNote FMidiNoteTransform::Apply(const FLinkedMidiNote& Note) const
+{
+	TArray<FLinkedMidiNote> Notes = { Note };
+	const int32 NoteIndex = 0;
+	Apply(Notes, MakeArrayView(&NoteIndex, 1));
+	return Notes[0];
+}
@@ -0,0 +1,357 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiNotesCache.h"
+#include "HarmonixMidi/MidiFile.h"
+#include "HarmonixMidi/MidiTrack.h"
+#include "HarmonixMidi/MidiEvent.h"
+#include "HarmonixMidi/MidiMsg.h"
+#include "HarmonixMidi/MidiConstants.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+	bool IsSectionInBounds(uint64 Offset, uint64 Num, uint64 RecordSize, uint64 TotalSize)
+	{
+		return Offset % MidiNotesCache::SectionAlignment == 0 && Offset <= TotalSize && Num * RecordSize <= TotalSize - Offset;
+	}
+
+	/** Appends a section to the cache bytes at the next aligned offset and returns that offset */
+	template<typename RecordType>
+	uint32 AppendSection(TArray64<uint8>& Bytes, TConstArrayView<RecordType> Records)
+	{
+		Bytes.SetNumZeroed(Align(Bytes.Num(), MidiNotesCache::SectionAlignment));
+		const uint32 Offset = static_cast<uint32>(Bytes.Num());
+		Bytes.Append(reinterpret_cast<const uint8*>(Records.GetData()), Records.Num() * sizeof(RecordType));
+		return Offset;
+	}
+}
+
+bool FMidiNotesCacheView::IsValidCache(TConstArrayView64<uint8> Bytes)
+{
+	if (Bytes.Num() < static_cast<int64>(sizeof(FMidiNotesCacheHeader)) || !IsAligned(Bytes.GetData(), alignof(FMidiNotesCacheHeader)))
+	{
+		return false;
+	}
+
+	const FMidiNotesCacheHeader& Header = *reinterpret_cast<const FMidiNotesCacheHeader*>(Bytes.GetData());
+	const uint64 TotalSize = static_cast<uint64>(Bytes.Num());
+	if (Header.Magic != MidiNotesCache::Magic || Header.Version != MidiNotesCache::Version || Header.TotalSize != TotalSize || Header.TicksPerQuarterNote <= 0)
+	{
+		return false;
+	}
+
+	if (!IsSectionInBounds(Header.TracksOffset, Header.NumTracks, sizeof(FMidiNotesCacheTrack), TotalSize)
+		|| !IsSectionInBounds(Header.NotesOffset, Header.NumNotes, sizeof(FLinkedMidiNote), TotalSize)
+		|| !IsSectionInBounds(Header.TempoSegmentsOffset, Header.NumTempoSegments, sizeof(FMidiNotesCacheTempoSegment), TotalSize)
+		|| !IsSectionInBounds(Header.TimeSignaturesOffset, Header.NumTimeSignatures, sizeof(FMidiNotesCacheTimeSignature), TotalSize)
+		|| !(Header.NamesOffset <= TotalSize && Header.NamesSize <= TotalSize - Header.NamesOffset))
+	{
+		return false;
+	}
+
+	// The track records are all that is indexed through, the notes themselves are never validated
+	const FMidiNotesCacheTrack* Tracks = reinterpret_cast<const FMidiNotesCacheTrack*>(Bytes.GetData() + Header.TracksOffset);
+	for (uint32 TrackIndex = 0; TrackIndex < Header.NumTracks; ++TrackIndex)
+	{
+		const FMidiNotesCacheTrack& Track = Tracks[TrackIndex];
+		if (static_cast<uint64>(Track.FirstNote) + Track.NumNotes > Header.NumNotes
+			|| static_cast<uint64>(Track.NameOffset) + Track.NameLength > Header.NamesSize)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TConstArrayView<FLinkedMidiNote> FMidiNotesCacheView::GetTrackNotes(int32 TrackIndex) const
+{
+	const TConstArrayView<FMidiNotesCacheTrack> Tracks = GetTracks();
+	if (!Tracks.IsValidIndex(TrackIndex))
+	{
+		return TConstArrayView<FLinkedMidiNote>();
+	}
+
+	const FMidiNotesCacheTrack& Track = Tracks[TrackIndex];
+	return MakeSection<FLinkedMidiNote>(GetHeader().NotesOffset + Track.FirstNote * sizeof(FLinkedMidiNote), Track.NumNotes);
+}
+
+FUtf8StringView FMidiNotesCacheView::GetTrackName(int32 TrackIndex) const
+{
+	const TConstArrayView<FMidiNotesCacheTrack> Tracks = GetTracks();
+	if (!Tracks.IsValidIndex(TrackIndex))
+	{
+		return FUtf8StringView();
+	}
+
+	const FMidiNotesCacheTrack& Track = Tracks[TrackIndex];
+	return FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Data + GetHeader().NamesOffset + Track.NameOffset), Track.NameLength);
+}
+
+double FMidiNotesCacheView::TickToMs(int32 Tick) const
+{
+	const TConstArrayView<FMidiNotesCacheTempoSegment> Segments = GetTempoSegments();
+	if (Segments.IsEmpty())
+	{
+		return 0.0;
+	}
+
+	const int32 SegmentIndex = FMath::Max(0, Algo::UpperBoundBy(Segments, Tick, &FMidiNotesCacheTempoSegment::StartTick) - 1);
+	const FMidiNotesCacheTempoSegment& Segment = Segments[SegmentIndex];
+	return Segment.StartMs + static_cast<double>(Tick - Segment.StartTick) * Segment.MicrosecondsPerQuarterNote / (1000.0 * GetHeader().TicksPerQuarterNote);
+}
+
+int32 FMidiNotesCacheView::FindFirstNoteAtOrAfterTick(int32 TrackIndex, int32 Tick) const
+{
+	return Algo::LowerBoundBy(GetTrackNotes(TrackIndex), Tick, &FLinkedMidiNote::NoteOnTick);
+}
+
+TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> FMidiNotesCacheView::ToNotesData() const
+{
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>();
+	if (!IsValid())
+	{
+		return NotesData;
+	}
+
+	const TConstArrayView<FMidiNotesCacheTrack> Tracks = GetTracks();
+	NotesData->Tracks.Reserve(Tracks.Num());
+	for (int32 TrackIndex = 0; TrackIndex < Tracks.Num(); ++TrackIndex)
+	{
+		const FMidiNotesCacheTrack& Track = Tracks[TrackIndex];
+		FMidiNotesTrack& NotesTrack = NotesData->Tracks.AddDefaulted_GetRef();
+		const TConstArrayView<FLinkedMidiNote> Notes = GetTrackNotes(TrackIndex);
+		NotesTrack.Notes.Append(Notes.GetData(), Notes.Num());
+		NotesTrack.TrackName = FString(GetTrackName(TrackIndex));
+		NotesTrack.TrackIndex = Track.TrackIndex;
+		NotesTrack.ChannelIndex = Track.ChannelIndex;
+		NotesTrack.FirstNoteOnTick = Track.FirstNoteOnTick;
+		NotesTrack.LastNoteOffTick = Track.LastNoteOffTick;
+		NotesTrack.LowestNoteNumber = Track.LowestNoteNumber;
+		NotesTrack.HighestNoteNumber = Track.HighestNoteNumber;
+	}
+	NotesData->LastNoteOffTick = GetHeader().LastNoteOffTick;
+
+	return NotesData;
+}
+
+TUniquePtr<FMidiNotesCacheFile> FMidiNotesCacheFile::Open(const FString& FilePath, uint64 ExpectedSourceStamp)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiNotesCacheFile::Open);
+
+	TUniquePtr<FMidiNotesCacheFile> CacheFile(new FMidiNotesCacheFile());
+	TConstArrayView64<uint8> Bytes;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	CacheFile->MappedFile.Reset(PlatformFile.OpenMapped(*FilePath));
+	if (CacheFile->MappedFile.IsValid() && CacheFile->MappedFile->GetFileSize() > 0)
+	{
+		CacheFile->MappedRegion.Reset(CacheFile->MappedFile->MapRegion(0, CacheFile->MappedFile->GetFileSize()));
+	}
+
+	if (CacheFile->MappedRegion.IsValid())
+	{
+		Bytes = TConstArrayView64<uint8>(CacheFile->MappedRegion->GetMappedPtr(), CacheFile->MappedRegion->GetMappedSize());
+	}
+	else
+	{
+		CacheFile->MappedFile.Reset();
+		if (!FFileHelper::LoadFileToArray(CacheFile->LoadedBytes, *FilePath, FILEREAD_Silent))
+		{
+			return nullptr;
+		}
+		Bytes = CacheFile->LoadedBytes;
+	}
+
+	if (!FMidiNotesCacheView::IsValidCache(Bytes))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FMidiNotesCacheFile: %s is not a valid version %u notes cache"), *FilePath, MidiNotesCache::Version);
+		return nullptr;
+	}
+
+	CacheFile->View = FMidiNotesCacheView(Bytes.GetData());
+	if (ExpectedSourceStamp != 0 && CacheFile->View.GetHeader().SourceStamp != ExpectedSourceStamp)
+	{
+		return nullptr;
+	}
+
+	return CacheFile;
+}
+
+FMidiNotesCacheFile::~FMidiNotesCacheFile()
+{
+	// The region has to go before the handle it was mapped from
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+bool FMidiNotesCacheWriter::Write(UMidiFile* MidiFile, TArray64<uint8>& OutBytes, uint64 SourceStamp)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiNotesCacheWriter::Write);
+
+	OutBytes.Reset();
+	if (!MidiFile)
+	{
+		return false;
+	}
+
+	const TSharedPtr<FMidiNotesData> NotesData = FMidiNotesData::BuildFromMidiFile(MidiFile);
+	return Write(MidiFile, *NotesData, OutBytes, SourceStamp);
+}
+
+bool FMidiNotesCacheWriter::Write(UMidiFile* MidiFile, const FMidiNotesData& NotesData, TArray64<uint8>& OutBytes, uint64 SourceStamp)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiNotesCacheWriter::Write);
+
+	OutBytes.Reset();
+	if (!MidiFile)
+	{
+		return false;
+	}
+
+	FMidiNotesCacheHeader Header;
+	Header.SourceStamp = SourceStamp;
+	Header.TicksPerQuarterNote = Harmonix::Midi::Constants::GTicksPerQuarterNoteInt;
+	Header.LastNoteOffTick = NotesData.LastNoteOffTick;
+
+	TArray<FMidiNotesCacheTrack> Tracks;
+	TArray<FLinkedMidiNote> Notes;
+	TArray<UTF8CHAR> Names;
+	Tracks.Reserve(NotesData.Tracks.Num());
+	for (const FMidiNotesTrack& NotesTrack : NotesData.Tracks)
+	{
+		FMidiNotesCacheTrack& Track = Tracks.AddDefaulted_GetRef();
+		Track.TrackIndex = NotesTrack.TrackIndex;
+		Track.ChannelIndex = NotesTrack.ChannelIndex;
+		Track.FirstNote = Notes.Num();
+		Track.NumNotes = NotesTrack.Notes.Num();
+		Track.FirstNoteOnTick = NotesTrack.FirstNoteOnTick;
+		Track.LastNoteOffTick = NotesTrack.LastNoteOffTick;
+		Track.LowestNoteNumber = NotesTrack.LowestNoteNumber;
+		Track.HighestNoteNumber = NotesTrack.HighestNoteNumber;
+		Notes.Append(NotesTrack.Notes);
+
+		const FTCHARToUTF8 Utf8Name(*NotesTrack.TrackName);
+		Track.NameOffset = Names.Num();
+		Track.NameLength = Utf8Name.Length();
+		Names.Append(reinterpret_cast<const UTF8CHAR*>(Utf8Name.Get()), Utf8Name.Length());
+	}
+
+	// Tempo and time signature changes come from the events, ties on a tick keep the last change like the song maps do
+	TArray<FMidiNotesCacheTempoSegment> TempoSegments;
+	TArray<FMidiNotesCacheTimeSignature> TimeSignatures;
+	for (int32 TrackIdx = 0; TrackIdx < MidiFile->GetNumTracks(); ++TrackIdx)
+	{
+		const FMidiTrack* MidiTrack = MidiFile->GetTrack(TrackIdx);
+		if (!MidiTrack)
+		{
+			continue;
+		}
+
+		for (const FMidiEvent& Event : MidiTrack->GetEvents())
+		{
+			const FMidiMsg& Msg = Event.GetMsg();
+			if (Msg.IsTempo())
+			{
+				TempoSegments.Add({ Event.GetTick(), static_cast<int32>(Msg.GetMicrosecPerQuarterNote()), 0.0 });
+			}
+			else if (Msg.IsTimeSig())
+			{
+				TimeSignatures.Add({ Event.GetTick(), static_cast<int16>(Msg.GetTimeSigNumerator()), static_cast<int16>(Msg.GetTimeSigDenominator()) });
+			}
+		}
+	}
+
+	Algo::StableSortBy(TempoSegments, &FMidiNotesCacheTempoSegment::StartTick);
+	Algo::StableSortBy(TimeSignatures, &FMidiNotesCacheTimeSignature::StartTick);
+	for (int32 Index = TempoSegments.Num() - 1; Index > 0; --Index)
+	{
+		if (TempoSegments[Index - 1].StartTick == TempoSegments[Index].StartTick)
+		{
+			TempoSegments.RemoveAt(Index - 1, 1, EAllowShrinking::No);
+		}
+	}
+	for (int32 Index = TimeSignatures.Num() - 1; Index > 0; --Index)
+	{
+		if (TimeSignatures[Index - 1].StartTick == TimeSignatures[Index].StartTick)
+		{
+			TimeSignatures.RemoveAt(Index - 1, 1, EAllowShrinking::No);
+		}
+	}
+	if (TempoSegments.IsEmpty() || TempoSegments[0].StartTick > 0)
+	{
+		TempoSegments.Insert(FMidiNotesCacheTempoSegment(), 0);
+	}
+
+	for (int32 Index = 1; Index < TempoSegments.Num(); ++Index)
+	{
+		const FMidiNotesCacheTempoSegment& Previous = TempoSegments[Index - 1];
+		TempoSegments[Index].StartMs = Previous.StartMs
+			+ static_cast<double>(TempoSegments[Index].StartTick - Previous.StartTick) * Previous.MicrosecondsPerQuarterNote / (1000.0 * Header.TicksPerQuarterNote);
+	}
+
+	Header.NumTracks = Tracks.Num();
+	Header.NumNotes = Notes.Num();
+	Header.NumTempoSegments = TempoSegments.Num();
+	Header.NumTimeSignatures = TimeSignatures.Num();
+	Header.NamesSize = Names.Num();
+
+	OutBytes.Reserve(sizeof(FMidiNotesCacheHeader) + Tracks.Num() * sizeof(FMidiNotesCacheTrack) + Notes.Num() * sizeof(FLinkedMidiNote)
+		+ TempoSegments.Num() * sizeof(FMidiNotesCacheTempoSegment) + TimeSignatures.Num() * sizeof(FMidiNotesCacheTimeSignature) + Names.Num() + 5 * MidiNotesCache::SectionAlignment);
+	OutBytes.AddZeroed(sizeof(FMidiNotesCacheHeader));
+	Header.TracksOffset = AppendSection<FMidiNotesCacheTrack>(OutBytes, Tracks);
+	Header.NotesOffset = AppendSection<FLinkedMidiNote>(OutBytes, Notes);
+	Header.TempoSegmentsOffset = AppendSection<FMidiNotesCacheTempoSegment>(OutBytes, TempoSegments);
+	Header.TimeSignaturesOffset = AppendSection<FMidiNotesCacheTimeSignature>(OutBytes, TimeSignatures);
+	Header.NamesOffset = AppendSection<UTF8CHAR>(OutBytes, Names);
+
+	if (OutBytes.Num() > MAX_uint32)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FMidiNotesCacheWriter: %s is too large for a notes cache"), *MidiFile->GetPathName());
+		OutBytes.Reset();
+		return false;
+	}
+
+	Header.TotalSize = OutBytes.Num();
+	FMemory::Memcpy(OutBytes.GetData(), &Header, sizeof(Header));
+	return true;
+}
+
+bool FMidiNotesCacheWriter::WriteToFile(UMidiFile* MidiFile, const FString& FilePath, uint64 SourceStamp)
+{
+	TArray64<uint8> Bytes;
+	if (!Write(MidiFile, Bytes, SourceStamp))
+	{
+		return false;
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+bool FMidiNotesCacheWriter::WriteToFile(UMidiFile* MidiFile, const FMidiNotesData& NotesData, const FString& FilePath, uint64 SourceStamp)
+{
+	TArray64<uint8> Bytes;
+	if (!Write(MidiFile, NotesData, Bytes, SourceStamp))
+	{
+		return false;
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+FString FMidiNotesCacheWriter::GetDefaultCacheDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("MidiNotesCache");
+}
+
+FString FMidiNotesCacheWriter::GetCacheFilePath(const FString& CacheDirectory, FName PackageName)
+{
+	FString RelativePath = PackageName.ToString();
+	RelativePath.RemoveFromStart(TEXT("/"));
+	return CacheDirectory / RelativePath + MidiNotesCache::FileExtension;
+}
@@ -1,7 +1,13 @@
 // Copyright Amir Ben-Kiki 2025
 
 #include "MidiFile/MidiNotesData.h"
+#include "MidiFile/MidiNoteTransform.h"
 #include "HarmonixMidi/MidiFile.h"
+#include "MidiExtensionsStats.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Algo/IsSorted.h"
+#include "Algo/StableSort.h"
 
 // Key for tracking active notes: combines note number and channel
 struct FNoteChannelKey
@@ -20,8 +26,38 @@ struct FNoteChannelKey
     }
 };
 
+// Key for collecting controller lanes while scanning a track
+struct FControllerLaneKey
+{
+    int32 Channel;
+    EMidiControllerType Type;
+    int32 Number;
+
+    bool operator==(const FControllerLaneKey& Other) const
+    {
+        return Channel == Other.Channel && Type == Other.Type && Number == Other.Number;
+    }
+
+    friend uint32 GetTypeHash(const FControllerLaneKey& Key)
+    {
+        return HashCombine(HashCombine(GetTypeHash(Key.Channel), GetTypeHash(Key.Type)), GetTypeHash(Key.Number));
+    }
+};
+
+// Status nibbles of the channel voice messages that end up in controller lanes
+namespace MidiStatus
+{
+    constexpr uint8 PolyAftertouch = 0xA0;
+    constexpr uint8 ControlChange = 0xB0;
+    constexpr uint8 ChannelAftertouch = 0xD0;
+    constexpr uint8 PitchBend = 0xE0;
+}
+
 TSharedPtr<FMidiNotesData> FMidiNotesData::BuildFromMidiFile(UMidiFile* MidiFile)
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_BuildFromMidiFile);
+    TRACE_CPUPROFILER_EVENT_SCOPE(FMidiNotesData::BuildFromMidiFile);
+
     // Create container
     TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> LinkedMidiData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>();
 
@@ -98,10 +134,54 @@ TSharedPtr<FMidiNotesData> FMidiNotesData::BuildFromMidiFile(UMidiFile* MidiFile
         
         // Map of active notes -> pair<OnTick, Velocity> using composite key
         TMap<FNoteChannelKey, TPair<int32, int32>> ActiveNotes;
+
+        // Controller lanes of this track, events are in tick order so the lanes come out sorted
+        TMap<FControllerLaneKey, int32> LaneIndices;
         
         for (const FMidiEvent& Event : Track->GetEvents())
         {
             const FMidiMsg& Msg = Event.GetMsg();
+
+            if (Msg.IsStd() && !Msg.IsNoteOn() && !Msg.IsNoteOff())
+            {
+                FControllerLaneKey LaneKey{ Msg.GetStdChannel(), EMidiControllerType::ControlChange, 0 };
+                int32 Value = 0;
+                switch (Msg.GetStdStatus() & 0xF0)
+                {
+                case MidiStatus::ControlChange:
+                    LaneKey.Number = Msg.GetStdData1();
+                    Value = Msg.GetStdData2();
+                    break;
+                case MidiStatus::PitchBend:
+                    LaneKey.Type = EMidiControllerType::PitchBend;
+                    Value = ((Msg.GetStdData2() << 7) | Msg.GetStdData1()) - 8192;
+                    break;
+                case MidiStatus::ChannelAftertouch:
+                    LaneKey.Type = EMidiControllerType::ChannelAftertouch;
+                    Value = Msg.GetStdData1();
+                    break;
+                case MidiStatus::PolyAftertouch:
+                    LaneKey.Type = EMidiControllerType::PolyAftertouch;
+                    LaneKey.Number = Msg.GetStdData1();
+                    Value = Msg.GetStdData2();
+                    break;
+                default:
+                    continue;
+                }
+
+                const int32* LaneIndex = LaneIndices.Find(LaneKey);
+                if (!LaneIndex)
+                {
+                    FMidiControllerLane& NewLane = LinkedMidiData->ControllerLanes.AddDefaulted_GetRef();
+                    NewLane.TrackIndex = TrackIdx;
+                    NewLane.ChannelIndex = LaneKey.Channel;
+                    NewLane.Type = LaneKey.Type;
+                    NewLane.Number = LaneKey.Number;
+                    LaneIndex = &LaneIndices.Add(LaneKey, LinkedMidiData->ControllerLanes.Num() - 1);
+                }
+                LinkedMidiData->ControllerLanes[*LaneIndex].AddChange(Event.GetTick(), Value);
+                continue;
+            }
             
             if (Msg.IsNoteOn())
             {
@@ -144,14 +224,191 @@ TSharedPtr<FMidiNotesData> FMidiNotesData::BuildFromMidiFile(UMidiFile* MidiFile
         }
     }
 
-	// Finally sort notes in each track by NoteOnTick
-    for (FMidiNotesTrack& NotesTrack : LinkedMidiData->Tracks)
+    LinkedMidiData->FinishBuild();
+    
+    return LinkedMidiData;
+}
+
+void FMidiNotesData::FinishBuild()
+{
+    // Sort notes in each track by NoteOnTick and cache the extents
+    for (FMidiNotesTrack& NotesTrack : Tracks)
     {
         NotesTrack.Notes.Sort([](const FLinkedMidiNote& A, const FLinkedMidiNote& B)
         {
             return A.NoteOnTick < B.NoteOnTick;
         });
-	} 
-    
-    return LinkedMidiData;
+        NotesTrack.RecalculateExtents();
+    }
+    RefreshExtents();
+
+    // Order the lanes so the same file always produces the same lane indices
+    Algo::SortBy(ControllerLanes, [](const FMidiControllerLane& Lane)
+    {
+        return MakeTuple(Lane.TrackIndex, Lane.ChannelIndex, Lane.Type, Lane.Number);
+    });
+}
+
+void FMidiNotesData::RefreshExtents()
+{
+    LastNoteOffTick = 0;
+    for (const FMidiNotesTrack& NotesTrack : Tracks)
+    {
+        LastNoteOffTick = FMath::Max(LastNoteOffTick, NotesTrack.LastNoteOffTick);
+    }
+}
+
+const FMidiControllerLane* FMidiNotesData::FindControllerLane(int32 TrackIndex, int32 ChannelIndex, EMidiControllerType Type, int32 Number) const
+{
+    return ControllerLanes.FindByPredicate([=](const FMidiControllerLane& Lane)
+    {
+        return Lane.Matches(TrackIndex, ChannelIndex, Type, Number);
+    });
+}
+
+int32 FMidiControllerLane::FindChangeIndexAtTick(int32 Tick) const
+{
+    return Algo::UpperBound(Ticks, Tick) - 1;
+}
+
+int32 FMidiControllerLane::GetValueAtTick(int32 Tick, int32 DefaultValue) const
+{
+    const int32 ChangeIndex = FindChangeIndexAtTick(Tick);
+    return ChangeIndex != INDEX_NONE ? Values[ChangeIndex] : DefaultValue;
+}
+
+void FMidiControllerLane::AddChange(int32 Tick, int32 Value)
+{
+    if (!Ticks.IsEmpty() && Ticks.Last() == Tick)
+    {
+        Values.Last() = static_cast<int16>(Value);
+        return;
+    }
+
+    Ticks.Add(Tick);
+    Values.Add(static_cast<int16>(Value));
+}
+
+void FMidiNotesData::TransformNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiNoteTransform& Transform)
+{
+    if (Transform.IsIdentity())
+    {
+        return;
+    }
+
+    for (auto& [TrackIndex, NoteIndices] : FMidiNoteId::GroupByTrack(NoteIds))
+    {
+        if (!Tracks.IsValidIndex(TrackIndex))
+        {
+            continue;
+        }
+
+        FMidiNotesTrack& NotesTrack = Tracks[TrackIndex];
+        NoteIndices.RemoveAll([&NotesTrack](int32 NoteIndex) { return !NotesTrack.Notes.IsValidIndex(NoteIndex); });
+        Transform.Apply(NotesTrack.Notes, NoteIndices);
+        if (!Algo::IsSortedBy(NotesTrack.Notes, &FLinkedMidiNote::NoteOnTick))
+        {
+            Algo::StableSortBy(NotesTrack.Notes, &FLinkedMidiNote::NoteOnTick);
+        }
+        NotesTrack.RecalculateExtents();
+    }
+
+    RefreshExtents();
+    ++Revision;
+}
+
+void FMidiNotesTrack::ExpandExtents(const FLinkedMidiNote& Note)
+{
+    if (!HasNotes())
+    {
+        FirstNoteOnTick = Note.NoteOnTick;
+        LastNoteOffTick = Note.NoteOffTick;
+        LowestNoteNumber = Note.NoteNumber;
+        HighestNoteNumber = Note.NoteNumber;
+        return;
+    }
+
+    FirstNoteOnTick = FMath::Min(FirstNoteOnTick, Note.NoteOnTick);
+    LastNoteOffTick = FMath::Max(LastNoteOffTick, Note.NoteOffTick);
+    LowestNoteNumber = FMath::Min(LowestNoteNumber, (int32)Note.NoteNumber);
+    HighestNoteNumber = FMath::Max(HighestNoteNumber, (int32)Note.NoteNumber);
+}
+
+bool FMidiNotesTrack::IsOnExtentsBoundary(const FLinkedMidiNote& Note) const
+{
+    return Note.NoteOnTick <= FirstNoteOnTick
+        || Note.NoteOffTick >= LastNoteOffTick
+        || Note.NoteNumber <= LowestNoteNumber
+        || Note.NoteNumber >= HighestNoteNumber;
+}
+
+void FMidiNotesTrack::RecalculateExtents()
+{
+    FirstNoteOnTick = INDEX_NONE;
+    LastNoteOffTick = 0;
+    LowestNoteNumber = INDEX_NONE;
+    HighestNoteNumber = INDEX_NONE;
+
+    for (const FLinkedMidiNote& Note : Notes)
+    {
+        ExpandExtents(Note);
+    }
+}
+
+FMidiFileIterator::FMidiFileIterator(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InMidiData)
+    : MidiData(MoveTemp(InMidiData))
+{
+    SeekToTick(TNumericLimits<int32>::Lowest());
+}
+
+const FLinkedMidiNote& FMidiFileIterator::GetCurrentNote() const
+{
+    check(IsValid());
+    const int32 TrackIndex = Heap.HeapTop().TrackIndex;
+    return MidiData->Tracks[TrackIndex].Notes[TrackCursors[TrackIndex]];
+}
+
+void FMidiFileIterator::Advance()
+{
+    if (!IsValid())
+    {
+        return;
+    }
+
+    FTrackCursor Cursor;
+    Heap.HeapPop(Cursor, EAllowShrinking::No);
+
+    const TArray<FLinkedMidiNote>& Notes = MidiData->Tracks[Cursor.TrackIndex].Notes;
+    const int32 NextNoteIndex = ++TrackCursors[Cursor.TrackIndex];
+    if (NextNoteIndex < Notes.Num())
+    {
+        Heap.HeapPush(FTrackCursor{ Notes[NextNoteIndex].NoteOnTick, Cursor.TrackIndex });
+    }
+}
+
+void FMidiFileIterator::SeekToTick(int32 Tick)
+{
+    Heap.Reset();
+    if (!MidiData.IsValid())
+    {
+        TrackCursors.Reset();
+        return;
+    }
+
+    const int32 NumTracks = MidiData->Tracks.Num();
+    TrackCursors.SetNumUninitialized(NumTracks);
+    Heap.Reserve(NumTracks);
+
+    for (int32 TrackIdx = 0; TrackIdx < NumTracks; ++TrackIdx)
+    {
+        const TArray<FLinkedMidiNote>& Notes = MidiData->Tracks[TrackIdx].Notes;
+        const int32 NoteIndex = Algo::LowerBoundBy(Notes, Tick, &FLinkedMidiNote::NoteOnTick);
+        TrackCursors[TrackIdx] = NoteIndex;
+        if (NoteIndex < Notes.Num())
+        {
+            Heap.Add(FTrackCursor{ Notes[NoteIndex].NoteOnTick, TrackIdx });
+        }
+    }
+
+    Heap.Heapify();
 }
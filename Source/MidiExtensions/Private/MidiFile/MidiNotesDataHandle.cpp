@@ -0,0 +1,189 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiNotesDataHandle.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/IsSorted.h"
+#include "HarmonixMidi/MidiFile.h"
+
+UMidiNotesDataHandle* UMidiNotesDataHandle::Create(UObject* Outer, TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> InNotesData)
+{
+	UMidiNotesDataHandle* Handle = NewObject<UMidiNotesDataHandle>(Outer ? Outer : GetTransientPackage());
+	Handle->NotesData = MoveTemp(InNotesData);
+	return Handle;
+}
+
+int32 UMidiNotesDataHandle::GetNumTracks() const
+{
+	return NotesData.IsValid() ? NotesData->Tracks.Num() : 0;
+}
+
+int32 UMidiNotesDataHandle::GetNoteCount() const
+{
+	if (!NotesData.IsValid())
+	{
+		return 0;
+	}
+
+	int32 NoteCount = 0;
+	for (const FMidiNotesTrack& Track : NotesData->Tracks)
+	{
+		NoteCount += Track.Notes.Num();
+	}
+	return NoteCount;
+}
+
+int32 UMidiNotesDataHandle::GetTrackNoteCount(int32 TrackIndex) const
+{
+	if (!NotesData.IsValid() || !NotesData->Tracks.IsValidIndex(TrackIndex))
+	{
+		return 0;
+	}
+	return NotesData->Tracks[TrackIndex].Notes.Num();
+}
+
+int32 UMidiNotesDataHandle::GetLastNoteOffTick() const
+{
+	return NotesData.IsValid() ? NotesData->LastNoteOffTick : 0;
+}
+
+bool UMidiNotesDataHandle::GetTrackInfo(int32 TrackIndex, FString& TrackName, int32& MidiTrackIndex, int32& ChannelIndex, int32& FirstNoteOnTick, int32& LastNoteOffTick) const
+{
+	if (!NotesData.IsValid() || !NotesData->Tracks.IsValidIndex(TrackIndex))
+	{
+		return false;
+	}
+
+	const FMidiNotesTrack& Track = NotesData->Tracks[TrackIndex];
+	TrackName = Track.TrackName;
+	MidiTrackIndex = Track.TrackIndex;
+	ChannelIndex = Track.ChannelIndex;
+	FirstNoteOnTick = Track.FirstNoteOnTick;
+	LastNoteOffTick = Track.LastNoteOffTick;
+	return true;
+}
+
+TArray<FLinkedMidiNote> UMidiNotesDataHandle::GetNotesInRange(int32 TrackIndex, int32 StartTick, int32 EndTick) const
+{
+	if (!NotesData.IsValid() || !NotesData->Tracks.IsValidIndex(TrackIndex) || EndTick <= StartTick)
+	{
+		return TArray<FLinkedMidiNote>();
+	}
+
+	// UMutableMidiFile edits sort the tracks they touch again, so the notes of a shared handle stay searchable
+	const TArray<FLinkedMidiNote>& Notes = NotesData->Tracks[TrackIndex].Notes;
+	checkSlow(Algo::IsSortedBy(Notes, &FLinkedMidiNote::NoteOnTick));
+	const int32 First = Algo::LowerBoundBy(Notes, StartTick, &FLinkedMidiNote::NoteOnTick);
+	const int32 Last = Algo::LowerBoundBy(Notes, EndTick, &FLinkedMidiNote::NoteOnTick);
+	return TArray<FLinkedMidiNote>(Notes.GetData() + First, Last - First);
+}
+
+FMidiFileIterator UMidiNotesDataHandle::MakeIterator(int32 StartTick) const
+{
+	FMidiFileIterator Iterator(NotesData);
+	Iterator.SeekToTick(StartTick);
+	return Iterator;
+}
+
+bool UMidiNotesDataHandle::GetNote(int32 TrackIndex, int32 NoteIndex, FLinkedMidiNote& Note) const
+{
+	if (!NotesData.IsValid() || !NotesData->Tracks.IsValidIndex(TrackIndex) || !NotesData->Tracks[TrackIndex].Notes.IsValidIndex(NoteIndex))
+	{
+		return false;
+	}
+
+	Note = NotesData->Tracks[TrackIndex].Notes[NoteIndex];
+	return true;
+}
+
+TArray<int32> UMidiNotesDataHandle::GetNotesActiveAtTick(int32 TrackIndex, int32 Tick) const
+{
+	TArray<int32> NoteIndices;
+	GetQueryIndex().GetNotesActiveAtTick(TrackIndex, Tick, NoteIndices);
+	return NoteIndices;
+}
+
+int32 UMidiNotesDataHandle::CountNotesActiveAtTick(int32 TrackIndex, int32 Tick) const
+{
+	return GetQueryIndex().CountNotesActiveAtTick(TrackIndex, Tick);
+}
+
+int32 UMidiNotesDataHandle::FindNextNoteOnset(int32 TrackIndex, int32 Tick) const
+{
+	return GetQueryIndex().FindNextNoteOnset(TrackIndex, Tick);
+}
+
+int32 UMidiNotesDataHandle::FindPreviousNoteOnset(int32 TrackIndex, int32 Tick) const
+{
+	return GetQueryIndex().FindPreviousNoteOnset(TrackIndex, Tick);
+}
+
+int32 UMidiNotesDataHandle::CountNotesStartingInRange(int32 TrackIndex, int32 StartTick, int32 EndTick) const
+{
+	return GetQueryIndex().CountNotesStartingInRange(TrackIndex, StartTick, EndTick);
+}
+
+TArray<int32> UMidiNotesDataHandle::GetNotesActiveAtMs(int32 TrackIndex, float Ms) const
+{
+	TArray<int32> NoteIndices;
+	if (const FSongMaps* SongMaps = GetSongMaps())
+	{
+		GetQueryIndex().GetNotesActiveAtMs(*SongMaps, TrackIndex, Ms, NoteIndices);
+	}
+	return NoteIndices;
+}
+
+int32 UMidiNotesDataHandle::CountNotesActiveAtMs(int32 TrackIndex, float Ms) const
+{
+	const FSongMaps* SongMaps = GetSongMaps();
+	return SongMaps ? GetQueryIndex().CountNotesActiveAtMs(*SongMaps, TrackIndex, Ms) : 0;
+}
+
+int32 UMidiNotesDataHandle::FindNextNoteOnsetAfterMs(int32 TrackIndex, float Ms) const
+{
+	const FSongMaps* SongMaps = GetSongMaps();
+	return SongMaps ? GetQueryIndex().FindNextNoteOnsetAfterMs(*SongMaps, TrackIndex, Ms) : INDEX_NONE;
+}
+
+int32 UMidiNotesDataHandle::FindPreviousNoteOnsetBeforeMs(int32 TrackIndex, float Ms) const
+{
+	const FSongMaps* SongMaps = GetSongMaps();
+	return SongMaps ? GetQueryIndex().FindPreviousNoteOnsetBeforeMs(*SongMaps, TrackIndex, Ms) : INDEX_NONE;
+}
+
+int32 UMidiNotesDataHandle::CountNotesStartingInMsRange(int32 TrackIndex, float StartMs, float EndMs) const
+{
+	const FSongMaps* SongMaps = GetSongMaps();
+	return SongMaps ? GetQueryIndex().CountNotesStartingInMsRange(*SongMaps, TrackIndex, StartMs, EndMs) : 0;
+}
+
+bool UMidiNotesDataHandle::HasControllerLane(int32 TrackIndex, int32 ChannelIndex, EMidiControllerType Type, int32 Number) const
+{
+	return NotesData.IsValid() && NotesData->FindControllerLane(TrackIndex, ChannelIndex, Type, Number) != nullptr;
+}
+
+int32 UMidiNotesDataHandle::GetControllerValueAtTick(int32 TrackIndex, int32 ChannelIndex, EMidiControllerType Type, int32 Number, int32 Tick, int32 DefaultValue) const
+{
+	const FMidiControllerLane* Lane = NotesData.IsValid() ? NotesData->FindControllerLane(TrackIndex, ChannelIndex, Type, Number) : nullptr;
+	return Lane ? Lane->GetValueAtTick(Tick, DefaultValue) : DefaultValue;
+}
+
+const FMidiNoteQueryIndex& UMidiNotesDataHandle::GetQueryIndex() const
+{
+	if (!QueryIndex.IsValid() || (NotesData.IsValid() && !QueryIndex->IsUpToDate()))
+	{
+		QueryIndex = FMidiNoteQueryIndex::Build(NotesData);
+	}
+	return *QueryIndex;
+}
+
+const FSongMaps* UMidiNotesDataHandle::GetSongMaps() const
+{
+	// Handles are always outered to the midi file they were created for
+	const UMidiFile* MidiFile = Cast<UMidiFile>(GetOuter());
+	if (!MidiFile)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UMidiNotesDataHandle: No midi file to convert milliseconds with"));
+		return nullptr;
+	}
+	return MidiFile->GetSongMaps();
+}
@@ -0,0 +1,115 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiNotesSnapshot.h"
+
+TRefCountPtr<FMidiNotesSnapshot> FMidiNotesSnapshot::Build(const FMidiNotesData& NotesData, uint32 ContentVersion, const FMidiNotesSnapshot* Previous, TConstArrayView<int32> EditedTracks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiNotesSnapshot::Build);
+
+	TRefCountPtr<FMidiNotesSnapshot> Snapshot = new FMidiNotesSnapshot();
+	Snapshot->LastNoteOffTick = NotesData.LastNoteOffTick;
+	Snapshot->ContentVersion = ContentVersion;
+
+	Snapshot->Tracks.Reserve(NotesData.Tracks.Num());
+	for (int32 TrackIndex = 0; TrackIndex < NotesData.Tracks.Num(); ++TrackIndex)
+	{
+		if (Previous && Previous->Tracks.IsValidIndex(TrackIndex) && !EditedTracks.Contains(TrackIndex))
+		{
+			Snapshot->Tracks.Add(Previous->Tracks[TrackIndex]);
+		}
+		else
+		{
+			Snapshot->Tracks.Add(MakeShared<const FMidiNotesTrack, ESPMode::ThreadSafe>(NotesData.Tracks[TrackIndex]));
+		}
+	}
+
+	// Note edits never touch the controller lanes
+	Snapshot->ControllerLanes = Previous && Previous->ControllerLanes.IsValid()
+		? Previous->ControllerLanes
+		: MakeShared<const TArray<FMidiControllerLane>, ESPMode::ThreadSafe>(NotesData.ControllerLanes);
+
+	return Snapshot;
+}
+
+TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> FMidiNotesSnapshot::ToNotesData() const
+{
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>();
+	NotesData->Tracks.Reserve(Tracks.Num());
+	for (const FTrackPtr& Track : Tracks)
+	{
+		NotesData->Tracks.Add(*Track);
+	}
+	if (ControllerLanes.IsValid())
+	{
+		NotesData->ControllerLanes = *ControllerLanes;
+	}
+	NotesData->LastNoteOffTick = LastNoteOffTick;
+	return NotesData;
+}
+
+FMidiNotesSnapshotPublisher::~FMidiNotesSnapshotPublisher()
+{
+	// Readers hold their own references, nobody can be inside Acquire once the publisher is being destroyed
+	if (const FMidiNotesSnapshot* Snapshot = Current.exchange(nullptr))
+	{
+		Snapshot->Release();
+	}
+	for (const FRetiredSnapshot& Retired : RetiredSnapshots)
+	{
+		Retired.Snapshot->Release();
+	}
+}
+
+TRefCountPtr<const FMidiNotesSnapshot> FMidiNotesSnapshotPublisher::Acquire() const
+{
+	std::atomic<int32>& Readers = ActiveReaders[Epoch.load() & 1];
+	Readers.fetch_add(1);
+	TRefCountPtr<const FMidiNotesSnapshot> Snapshot(Current.load());
+	Readers.fetch_sub(1);
+	return Snapshot;
+}
+
+void FMidiNotesSnapshotPublisher::Publish(TRefCountPtr<FMidiNotesSnapshot> Snapshot)
+{
+	const FMidiNotesSnapshot* NewSnapshot = Snapshot.GetReference();
+	if (NewSnapshot)
+	{
+		// The publisher's own reference
+		NewSnapshot->AddRef();
+	}
+
+	if (const FMidiNotesSnapshot* OldSnapshot = Current.exchange(NewSnapshot))
+	{
+		RetiredSnapshots.Add({ OldSnapshot });
+	}
+
+	// New readers go to the other counter, the one they leave only drains from here on
+	Epoch.fetch_add(1);
+	ReclaimRetiredSnapshots();
+}
+
+void FMidiNotesSnapshotPublisher::ReclaimRetiredSnapshots()
+{
+	// A reader still about to reference a retired snapshot entered before it was swapped out and has not left its
+	// counter yet. Seeing a counter at zero after the swap proves every such reader of that counter is done with it
+	for (int32 Parity = 0; Parity < 2; ++Parity)
+	{
+		if (ActiveReaders[Parity].load() == 0)
+		{
+			for (FRetiredSnapshot& Retired : RetiredSnapshots)
+			{
+				Retired.bReadersDrained[Parity] = true;
+			}
+		}
+	}
+
+	RetiredSnapshots.RemoveAll([](const FRetiredSnapshot& Retired)
+	{
+		if (Retired.bReadersDrained[0] && Retired.bReadersDrained[1])
+		{
+			Retired.Snapshot->Release();
+			return true;
+		}
+		return false;
+	});
+}
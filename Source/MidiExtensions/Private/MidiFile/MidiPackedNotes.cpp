@@ -0,0 +1,200 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiPackedNotes.h"
+#include "MidiExtensionsStats.h"
+
+namespace
+{
+	void WriteVarLen(TArray<uint8>& Bytes, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Bytes.Add(static_cast<uint8>(Value) | 0x80);
+			Value >>= 7;
+		}
+		Bytes.Add(static_cast<uint8>(Value));
+	}
+
+	uint32 ZigZagEncode(int32 Value)
+	{
+		return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+	}
+}
+
+FMidiPackedNotes::FMidiPackedNotes(FMidiPackedNotes&& Other)
+	: Tracks(MoveTemp(Other.Tracks))
+	, LastNoteOffTick(Other.LastNoteOffTick)
+{
+	// The stats follow the tracks, the moved from object is left empty
+	Other.LastNoteOffTick = 0;
+}
+
+FMidiPackedNotes& FMidiPackedNotes::operator=(FMidiPackedNotes&& Other)
+{
+	if (this != &Other)
+	{
+		UpdateMemoryStats(false);
+		Tracks = MoveTemp(Other.Tracks);
+		LastNoteOffTick = Other.LastNoteOffTick;
+		Other.LastNoteOffTick = 0;
+	}
+	return *this;
+}
+
+FMidiPackedNotes::~FMidiPackedNotes()
+{
+	UpdateMemoryStats(false);
+}
+
+FMidiPackedNotes FMidiPackedNotes::Pack(const FMidiNotesData& NotesData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiPackedNotes::Pack);
+
+	FMidiPackedNotes Packed;
+	Packed.LastNoteOffTick = NotesData.LastNoteOffTick;
+	Packed.Tracks.Reserve(NotesData.Tracks.Num());
+
+	for (const FMidiNotesTrack& NotesTrack : NotesData.Tracks)
+	{
+		FTrack& Track = Packed.Tracks.AddDefaulted_GetRef();
+		Track.TrackName = NotesTrack.TrackName;
+		Track.TrackIndex = NotesTrack.TrackIndex;
+		Track.ChannelIndex = NotesTrack.ChannelIndex;
+		Track.NumNotes = NotesTrack.Notes.Num();
+		Track.FirstNoteOnTick = NotesTrack.FirstNoteOnTick;
+		Track.LastNoteOffTick = NotesTrack.LastNoteOffTick;
+		Track.LowestNoteNumber = NotesTrack.LowestNoteNumber;
+		Track.HighestNoteNumber = NotesTrack.HighestNoteNumber;
+
+		// Sorted notes mostly take 4-5 bytes, reserving for that avoids regrowing the stream on typical tracks
+		Track.Blocks.Reserve(FMath::DivideAndRoundUp(Track.NumNotes, NotesPerBlock));
+		Track.Bytes.Reserve(Track.NumNotes * 5);
+
+		int32 PreviousTick = 0;
+		int32 PreviousVelocity = INDEX_NONE;
+		for (int32 NoteIndex = 0; NoteIndex < Track.NumNotes; ++NoteIndex)
+		{
+			const FLinkedMidiNote& Note = NotesTrack.Notes[NoteIndex];
+			if (NoteIndex % NotesPerBlock == 0)
+			{
+				Track.Blocks.Add({ Note.NoteOnTick, static_cast<uint32>(Track.Bytes.Num()) });
+				PreviousTick = Note.NoteOnTick;
+				PreviousVelocity = INDEX_NONE;
+			}
+
+			if (NoteIndex > 0 && Note.NoteOnTick < NotesTrack.Notes[NoteIndex - 1].NoteOnTick)
+			{
+				Track.bSortedByNoteOnTick = false;
+			}
+
+			WriteVarLen(Track.Bytes, ZigZagEncode(Note.NoteOnTick - PreviousTick));
+			WriteVarLen(Track.Bytes, static_cast<uint32>(FMath::Max(0, Note.NoteOffTick - Note.NoteOnTick)));
+			PreviousTick = Note.NoteOnTick;
+
+			const int32 Velocity = FLinkedMidiNote::ClampVelocity(Note.Velocity);
+			const uint8 PitchByte = static_cast<uint8>(FLinkedMidiNote::ClampNoteNumber(Note.NoteNumber));
+			if (Velocity == PreviousVelocity)
+			{
+				Track.Bytes.Add(PitchByte | 0x80);
+			}
+			else
+			{
+				Track.Bytes.Add(PitchByte);
+				Track.Bytes.Add(static_cast<uint8>(Velocity));
+				PreviousVelocity = Velocity;
+			}
+		}
+
+		Track.Bytes.Shrink();
+	}
+
+	Packed.UpdateMemoryStats(true);
+	return Packed;
+}
+
+TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> FMidiPackedNotes::Unpack() const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiPackedNotes::Unpack);
+
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>();
+	NotesData->LastNoteOffTick = LastNoteOffTick;
+	NotesData->Tracks.Reserve(Tracks.Num());
+
+	for (int32 TrackIndex = 0; TrackIndex < Tracks.Num(); ++TrackIndex)
+	{
+		const FTrack& Track = Tracks[TrackIndex];
+		FMidiNotesTrack& NotesTrack = NotesData->Tracks.AddDefaulted_GetRef();
+		NotesTrack.TrackName = Track.TrackName;
+		NotesTrack.TrackIndex = Track.TrackIndex;
+		NotesTrack.ChannelIndex = Track.ChannelIndex;
+		NotesTrack.FirstNoteOnTick = Track.FirstNoteOnTick;
+		NotesTrack.LastNoteOffTick = Track.LastNoteOffTick;
+		NotesTrack.LowestNoteNumber = Track.LowestNoteNumber;
+		NotesTrack.HighestNoteNumber = Track.HighestNoteNumber;
+		DecodeTrack(TrackIndex, NotesTrack.Notes);
+	}
+
+	return NotesData;
+}
+
+int32 FMidiPackedNotes::GetNumNotes() const
+{
+	int32 NumNotes = 0;
+	for (const FTrack& Track : Tracks)
+	{
+		NumNotes += Track.NumNotes;
+	}
+	return NumNotes;
+}
+
+void FMidiPackedNotes::DecodeTrack(int32 TrackIndex, TArray<FLinkedMidiNote>& OutNotes) const
+{
+	if (!Tracks.IsValidIndex(TrackIndex))
+	{
+		return;
+	}
+
+	OutNotes.Reserve(OutNotes.Num() + Tracks[TrackIndex].NumNotes);
+	ForEachNote(TrackIndex, [&OutNotes](const FLinkedMidiNote& Note) { OutNotes.Add(Note); });
+}
+
+SIZE_T FMidiPackedNotes::GetAllocatedSize() const
+{
+	SIZE_T Size = Tracks.GetAllocatedSize();
+	for (const FTrack& Track : Tracks)
+	{
+		Size += Track.TrackName.GetAllocatedSize() + Track.Blocks.GetAllocatedSize() + Track.Bytes.GetAllocatedSize();
+	}
+	return Size;
+}
+
+SIZE_T FMidiPackedNotes::GetUnpackedSize() const
+{
+	SIZE_T Size = Tracks.Num() * sizeof(FMidiNotesTrack);
+	for (const FTrack& Track : Tracks)
+	{
+		Size += Track.TrackName.GetAllocatedSize() + Track.NumNotes * sizeof(FLinkedMidiNote);
+	}
+	return Size;
+}
+
+void FMidiPackedNotes::UpdateMemoryStats(bool bAdd) const
+{
+#if STATS
+	if (Tracks.IsEmpty())
+	{
+		return;
+	}
+
+	if (bAdd)
+	{
+		INC_MEMORY_STAT_BY(STAT_MidiExtensions_PackedNotesMemory, GetAllocatedSize());
+		INC_MEMORY_STAT_BY(STAT_MidiExtensions_PackedNotesUnpackedMemory, GetUnpackedSize());
+	}
+	else
+	{
+		DEC_MEMORY_STAT_BY(STAT_MidiExtensions_PackedNotesMemory, GetAllocatedSize());
+		DEC_MEMORY_STAT_BY(STAT_MidiExtensions_PackedNotesUnpackedMemory, GetUnpackedSize());
+	}
+#endif
+}
@@ -0,0 +1,123 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MidiQuantize.h"
+#include "Async/ParallelFor.h"
+#include "Math/RandomStream.h"
+#include "MidiExtensionsStats.h"
+#include "MidiFile/MidiNoteTransform.h"
+#include "MidiFile/MutableMidiFile.h"
+
+int32 FMidiQuantizer::SnapTickToGrid(const FSongMaps& SongMaps, int32 Tick, EMidiClockSubdivisionQuantization Division)
+{
+	return SongMaps.QuantizeTickToNearestSubdivision(Tick, EMidiFileQuantizeDirection::Nearest, Division);
+}
+
+FLinkedMidiNote FMidiQuantizer::QuantizeNote(const FSongMaps& SongMaps, const FLinkedMidiNote& Note, const FMidiQuantizeSettings& Settings, const FMidiNoteId& NoteId)
+{
+	FLinkedMidiNote Result = Note;
+	const float Strength = FMath::Clamp(Settings.Strength, 0.0f, 1.0f);
+
+	int32 TargetOnTick = SnapTickToGrid(SongMaps, Note.NoteOnTick, Settings.Division);
+	if (Settings.Swing > 0.0f)
+	{
+		// Grid points are counted from the start of their bar so swing lines up across time signature changes
+		const int32 Step = FMath::Max(1, SongMaps.SubdivisionToMidiTicks(Settings.Division, TargetOnTick));
+		const int32 BarStartTick = SongMaps.QuantizeTickToNearestSubdivision(TargetOnTick, EMidiFileQuantizeDirection::Down, EMidiClockSubdivisionQuantization::Bar);
+		if (((TargetOnTick - BarStartTick) / Step) % 2 == 1)
+		{
+			TargetOnTick += FMath::RoundToInt32(Step * FMath::Clamp(Settings.Swing, 0.0f, 1.0f));
+		}
+	}
+
+	Result.NoteOnTick = Note.NoteOnTick + FMath::RoundToInt32((TargetOnTick - Note.NoteOnTick) * Strength);
+	if (Settings.bQuantizeNoteEnds)
+	{
+		const int32 TargetOffTick = SnapTickToGrid(SongMaps, Note.NoteOffTick, Settings.Division);
+		Result.NoteOffTick = Note.NoteOffTick + FMath::RoundToInt32((TargetOffTick - Note.NoteOffTick) * Strength);
+	}
+	else
+	{
+		Result.NoteOffTick = Note.NoteOffTick + (Result.NoteOnTick - Note.NoteOnTick);
+	}
+
+	if (Settings.HumanizeTicks > 0 || Settings.HumanizeVelocity > 0)
+	{
+		// Seeded per note rather than per batch, so the result doesn't depend on how the work was split
+		FRandomStream Random(HashCombine(HashCombine(GetTypeHash(Settings.Seed), GetTypeHash(NoteId.TrackIndex)), GetTypeHash(NoteId.NoteIndex)));
+		const int32 TickOffset = Random.RandRange(-Settings.HumanizeTicks, Settings.HumanizeTicks);
+		Result.NoteOnTick += TickOffset;
+		Result.NoteOffTick += TickOffset;
+		Result.Velocity = static_cast<int8>(FMath::Clamp(Result.Velocity + Random.RandRange(-Settings.HumanizeVelocity, Settings.HumanizeVelocity), 1, 127));
+	}
+
+	Result.NoteOnTick = FMath::Max(0, Result.NoteOnTick);
+	Result.NoteOffTick = FMath::Max(Result.NoteOnTick + 1, Result.NoteOffTick);
+	return Result;
+}
+
+TArray<FNotesEditCallbackData> FMidiQuantizer::BuildEdits(const FMidiNotesData& NotesData, const FSongMaps& SongMaps, TConstArrayView<FMidiNoteId> NoteIds, const FMidiQuantizeSettings& Settings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_Quantize);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiQuantizer::BuildEdits);
+
+	// Every note gets a slot so batches write without synchronisation, unchanged notes are compacted out afterwards
+	TArray<FNotesEditCallbackData> Edits;
+	Edits.SetNum(NoteIds.Num());
+	TArray<bool> Changed;
+	Changed.SetNumZeroed(NoteIds.Num());
+
+	const int32 NumBatches = FMath::DivideAndRoundUp(NoteIds.Num(), BatchSize);
+	ParallelFor(NumBatches, [&](int32 BatchIndex)
+	{
+		const int32 Begin = BatchIndex * BatchSize;
+		const int32 End = FMath::Min(Begin + BatchSize, NoteIds.Num());
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			const FMidiNoteId& NoteId = NoteIds[Index];
+			if (!NotesData.Tracks.IsValidIndex(NoteId.TrackIndex) || !NotesData.Tracks[NoteId.TrackIndex].Notes.IsValidIndex(NoteId.NoteIndex))
+			{
+				continue;
+			}
+
+			const FLinkedMidiNote& Note = NotesData.Tracks[NoteId.TrackIndex].Notes[NoteId.NoteIndex];
+			const FLinkedMidiNote Quantized = QuantizeNote(SongMaps, Note, Settings, NoteId);
+			if (Quantized.NoteOnTick == Note.NoteOnTick && Quantized.NoteOffTick == Note.NoteOffTick && Quantized.Velocity == Note.Velocity)
+			{
+				continue;
+			}
+
+			FNotesEditCallbackData& Edit = Edits[Index];
+			Edit.TrackIndex = NoteId.TrackIndex;
+			Edit.NoteIndex = NoteId.NoteIndex;
+			Edit.NoteData = Quantized;
+			Edit.bDelete = false;
+			Changed[Index] = true;
+		}
+	});
+
+	int32 NumChanged = 0;
+	for (int32 Index = 0; Index < Edits.Num(); ++Index)
+	{
+		if (Changed[Index])
+		{
+			Edits[NumChanged++] = Edits[Index];
+		}
+	}
+	Edits.SetNum(NumChanged);
+	return Edits;
+}
+
+TArray<FMidiNoteId> FMidiQuantizer::GetTrackNoteIds(const FMidiNotesData& NotesData, int32 TrackIndex)
+{
+	TArray<FMidiNoteId> NoteIds;
+	if (NotesData.Tracks.IsValidIndex(TrackIndex))
+	{
+		const int32 NumNotes = NotesData.Tracks[TrackIndex].Notes.Num();
+		NoteIds.SetNumUninitialized(NumNotes);
+		for (int32 NoteIndex = 0; NoteIndex < NumNotes; ++NoteIndex)
+		{
+			NoteIds[NoteIndex] = { TrackIndex, NoteIndex };
+		}
+	}
+	return NoteIds;
+}
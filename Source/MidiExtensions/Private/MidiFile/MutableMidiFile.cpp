@@ -1,22 +1,82 @@
 // Copyright notice in the Description page of Project Settings.
 
 #include "MidiFile/MutableMidiFile.h"
+#include "MidiFile/MidiNotesDataHandle.h"
+#include "MidiFile/MidiNoteTransform.h"
+#include "MidiFile/MidiFileStreamReader.h"
 #include "CoreMinimal.h"
 #include "HarmonixMidi/MidiTrack.h"
 #include "HarmonixMidi/MidiEvent.h"
 #include "HarmonixMidi/MidiMsg.h"
+#include "HarmonixMidi/MidiConstants.h"
 #include "UObject/Package.h"
 #include "UObject/SavePackage.h"
 #include "Misc/PackageName.h"
+#include "HAL/FileManager.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "Algo/IsSorted.h"
+#include "Algo/StableSort.h"
+#include "MidiExtensionsStats.h"
 
 
 TSharedPtr<Audio::IProxyData> UMutableMidiFile::CreateProxyData(const Audio::FProxyDataInitParams& InitParams)
 {
-    LinkedMidiData = FMidiNotesData::BuildFromMidiFile(this);
-	
+    // Edits keep the linked notes current, they are only rebuilt when the data changed some other way
+    EnsureLinkedMidiData();
+
+	// The renderable copy is kept up to date by the edits, the base class only creates it if there is none
 	return UMidiFile::CreateProxyData(InitParams);
 }
 
+void UMutableMidiFile::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Loads and undo/redo replace the tracks under the linked notes
+	if (Ar.IsLoading())
+	{
+		MarkContentChanged();
+		RenderableCopyOfMidiFileData = nullptr;
+	}
+}
+
+#if WITH_EDITOR
+void UMutableMidiFile::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	// The undo reloaded the tracks, readers should not keep seeing the undone notes
+	PublishSnapshot();
+}
+#endif
+
+TSharedRef<FMidiNotesSnapshotPublisher, ESPMode::ThreadSafe> UMutableMidiFile::GetSnapshotPublisher()
+{
+	if (!bPublishSnapshots)
+	{
+		bPublishSnapshots = true;
+		PublishSnapshot();
+	}
+	return SnapshotPublisher;
+}
+
+void UMutableMidiFile::PublishSnapshot(TConstArrayView<int32> EditedTracks)
+{
+	if (!bPublishSnapshots)
+	{
+		return;
+	}
+
+	EnsureLinkedMidiData();
+
+	const TRefCountPtr<const FMidiNotesSnapshot> Previous = SnapshotPublisher->Acquire();
+	const bool bIncremental = !EditedTracks.IsEmpty() && Previous.IsValid() && SnapshotSource == LinkedMidiData.Get() && Previous->GetContentVersion() + 1 == ContentVersion;
+
+	SnapshotPublisher->Publish(FMidiNotesSnapshot::Build(*LinkedMidiData, ContentVersion, bIncremental ? Previous.GetReference() : nullptr, EditedTracks));
+	SnapshotSource = LinkedMidiData.Get();
+}
+
 
 void UMutableMidiFile::InitializeFromMidiFile(UMidiFile* SourceFile)
 {
@@ -25,39 +85,175 @@ void UMutableMidiFile::InitializeFromMidiFile(UMidiFile* SourceFile)
 		return;
 	}
 
-	// Copy the base file's MIDI data using the proxy system
-	// This copies all data including tempo map, time signatures, and song length
-	Audio::FProxyDataInitParams InitParams{ TEXT("MutableMidiFile") };
-	auto ProxyData = SourceFile->CreateProxyData(InitParams);
-	TheMidiData = *StaticCastSharedPtr<FMidiFileProxy>(ProxyData)->GetMidiFile();
+	if (const UMutableMidiFile* MutableSource = Cast<UMutableMidiFile>(SourceFile))
+	{
+		// A mutable file sorts and rescans its tracks after every edit, its data is taken as is
+		TheMidiData = MutableSource->TheMidiData;
+		MarkContentChanged();
+
+		// The linked notes are shared until this file needs its own, see EnsureLinkedMidiData
+		LinkedMidiData.Reset();
+		SharedSourceMidiData = MutableSource->LinkedMidiData;
+		SharedSourceRevision = SharedSourceMidiData.IsValid() ? SharedSourceMidiData->Revision : 0;
+	}
+	else
+	{
+		// Copy the base file's MIDI data using the proxy system
+		// This copies all data including tempo map, time signatures, and song length
+		Audio::FProxyDataInitParams InitParams{ TEXT("MutableMidiFile") };
+		auto ProxyData = SourceFile->CreateProxyData(InitParams);
+		TheMidiData = *StaticCastSharedPtr<FMidiFileProxy>(ProxyData)->GetMidiFile();
+		ProxyData.Reset();
+
+		// Sort all tracks to ensure consistency
+		SortAllTracks();
+
+		// Scan tracks to ensure song length and maps are correctly set
+		// This is important because it finalizes the tempo map and other song data
+		ScanTracksForSongLengthChange();
+		MarkContentChanged();
+
+		// Built on the first edit or handle request, viewers build their own copy of the notes anyway
+		LinkedMidiData.Reset();
+		SharedSourceMidiData.Reset();
+	}
+
+	// Invalidate renderable copy to force regeneration
+	RenderableCopyOfMidiFileData = nullptr;
+	PublishSnapshot();
+}
 
-	// Sort all tracks to ensure consistency
-	SortAllTracks();
+void UMutableMidiFile::EnsureLinkedMidiData()
+{
+	if (LinkedMidiData.IsValid() && LinkedMidiDataVersion == ContentVersion)
+	{
+		return;
+	}
+
+	// Copying the source's notes skips the walk over the events, unless the source was edited since they were shared
+	if (SharedSourceMidiData.IsValid() && SharedSourceMidiData->Revision == SharedSourceRevision)
+	{
+		LinkedMidiData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>(*SharedSourceMidiData);
+	}
+	else
+	{
+		LinkedMidiData = FMidiNotesData::BuildFromMidiFile(this);
+	}
+	SharedSourceMidiData.Reset();
+	LinkedMidiDataVersion = ContentVersion;
+}
 
-	// Scan tracks to ensure song length and maps are correctly set
-	// This is important because it finalizes the tempo map and other song data
+bool UMutableMidiFile::InitializeFromStandardMidiFile(const FString& FilePath)
+{
+	FMidiFileStreamResult Result;
+	if (!FMidiFileStreamReader::ReadFile(FilePath, Result, EMidiFileStreamFlags::BuildMidiTracks))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UMutableMidiFile::InitializeFromStandardMidiFile: Failed to read %s: %s"), *FilePath, *Result.Error);
+		return false;
+	}
+
+	TheMidiData = FMidiFileData();
+	TheMidiData.TicksPerQuarterNote = Harmonix::Midi::Constants::GTicksPerQuarterNoteInt;
+	TheMidiData.SongMaps = *Result.SongMaps;
+	TheMidiData.Tracks = MoveTemp(Result.MidiTracks);
+
+	SortAllTracks();
 	ScanTracksForSongLengthChange();
 
-	// Build linked MIDI data for editing
-	LinkedMidiData = FMidiNotesData::BuildFromMidiFile(this);
+	// Built while reading, no second walk over the events
+	LinkedMidiData = MoveTemp(Result.NotesData);
+	SharedSourceMidiData.Reset();
+	MarkContentChanged();
+	LinkedMidiDataVersion = ContentVersion;
 
-	// Invalidate renderable copy to force regeneration
 	RenderableCopyOfMidiFileData = nullptr;
-	ProxyData.Reset();
+	PublishSnapshot();
+	return true;
+}
+
+bool UMutableMidiFile::ExportToStandardMidiFile(const FString& FilePath, EMidiFileExportFormat Format) const
+{
+	return FMidiFileStreamWriter::WriteToFile(TheMidiData, FilePath, Format);
+}
+
+bool UMutableMidiFile::ExportToArchive(FArchive& Ar, EMidiFileExportFormat Format) const
+{
+	return FMidiFileStreamWriter::Write(TheMidiData, Ar, Format);
+}
+
+UMidiNotesDataHandle* UMutableMidiFile::GetLinkedMidiDataHandle()
+{
+	EnsureLinkedMidiData();
+
+	return UMidiNotesDataHandle::Create(this, LinkedMidiData);
+}
+
+void UMutableMidiFile::InitializeEmpty(float TempoBPM, int32 TimeSigNumerator, int32 TimeSigDenominator)
+{
+	const int32 MicrosecondsPerQuarterNote = FMath::RoundToInt32(60000000.0f / FMath::Max(TempoBPM, 1.0f));
+
+	TheMidiData = FMidiFileData();
+	TheMidiData.TicksPerQuarterNote = Harmonix::Midi::Constants::GTicksPerQuarterNoteInt;
+	TheMidiData.SongMaps.Init(TheMidiData.TicksPerQuarterNote);
+	TheMidiData.SongMaps.AddTempoChange(0, MicrosecondsPerQuarterNote);
+	TheMidiData.SongMaps.AddTimeSigChange(0, TimeSigNumerator, TimeSigDenominator);
+
+	// Track 0 is the conductor track holding the tempo and time signature events
+	FMidiTrack ConductorTrack(TEXT("conductor"));
+	ConductorTrack.AddEvent(FMidiEvent(0, FMidiMsg::CreateTempo(MicrosecondsPerQuarterNote)));
+	ConductorTrack.AddEvent(FMidiEvent(0, FMidiMsg::CreateTimeSig(TimeSigNumerator, TimeSigDenominator)));
+	TheMidiData.Tracks.Add(MoveTemp(ConductorTrack));
+
+	ScanTracksForSongLengthChange();
+
+	LinkedMidiData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>();
+	SharedSourceMidiData.Reset();
+	MarkContentChanged();
+	LinkedMidiDataVersion = ContentVersion;
+	RenderableCopyOfMidiFileData = nullptr;
+	PublishSnapshot();
+}
+
+int32 UMutableMidiFile::AddNotesTrack(const FString& TrackName, int32 Channel)
+{
+	EnsureLinkedMidiData();
+
+	const int32 MidiTrackIndex = TheMidiData.Tracks.Add(FMidiTrack(TrackName));
+
+	FMidiNotesTrack& NotesTrack = LinkedMidiData->Tracks.AddDefaulted_GetRef();
+	NotesTrack.TrackName = TrackName;
+	NotesTrack.TrackIndex = MidiTrackIndex;
+	NotesTrack.ChannelIndex = FMath::Clamp(Channel, 0, 15);
+	++LinkedMidiData->Revision;
+
+	MarkContentChanged();
+	LinkedMidiDataVersion = ContentVersion;
+
+	// Appending a track leaves every existing note where it was, views keep their selections
+	LastEditNoteIndices.Reset();
+	LastNoteEditVersion = ContentVersion;
+
+	const int32 NotesTrackIndex = LinkedMidiData->Tracks.Num() - 1;
+	PublishSnapshot({ NotesTrackIndex });
+
+	Modify();
+	OnMutableMidiFileChanged.Broadcast();
+
+	return NotesTrackIndex;
 }
 
 void UMutableMidiFile::ModifyNotes(const TArray<FNotesEditCallbackData>& NotesEdits, FOnNotesEdit OnNotesEditComplete)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_ModifyNotes);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMutableMidiFile::ModifyNotes);
+
 	if (NotesEdits.IsEmpty())
 	{
 		return;
 	}
 
 	// Ensure LinkedMidiData is initialized (may be null if asset was loaded from disk)
-	if (!LinkedMidiData.IsValid())
-	{
-		LinkedMidiData = FMidiNotesData::BuildFromMidiFile(this);
-	}
+	EnsureLinkedMidiData();
 
 	if (!LinkedMidiData.IsValid())
 	{
@@ -67,6 +263,8 @@ void UMutableMidiFile::ModifyNotes(const TArray<FNotesEditCallbackData>& NotesEd
 
 	// Group edits by track for efficiency
 	TMap<int32, TArray<const FNotesEditCallbackData*>> EditsByTrack;
+	// Index each note had before the edits, INDEX_NONE for added notes, FinishNoteEdits turns this into the index remap
+	TMap<int32, TArray<int32>> NoteOriginsByTrack;
 	for (const FNotesEditCallbackData& Edit : NotesEdits)
 	{
 		EditsByTrack.FindOrAdd(Edit.TrackIndex).Add(&Edit);
@@ -89,6 +287,13 @@ void UMutableMidiFile::ModifyNotes(const TArray<FNotesEditCallbackData>& NotesEd
 			continue;
 		}
 
+		TArray<int32>& NoteOrigins = NoteOriginsByTrack.Add(TrackIndex);
+		NoteOrigins.SetNumUninitialized(NotesTrack.Notes.Num());
+		for (int32 NoteIndex = 0; NoteIndex < NoteOrigins.Num(); ++NoteIndex)
+		{
+			NoteOrigins[NoteIndex] = NoteIndex;
+		}
+
 		// Separate deletions and modifications/additions
 		TArray<const FNotesEditCallbackData*> Deletions;
 		TArray<const FNotesEditCallbackData*> Modifications;
@@ -111,18 +316,27 @@ void UMutableMidiFile::ModifyNotes(const TArray<FNotesEditCallbackData>& NotesEd
 			return A->NoteIndex > B->NoteIndex;
 		});
 
+		// Extents only grow on additions, removing a note that sits on the boundary forces a rescan of this track
+		bool bNeedsExtentsRecalculation = false;
+
+		// Events of removed notes are stripped and events of added notes appended in a single pass over the track
+		TArray<FLinkedMidiNote> RemovedNotes;
+		TArray<FLinkedMidiNote> AddedNotes;
+		RemovedNotes.Reserve(Edits.Num());
+		AddedNotes.Reserve(Modifications.Num());
+
 		// Process deletions first (in reverse index order)
 		for (const FNotesEditCallbackData* Delete : Deletions)
 		{
 			if (NotesTrack.Notes.IsValidIndex(Delete->NoteIndex))
 			{
 				const FLinkedMidiNote& NoteToDelete = NotesTrack.Notes[Delete->NoteIndex];
-				
-				// Find and remove the MIDI events (note-on and note-off)
-				RemoveNoteEventsFromTrack(MidiTrack, NoteToDelete, NotesTrack.ChannelIndex);
+				bNeedsExtentsRecalculation |= NotesTrack.IsOnExtentsBoundary(NoteToDelete);
+				RemovedNotes.Add(NoteToDelete);
 				
 				// Remove from linked data
 				NotesTrack.Notes.RemoveAt(Delete->NoteIndex);
+				NoteOrigins.RemoveAt(Delete->NoteIndex);
 			}
 			else
 			{
@@ -133,27 +347,219 @@ void UMutableMidiFile::ModifyNotes(const TArray<FNotesEditCallbackData>& NotesEd
 		// Process modifications/additions
 		for (const FNotesEditCallbackData* Mod : Modifications)
 		{
+			// Negative values written by callers would become note-offs or invalid data bytes in the events
+			FLinkedMidiNote NoteData = Mod->NoteData;
+			NoteData.Velocity = FLinkedMidiNote::ClampVelocity(NoteData.Velocity);
+			NoteData.NoteNumber = FLinkedMidiNote::ClampNoteNumber(NoteData.NoteNumber);
+
 			if (NotesTrack.Notes.IsValidIndex(Mod->NoteIndex))
 			{
-				// Modification: remove old events, update data, add new events
+				// Modification: swap the old events for new ones and update the linked data
 				const FLinkedMidiNote& OldNote = NotesTrack.Notes[Mod->NoteIndex];
-				RemoveNoteEventsFromTrack(MidiTrack, OldNote, NotesTrack.ChannelIndex);
-				
-				// Update linked data
-				NotesTrack.Notes[Mod->NoteIndex] = Mod->NoteData;
+				bNeedsExtentsRecalculation |= NotesTrack.IsOnExtentsBoundary(OldNote);
+				RemovedNotes.Add(OldNote);
 				
-				// Add new MIDI events
-				AddNoteEventsToTrack(MidiTrack, Mod->NoteData, NotesTrack.ChannelIndex);
+				NotesTrack.Notes[Mod->NoteIndex] = NoteData;
 			}
 			else
 			{
-				// Addition: add new note to linked data and MIDI track
-				NotesTrack.Notes.Add(Mod->NoteData);
-				AddNoteEventsToTrack(MidiTrack, Mod->NoteData, NotesTrack.ChannelIndex);
+				// Addition: add new note to linked data
+				NotesTrack.Notes.Add(NoteData);
+				NoteOrigins.Add(INDEX_NONE);
 			}
+
+			NotesTrack.ExpandExtents(NoteData);
+			AddedNotes.Add(NoteData);
+		}
+
+		RewriteNoteEvents(MidiTrack, NotesTrack.ChannelIndex, RemovedNotes, AddedNotes);
+
+		if (bNeedsExtentsRecalculation)
+		{
+			NotesTrack.RecalculateExtents();
+		}
+	}
+
+	TArray<int32> EditedTracks;
+	EditsByTrack.GetKeys(EditedTracks);
+	FinishNoteEdits(EditedTracks, NoteOriginsByTrack);
+	
+	// Execute callback if bound
+	if (OnNotesEditComplete.IsBound())
+	{
+		OnNotesEditComplete.Execute(NotesEdits);
+	}
+}
+
+void UMutableMidiFile::TransformNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiNoteTransform& Transform)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiExtensions_ModifyNotes);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMutableMidiFile::TransformNotes);
+
+	if (NoteIds.IsEmpty() || Transform.IsIdentity())
+	{
+		return;
+	}
+
+	EnsureLinkedMidiData();
+
+	TMap<int32, TArray<int32>> NotesByTrack = FMidiNoteId::GroupByTrack(NoteIds);
+	for (auto& [TrackIndex, NoteIndices] : NotesByTrack)
+	{
+		if (!LinkedMidiData->Tracks.IsValidIndex(TrackIndex))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TransformNotes: Invalid track index %d"), TrackIndex);
+			continue;
 		}
+
+		FMidiNotesTrack& NotesTrack = LinkedMidiData->Tracks[TrackIndex];
+		FMidiTrack* MidiTrack = GetTrack(NotesTrack.TrackIndex);
+		if (!MidiTrack)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TransformNotes: Could not find MIDI track for notes track %d"), TrackIndex);
+			continue;
+		}
+
+		NoteIndices.RemoveAll([&NotesTrack](int32 NoteIndex) { return !NotesTrack.Notes.IsValidIndex(NoteIndex); });
+
+		TArray<FLinkedMidiNote> OldNotes;
+		OldNotes.Reserve(NoteIndices.Num());
+		for (const int32 NoteIndex : NoteIndices)
+		{
+			OldNotes.Add(NotesTrack.Notes[NoteIndex]);
+		}
+
+		Transform.Apply(NotesTrack.Notes, NoteIndices);
+
+		TArray<FLinkedMidiNote> NewNotes;
+		NewNotes.Reserve(NoteIndices.Num());
+		for (const int32 NoteIndex : NoteIndices)
+		{
+			NewNotes.Add(NotesTrack.Notes[NoteIndex]);
+		}
+
+		RewriteNoteEvents(MidiTrack, NotesTrack.ChannelIndex, OldNotes, NewNotes);
+		NotesTrack.RecalculateExtents();
 	}
 
+	TArray<int32> EditedTracks;
+	NotesByTrack.GetKeys(EditedTracks);
+	FinishNoteEdits(EditedTracks);
+}
+
+void UMutableMidiFile::QuantizeNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiQuantizeSettings& Settings)
+{
+	if (NoteIds.IsEmpty())
+	{
+		return;
+	}
+
+	EnsureLinkedMidiData();
+
+	const TArray<FNotesEditCallbackData> Edits = FMidiQuantizer::BuildEdits(*LinkedMidiData, *GetSongMaps(), NoteIds, Settings);
+	ModifyNotes(Edits);
+}
+
+void UMutableMidiFile::QuantizeTrack(int32 TrackIndex, const FMidiQuantizeSettings& Settings)
+{
+	EnsureLinkedMidiData();
+
+	QuantizeNotes(FMidiQuantizer::GetTrackNoteIds(*LinkedMidiData, TrackIndex), Settings);
+}
+
+void UMutableMidiFile::SortEditedNotes(TConstArrayView<int32> EditedTracks, const TMap<int32, TArray<int32>>& NoteOriginsByTrack)
+{
+	LastEditNoteIndices.Reset();
+
+	for (const int32 TrackIndex : EditedTracks)
+	{
+		if (!LinkedMidiData->Tracks.IsValidIndex(TrackIndex))
+		{
+			continue;
+		}
+
+		TArray<FLinkedMidiNote>& Notes = LinkedMidiData->Tracks[TrackIndex].Notes;
+		const TArray<int32>* NoteOrigins = NoteOriginsByTrack.Find(TrackIndex);
+		const bool bIsSorted = Algo::IsSortedBy(Notes, &FLinkedMidiNote::NoteOnTick);
+		if (bIsSorted && !NoteOrigins)
+		{
+			// In place edits that kept the order, every note keeps its index
+			continue;
+		}
+
+		// Order[SortedIndex] is the index of the note after the edits, stable so notes sharing a tick keep their order
+		TArray<int32> Order;
+		Order.SetNumUninitialized(Notes.Num());
+		for (int32 NoteIndex = 0; NoteIndex < Order.Num(); ++NoteIndex)
+		{
+			Order[NoteIndex] = NoteIndex;
+		}
+
+		if (!bIsSorted)
+		{
+			Algo::StableSortBy(Order, [&Notes](int32 NoteIndex) { return Notes[NoteIndex].NoteOnTick; });
+
+			TArray<FLinkedMidiNote> SortedNotes;
+			SortedNotes.Reserve(Notes.Num());
+			for (const int32 NoteIndex : Order)
+			{
+				SortedNotes.Add(Notes[NoteIndex]);
+			}
+			Notes = MoveTemp(SortedNotes);
+		}
+
+		int32 NumNotesBefore = Notes.Num();
+		if (NoteOrigins)
+		{
+			NumNotesBefore = 0;
+			for (const int32 OldIndex : *NoteOrigins)
+			{
+				NumNotesBefore = FMath::Max(NumNotesBefore, OldIndex + 1);
+			}
+		}
+
+		TArray<int32>& NewIndices = LastEditNoteIndices.Add(TrackIndex);
+		NewIndices.Init(INDEX_NONE, NumNotesBefore);
+		for (int32 SortedIndex = 0; SortedIndex < Order.Num(); ++SortedIndex)
+		{
+			const int32 OldIndex = NoteOrigins ? (*NoteOrigins)[Order[SortedIndex]] : Order[SortedIndex];
+			if (OldIndex != INDEX_NONE)
+			{
+				NewIndices[OldIndex] = SortedIndex;
+			}
+		}
+	}
+}
+
+int32 UMutableMidiFile::GetNoteIndexAfterLastEdit(int32 TrackIndex, int32 NoteIndex) const
+{
+	if (LastNoteEditVersion != ContentVersion || !LinkedMidiData.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	if (const TArray<int32>* NewIndices = LastEditNoteIndices.Find(TrackIndex))
+	{
+		return NewIndices->IsValidIndex(NoteIndex) ? (*NewIndices)[NoteIndex] : INDEX_NONE;
+	}
+
+	const bool bIsValidNote = LinkedMidiData->Tracks.IsValidIndex(TrackIndex) && LinkedMidiData->Tracks[TrackIndex].Notes.IsValidIndex(NoteIndex);
+	return bIsValidNote ? NoteIndex : INDEX_NONE;
+}
+
+void UMutableMidiFile::FinishNoteEdits(TConstArrayView<int32> EditedTracks, const TMap<int32, TArray<int32>>& NoteOriginsByTrack)
+{
+	// Edits overwrite notes in place and append added ones, readers binary search the notes by onset
+	SortEditedNotes(EditedTracks, NoteOriginsByTrack);
+
+	LinkedMidiData->RefreshExtents();
+	++LinkedMidiData->Revision;
+
+	// The linked notes were edited together with the tracks, they stay current
+	MarkContentChanged();
+	LinkedMidiDataVersion = ContentVersion;
+	LastNoteEditVersion = ContentVersion;
+
 	// Sort all tracks after batch modifications
 	SortAllTracks();
 
@@ -168,81 +574,77 @@ void UMutableMidiFile::ModifyNotes(const TArray<FNotesEditCallbackData>& NotesEd
 		*RenderableCopyOfMidiFileData = TheMidiData;
 	}
 
+	PublishSnapshot(EditedTracks);
+
 	// Mark the object as modified so Unreal knows to save it
 	Modify();
 
 	// Broadcast change notification
 	OnMutableMidiFileChanged.Broadcast();
-	
-	// Execute callback if bound
-	if (OnNotesEditComplete.IsBound())
+}
+
+namespace
+{
+	/** Identifies a note event by tick, note number and on/off, the channel is matched separately */
+	uint64 MakeNoteEventKey(int32 Tick, int32 NoteNumber, bool bIsNoteOn)
 	{
-		OnNotesEditComplete.Execute(NotesEdits);
+		return ((static_cast<uint64>(static_cast<uint32>(Tick)) << 8 | static_cast<uint8>(NoteNumber)) << 1) | (bIsNoteOn ? 1 : 0);
 	}
 }
 
-void UMutableMidiFile::RemoveNoteEventsFromTrack(FMidiTrack* Track, const FLinkedMidiNote& Note, int32 Channel)
+void UMutableMidiFile::RewriteNoteEvents(FMidiTrack* Track, int32 Channel, TConstArrayView<FLinkedMidiNote> RemovedNotes, TConstArrayView<FLinkedMidiNote> AddedNotes)
 {
 	if (!Track)
 	{
 		return;
 	}
 
-	TArray<FMidiEvent>& Events = Track->GetRawEvents();
-	
-	// Find and remove note-off event first (higher index typically)
-	// Search from end to beginning for efficiency
-	int32 NoteOffIndex = INDEX_NONE;
-	int32 NoteOnIndex = INDEX_NONE;
-	
-	for (int32 i = Events.Num() - 1; i >= 0; --i)
+	if (!RemovedNotes.IsEmpty())
 	{
-		const FMidiEvent& Event = Events[i];
-		const FMidiMsg& Msg = Event.GetMsg();
-		
-		if(Msg.IsStd() == false)
+		// Counted so that each copy of a duplicated note removes exactly one pair of events
+		TMap<uint64, int32> PendingRemovals;
+		PendingRemovals.Reserve(RemovedNotes.Num() * 2);
+		for (const FLinkedMidiNote& Note : RemovedNotes)
 		{
-			continue;
+			++PendingRemovals.FindOrAdd(MakeNoteEventKey(Note.NoteOnTick, Note.NoteNumber, true));
+			++PendingRemovals.FindOrAdd(MakeNoteEventKey(Note.NoteOffTick, Note.NoteNumber, false));
 		}
 
-		if (Msg.GetStdChannel() != Channel)
-		{
-			continue;
-		}
-		
-		if (Msg.IsNoteOff() && 
-			Event.GetTick() == Note.NoteOffTick && 
-			Msg.GetStdData1() == Note.NoteNumber)
+		int32 NumPendingRemovals = RemovedNotes.Num() * 2;
+		Track->GetRawEvents().RemoveAll([&PendingRemovals, &NumPendingRemovals, Channel](const FMidiEvent& Event)
 		{
-			NoteOffIndex = i;
-		}
-		else if (Msg.IsNoteOn() && 
-				 Event.GetTick() == Note.NoteOnTick && 
-				 Msg.GetStdData1() == Note.NoteNumber)
-		{
-			NoteOnIndex = i;
-		}
-		
-		// Found both, can stop searching
-		if (NoteOffIndex != INDEX_NONE && NoteOnIndex != INDEX_NONE)
+			const FMidiMsg& Msg = Event.GetMsg();
+			if (NumPendingRemovals == 0 || !Msg.IsStd() || Msg.GetStdChannel() != Channel)
+			{
+				return false;
+			}
+
+			const bool bIsNoteOn = Msg.IsNoteOn();
+			if (!bIsNoteOn && !Msg.IsNoteOff())
+			{
+				return false;
+			}
+
+			int32* Count = PendingRemovals.Find(MakeNoteEventKey(Event.GetTick(), Msg.GetStdData1(), bIsNoteOn));
+			if (!Count || *Count == 0)
+			{
+				return false;
+			}
+
+			--*Count;
+			--NumPendingRemovals;
+			return true;
+		});
+
+		if (NumPendingRemovals > 0)
 		{
-			break;
+			UE_LOG(LogTemp, Warning, TEXT("RewriteNoteEvents: Could not find %d note events to remove"), NumPendingRemovals);
 		}
 	}
-	
-	// Remove in reverse order to preserve indices
-	if (NoteOffIndex != INDEX_NONE && NoteOnIndex != INDEX_NONE)
-	{
-		int32 FirstToRemove = FMath::Max(NoteOffIndex, NoteOnIndex);
-		int32 SecondToRemove = FMath::Min(NoteOffIndex, NoteOnIndex);
-		
-		Events.RemoveAt(FirstToRemove, 1, EAllowShrinking::No);
-		Events.RemoveAt(SecondToRemove, 1, EAllowShrinking::No);
-	}
-	else
+
+	for (const FLinkedMidiNote& Note : AddedNotes)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("RemoveNoteEventsFromTrack: Could not find note events for note %d at ticks %d-%d"), 
-			Note.NoteNumber, Note.NoteOnTick, Note.NoteOffTick);
+		AddNoteEventsToTrack(Track, Note, Channel);
 	}
 }
 
@@ -266,7 +668,7 @@ void UMutableMidiFile::AddNoteEventsToTrack(FMidiTrack* Track, const FLinkedMidi
 	Track->AddEvent(NoteOffEvent);
 }
 
-UMidiFile* UMutableMidiFile::SaveAsAsset(const FString& PackagePath, const FString& AssetName)
+UMutableMidiFile* UMutableMidiFile::CreateAssetCopy(const FString& PackagePath, const FString& AssetName, FString& OutPackageFilename) const
 {
 	if (AssetName.IsEmpty())
 	{
@@ -308,21 +710,32 @@ UMidiFile* UMutableMidiFile::SaveAsAsset(const FString& PackagePath, const FStri
 		return nullptr;
 	}
 
-	// Copy the MIDI data directly using InitializeFromMidiFile
-	NewMidiFile->InitializeFromMidiFile(this);
+	// Every edit leaves this file's tracks sorted and scanned, so a plain copy is a complete snapshot.
+	// The linked notes are rebuilt lazily by the copy if it is ever edited.
+	NewMidiFile->TheMidiData = TheMidiData;
 
 	// Mark the package as dirty
 	Package->MarkPackageDirty();
 
-	// Save the package
-	FString PackageFilename = FPackageName::LongPackageNameToFilename(FullPackagePath, FPackageName::GetAssetPackageExtension());
-	
+	OutPackageFilename = FPackageName::LongPackageNameToFilename(FullPackagePath, FPackageName::GetAssetPackageExtension());
+	return NewMidiFile;
+}
+
+UMidiFile* UMutableMidiFile::SaveAsAsset(const FString& PackagePath, const FString& AssetName)
+{
+	FString PackageFilename;
+	UMutableMidiFile* NewMidiFile = CreateAssetCopy(PackagePath, AssetName, PackageFilename);
+	if (!NewMidiFile)
+	{
+		return nullptr;
+	}
+
 	FSavePackageArgs SaveArgs;
 	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
 	SaveArgs.Error = GError;
 	SaveArgs.bWarnOfLongFilename = true;
 	
-	FSavePackageResultStruct SaveResult = UPackage::Save(Package, NewMidiFile, *PackageFilename, SaveArgs);
+	FSavePackageResultStruct SaveResult = UPackage::Save(NewMidiFile->GetPackage(), NewMidiFile, *PackageFilename, SaveArgs);
 	
 	if (SaveResult.Result == ESavePackageResult::Success)
 	{
@@ -336,3 +749,81 @@ UMidiFile* UMutableMidiFile::SaveAsAsset(const FString& PackagePath, const FStri
 	}
 }
 
+void UMutableMidiFile::SaveAsAssetAsync(const FString& PackagePath, const FString& AssetName, FOnMidiFileSaved OnSaved)
+{
+	check(IsInGameThread());
+
+	FString PackageFilename;
+	UMutableMidiFile* NewMidiFile = CreateAssetCopy(PackagePath, AssetName, PackageFilename);
+	if (!NewMidiFile)
+	{
+		OnSaved.ExecuteIfBound(nullptr, false);
+		return;
+	}
+
+	// Async writes report no result of their own, so the previous file is moved aside and the write only counts if it
+	// leaves a new file behind. The previous file is restored if it doesn't
+	IFileManager& FileManager = IFileManager::Get();
+	const FString BackupFilename = PackageFilename + TEXT(".bak");
+	const bool bHadPreviousFile = FileManager.FileExists(*PackageFilename);
+	if (bHadPreviousFile && !FileManager.Move(*BackupFilename, *PackageFilename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SaveAsAssetAsync: Failed to move the existing '%s' aside"), *PackageFilename);
+		OnSaved.ExecuteIfBound(nullptr, false);
+		return;
+	}
+
+	// Serializing the package has to happen on the game thread, SAVE_Async hands the disk write to background threads
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	SaveArgs.Error = GError;
+	SaveArgs.bWarnOfLongFilename = true;
+	SaveArgs.SaveFlags = SAVE_Async;
+
+	const FSavePackageResultStruct SaveResult = UPackage::Save(NewMidiFile->GetPackage(), NewMidiFile, *PackageFilename, SaveArgs);
+	if (SaveResult.Result != ESavePackageResult::Success)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SaveAsAssetAsync: Failed to save package to '%s'"), *PackageFilename);
+		if (bHadPreviousFile)
+		{
+			FileManager.Move(*PackageFilename, *BackupFilename);
+		}
+		OnSaved.ExecuteIfBound(nullptr, false);
+		return;
+	}
+
+	// The new asset is RF_Standalone, so it outlives the write without being referenced from here
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakMidiFile = TWeakObjectPtr<UMutableMidiFile>(NewMidiFile), PackageFilename, BackupFilename, bHadPreviousFile, OnSaved = MoveTemp(OnSaved)]() mutable
+	{
+		UPackage::WaitForAsyncFileWrites();
+
+		IFileManager& FileManager = IFileManager::Get();
+		const bool bWritten = FileManager.FileSize(*PackageFilename) > 0;
+		if (bHadPreviousFile)
+		{
+			if (bWritten)
+			{
+				FileManager.Delete(*BackupFilename);
+			}
+			else
+			{
+				FileManager.Move(*PackageFilename, *BackupFilename);
+			}
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakMidiFile, PackageFilename, bWritten, OnSaved = MoveTemp(OnSaved)]()
+		{
+			const bool bSuccess = WeakMidiFile.IsValid() && bWritten;
+			if (bSuccess)
+			{
+				UE_LOG(LogTemp, Log, TEXT("SaveAsAssetAsync: Successfully saved MIDI file to '%s'"), *PackageFilename);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SaveAsAssetAsync: Failed to write '%s'"), *PackageFilename);
+			}
+			OnSaved.ExecuteIfBound(bSuccess ? WeakMidiFile.Get() : nullptr, bSuccess);
+		});
+	});
+}
+
@@ -0,0 +1,173 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "Playback/MidiNoteEventScheduler.h"
+#include "HarmonixMidi/SongMaps.h"
+
+FMidiNoteEventScheduler::FMidiNoteEventScheduler(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InNotesData, TSharedPtr<const FSongMaps, ESPMode::ThreadSafe> InSongMaps, uint32 RingCapacity)
+	: NotesData(MoveTemp(InNotesData))
+	, SongMaps(MoveTemp(InSongMaps))
+	, Ring(FMath::Max<uint32>(RingCapacity, 2))
+	, NoteOnCursor(NotesData)
+{
+	// The heap never holds more notes than sound at once, reserving that keeps the producer free of allocations
+	PendingNoteOffs.Reserve(NotesData.IsValid() ? GetMaxPolyphony(*NotesData) : 0);
+}
+
+int32 FMidiNoteEventScheduler::GetMaxPolyphony(const FMidiNotesData& InNotesData)
+{
+	// Sweep over every note-on and note-off, note-offs first on the same tick like the producer merges them
+	TArray<TPair<int32, int32>> Changes;
+	for (const FMidiNotesTrack& Track : InNotesData.Tracks)
+	{
+		for (const FLinkedMidiNote& Note : Track.Notes)
+		{
+			Changes.Add({ Note.NoteOnTick, 1 });
+			Changes.Add({ Note.NoteOffTick, -1 });
+		}
+	}
+	Changes.Sort();
+
+	int32 NumSounding = 0;
+	int32 MaxPolyphony = 0;
+	for (const TPair<int32, int32>& Change : Changes)
+	{
+		NumSounding += Change.Value;
+		MaxPolyphony = FMath::Max(MaxPolyphony, NumSounding);
+	}
+	return MaxPolyphony;
+}
+
+void FMidiNoteEventScheduler::Start(double StartSongMs)
+{
+	RequestedStartSongMs.store(StartSongMs, std::memory_order_relaxed);
+	bStopRequested.store(false, std::memory_order_relaxed);
+	bStartRequested.store(true, std::memory_order_release);
+}
+
+void FMidiNoteEventScheduler::Stop()
+{
+	bStartRequested.store(false, std::memory_order_relaxed);
+	bStopRequested.store(true, std::memory_order_release);
+}
+
+void FMidiNoteEventScheduler::ProcessAudioBlock(double AudioClockSeconds, double BlockDurationSeconds)
+{
+	LastAudioClockSeconds.store(AudioClockSeconds, std::memory_order_relaxed);
+
+	if (!NotesData.IsValid() || !SongMaps.IsValid())
+	{
+		return;
+	}
+
+	if (bStopRequested.exchange(false, std::memory_order_acquire))
+	{
+		// Release anything still sounding so listeners don't end up with hanging notes
+		PendingNoteOffs.Sort();
+		for (const FPendingNoteOff& NoteOff : PendingNoteOffs)
+		{
+			FMidiNoteEvent Event = MakeEvent(NoteOff.TrackIndex, NoteOff.NoteIndex, false);
+			Event.AudioTimeSeconds = AudioClockSeconds;
+			Push(Event);
+		}
+		PendingNoteOffs.Reset();
+		bIsRunning.store(false, std::memory_order_relaxed);
+	}
+
+	if (bStartRequested.exchange(false, std::memory_order_acquire))
+	{
+		// Anchor the song position to the start of this block, everything else is derived from the audio clock
+		AnchorAudioClockSeconds = AudioClockSeconds;
+		AnchorSongMs = RequestedStartSongMs.load(std::memory_order_relaxed);
+		ScheduledUpToTick = FMath::FloorToInt32(SongMaps->MsToTick(AnchorSongMs));
+		NoteOnCursor.SeekToTick(ScheduledUpToTick);
+		PendingNoteOffs.Reset();
+		bIsRunning.store(true, std::memory_order_relaxed);
+	}
+
+	const bool bRunning = bIsRunning.load(std::memory_order_relaxed);
+	if (PlaybackClock.IsValid())
+	{
+		// A stopped clock keeps reporting where playback stopped
+		if (bRunning)
+		{
+			PublishedSongMs = AnchorSongMs + (AudioClockSeconds - AnchorAudioClockSeconds) * 1000.0;
+		}
+		PlaybackClock->Publish(PublishedSongMs, bRunning);
+	}
+
+	if (!bRunning)
+	{
+		return;
+	}
+
+	const double BlockEndSongMs = AnchorSongMs + (AudioClockSeconds + BlockDurationSeconds - AnchorAudioClockSeconds) * 1000.0;
+	const double WindowEndSongMs = BlockEndSongMs + LookaheadMs.load(std::memory_order_relaxed);
+	const int32 WindowEndTick = FMath::CeilToInt32(SongMaps->MsToTick(WindowEndSongMs));
+	if (WindowEndTick <= ScheduledUpToTick)
+	{
+		return;
+	}
+
+	// Merge note-ons from the cursor with the pending note-offs, note-offs first on the same tick
+	while (true)
+	{
+		const bool bHasNoteOn = NoteOnCursor.IsValid() && NoteOnCursor.GetCurrentNote().NoteOnTick < WindowEndTick;
+		const bool bHasNoteOff = !PendingNoteOffs.IsEmpty() && PendingNoteOffs.HeapTop().Tick < WindowEndTick;
+		if (!bHasNoteOn && !bHasNoteOff)
+		{
+			break;
+		}
+
+		if (bHasNoteOff && (!bHasNoteOn || PendingNoteOffs.HeapTop().Tick <= NoteOnCursor.GetCurrentNote().NoteOnTick))
+		{
+			FPendingNoteOff NoteOff;
+			PendingNoteOffs.HeapPop(NoteOff, EAllowShrinking::No);
+			Push(MakeEvent(NoteOff.TrackIndex, NoteOff.NoteIndex, false));
+			continue;
+		}
+
+		const int32 TrackIndex = NoteOnCursor.GetCurrentTrackIndex();
+		const int32 NoteIndex = NoteOnCursor.GetCurrentNoteIndex();
+		Push(MakeEvent(TrackIndex, NoteIndex, true));
+		PendingNoteOffs.HeapPush({ NoteOnCursor.GetCurrentNote().NoteOffTick, TrackIndex, NoteIndex });
+		NoteOnCursor.Advance();
+	}
+
+	ScheduledUpToTick = WindowEndTick;
+}
+
+int32 FMidiNoteEventScheduler::Drain(TFunctionRef<void(const FMidiNoteEvent&)> Callback)
+{
+	int32 NumDrained = 0;
+	FMidiNoteEvent Event;
+	while (Ring.Dequeue(Event))
+	{
+		Callback(Event);
+		++NumDrained;
+	}
+	return NumDrained;
+}
+
+void FMidiNoteEventScheduler::Push(const FMidiNoteEvent& Event)
+{
+	if (!Ring.Enqueue(Event))
+	{
+		NumDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+FMidiNoteEvent FMidiNoteEventScheduler::MakeEvent(int32 TrackIndex, int32 NoteIndex, bool bIsNoteOn) const
+{
+	const FLinkedMidiNote& Note = NotesData->Tracks[TrackIndex].Notes[NoteIndex];
+
+	FMidiNoteEvent Event;
+	Event.TrackIndex = TrackIndex;
+	Event.NoteIndex = NoteIndex;
+	Event.NoteNumber = Note.NoteNumber;
+	Event.Velocity = Note.Velocity;
+	Event.Tick = bIsNoteOn ? Note.NoteOnTick : Note.NoteOffTick;
+	Event.bIsNoteOn = bIsNoteOn;
+	Event.SongTimeMs = SongMaps->TickToMs(Event.Tick);
+	Event.AudioTimeSeconds = AnchorAudioClockSeconds + (Event.SongTimeMs - AnchorSongMs) / 1000.0;
+	return Event;
+}
@@ -0,0 +1,200 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "Playback/MidiNoteEventSchedulerComponent.h"
+#include "AudioDevice.h"
+#include "Engine/World.h"
+#include "HarmonixMidi/MidiFile.h"
+#include "ISubmixBufferListener.h"
+#include "MidiFile/MutableMidiFile.h"
+#include "Sound/SoundSubmix.h"
+
+/** Drives a scheduler from the main submix, one call per rendered buffer on the audio render thread */
+class FMidiNoteEventSubmixListener : public ISubmixBufferListener
+{
+public:
+	explicit FMidiNoteEventSubmixListener(TSharedPtr<FMidiNoteEventScheduler, ESPMode::ThreadSafe> InScheduler)
+		: Scheduler(MoveTemp(InScheduler))
+	{
+	}
+
+	virtual void OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels, const int32 SampleRate, double AudioClock) override
+	{
+		if (NumChannels <= 0 || SampleRate <= 0)
+		{
+			return;
+		}
+
+		const double BlockDurationSeconds = static_cast<double>(NumSamples / NumChannels) / SampleRate;
+		Scheduler->ProcessAudioBlock(AudioClock, BlockDurationSeconds);
+	}
+
+	virtual const FString& GetListenerName() const override
+	{
+		static const FString ListenerName = TEXT("MidiNoteEventScheduler");
+		return ListenerName;
+	}
+
+private:
+	TSharedPtr<FMidiNoteEventScheduler, ESPMode::ThreadSafe> Scheduler;
+};
+
+UMidiNoteEventSchedulerComponent::UMidiNoteEventSchedulerComponent()
+	: PlaybackClock(MakeShared<FMidiPlaybackClock, ESPMode::ThreadSafe>())
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+}
+
+void UMidiNoteEventSchedulerComponent::StartScheduling(float StartSongMs)
+{
+	if (!MidiFile)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UMidiNoteEventSchedulerComponent::StartScheduling: No midi file set"));
+		return;
+	}
+
+	UnregisterListener();
+
+	// The scheduler reads the notes on the audio thread, so it gets its own snapshot instead of data that can still be edited.
+	// Edits keep the linked notes sorted by onset, which the scheduler's note cursor relies on
+	TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> NotesData;
+	UMutableMidiFile* MutableMidiFile = Cast<UMutableMidiFile>(MidiFile);
+	if (const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> LinkedMidiData = MutableMidiFile ? MutableMidiFile->GetOrBuildLinkedMidiData() : nullptr)
+	{
+		NotesData = MakeShared<FMidiNotesData, ESPMode::ThreadSafe>(*LinkedMidiData);
+	}
+	else
+	{
+		NotesData = FMidiNotesData::BuildFromMidiFile(MidiFile);
+	}
+	TSharedPtr<const FSongMaps, ESPMode::ThreadSafe> SongMaps = MakeShared<FSongMaps, ESPMode::ThreadSafe>(*MidiFile->GetSongMaps());
+
+	Scheduler = MakeShared<FMidiNoteEventScheduler, ESPMode::ThreadSafe>(NotesData, SongMaps, EventRingCapacity);
+	Scheduler->SetLookaheadMs(LookaheadMs);
+	Scheduler->SetPlaybackClock(PlaybackClock);
+	Scheduler->Start(StartSongMs);
+
+	RegisterListener();
+}
+
+void UMidiNoteEventSchedulerComponent::StopScheduling()
+{
+	if (Scheduler.IsValid())
+	{
+		Scheduler->Stop();
+	}
+}
+
+bool UMidiNoteEventSchedulerComponent::IsScheduling() const
+{
+	return Scheduler.IsValid() && Scheduler->IsRunning();
+}
+
+void UMidiNoteEventSchedulerComponent::SetLookaheadMs(float InLookaheadMs)
+{
+	LookaheadMs = FMath::Max(0.f, InLookaheadMs);
+	if (Scheduler.IsValid())
+	{
+		Scheduler->SetLookaheadMs(LookaheadMs);
+	}
+}
+
+void UMidiNoteEventSchedulerComponent::SubscribeToTrack(int32 TrackIndex, FOnMidiNoteEvent Delegate)
+{
+	if (Delegate.IsBound())
+	{
+		TrackSubscriptions.Add({ TrackIndex, MoveTemp(Delegate) });
+	}
+}
+
+void UMidiNoteEventSchedulerComponent::UnsubscribeFromTrack(int32 TrackIndex, FOnMidiNoteEvent Delegate)
+{
+	TrackSubscriptions.RemoveAll([TrackIndex, &Delegate](const FTrackSubscription& Subscription)
+	{
+		return Subscription.TrackIndex == TrackIndex && Subscription.Delegate == Delegate;
+	});
+}
+
+double UMidiNoteEventSchedulerComponent::GetAudioClockSeconds() const
+{
+	return Scheduler.IsValid() ? Scheduler->GetLastAudioClockSeconds() : 0.0;
+}
+
+double UMidiNoteEventSchedulerComponent::GetPlaybackPositionMs() const
+{
+	return PlaybackClock->GetSongPositionMs();
+}
+
+void UMidiNoteEventSchedulerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (Scheduler.IsValid())
+	{
+		Scheduler->Drain([this](const FMidiNoteEvent& Event)
+		{
+			DispatchEvent(Event);
+		});
+	}
+}
+
+void UMidiNoteEventSchedulerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterListener();
+	Scheduler.Reset();
+
+	// Nothing publishes anymore, leave readers with a stopped clock rather than a playing one that never advances
+	PlaybackClock->Publish(PlaybackClock->Read().SongPositionMs, false);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UMidiNoteEventSchedulerComponent::RegisterListener()
+{
+	UWorld* World = GetWorld();
+	FAudioDeviceHandle AudioDevice = World ? World->GetAudioDevice() : FAudioDeviceHandle();
+	if (!AudioDevice.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UMidiNoteEventSchedulerComponent: No audio device, notes will not be scheduled"));
+		return;
+	}
+
+	SubmixListener = MakeShared<FMidiNoteEventSubmixListener, ESPMode::ThreadSafe>(Scheduler);
+	AudioDevice->RegisterSubmixBufferListener(SubmixListener.ToSharedRef(), AudioDevice->GetMainSubmixObject());
+}
+
+void UMidiNoteEventSchedulerComponent::UnregisterListener()
+{
+	if (!SubmixListener.IsValid())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	FAudioDeviceHandle AudioDevice = World ? World->GetAudioDevice() : FAudioDeviceHandle();
+	if (AudioDevice.IsValid())
+	{
+		AudioDevice->UnregisterSubmixBufferListener(SubmixListener.ToSharedRef(), AudioDevice->GetMainSubmixObject());
+	}
+	SubmixListener.Reset();
+}
+
+void UMidiNoteEventSchedulerComponent::DispatchEvent(const FMidiNoteEvent& Event)
+{
+	if (Event.bIsNoteOn)
+	{
+		OnNoteOn.Broadcast(Event);
+	}
+	else
+	{
+		OnNoteOff.Broadcast(Event);
+	}
+
+	for (const FTrackSubscription& Subscription : TrackSubscriptions)
+	{
+		if (Subscription.TrackIndex == Event.TrackIndex)
+		{
+			Subscription.Delegate.ExecuteIfBound(Event);
+		}
+	}
+}
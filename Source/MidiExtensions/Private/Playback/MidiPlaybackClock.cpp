@@ -0,0 +1,54 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "Playback/MidiPlaybackClock.h"
+
+void FMidiPlaybackClock::Publish(double InSongPositionMs, bool bInIsPlaying, float InPlaybackRate)
+{
+	const uint32 Begin = Sequence.load(std::memory_order_relaxed);
+	Sequence.store(Begin + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	SongPositionMs.store(InSongPositionMs, std::memory_order_relaxed);
+	PublishedAtSeconds.store(FPlatformTime::Seconds(), std::memory_order_relaxed);
+	PlaybackRate.store(InPlaybackRate, std::memory_order_relaxed);
+	bIsPlaying.store(bInIsPlaying, std::memory_order_relaxed);
+
+	Sequence.store(Begin + 2, std::memory_order_release);
+}
+
+FMidiPlaybackClockSnapshot FMidiPlaybackClock::Read() const
+{
+	FMidiPlaybackClockSnapshot Snapshot;
+	while (true)
+	{
+		const uint32 Begin = Sequence.load(std::memory_order_acquire);
+		if (Begin & 1)
+		{
+			FPlatformProcess::YieldThread();
+			continue;
+		}
+
+		Snapshot.SongPositionMs = SongPositionMs.load(std::memory_order_relaxed);
+		Snapshot.PublishedAtSeconds = PublishedAtSeconds.load(std::memory_order_relaxed);
+		Snapshot.PlaybackRate = PlaybackRate.load(std::memory_order_relaxed);
+		Snapshot.bIsPlaying = bIsPlaying.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (Sequence.load(std::memory_order_relaxed) == Begin)
+		{
+			return Snapshot;
+		}
+	}
+}
+
+double FMidiPlaybackClock::GetSongPositionMs(double NowSeconds) const
+{
+	const FMidiPlaybackClockSnapshot Snapshot = Read();
+	if (!Snapshot.bIsPlaying)
+	{
+		return Snapshot.SongPositionMs;
+	}
+
+	const double ElapsedSeconds = FMath::Clamp(NowSeconds - Snapshot.PublishedAtSeconds, 0.0, MaxExtrapolationSeconds);
+	return Snapshot.SongPositionMs + ElapsedSeconds * 1000.0 * Snapshot.PlaybackRate;
+}
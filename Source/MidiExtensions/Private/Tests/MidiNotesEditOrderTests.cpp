@@ -0,0 +1,128 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFile/MutableMidiFile.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiFile/MidiNotesDataHandle.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MidiNotesEditOrderTests
+{
+	/** Edit of NoteIndex in TrackIndex to a note starting at NoteOnTick, an add for INDEX_NONE */
+	FNotesEditCallbackData MakeNoteEdit(int32 TrackIndex, int32 NoteIndex, int32 NoteOnTick, bool bDelete = false)
+	{
+		FNotesEditCallbackData Edit;
+		Edit.TrackIndex = TrackIndex;
+		Edit.NoteIndex = NoteIndex;
+		Edit.NoteData.NoteOnTick = NoteOnTick;
+		Edit.NoteData.NoteOffTick = NoteOnTick + 120;
+		Edit.NoteData.Velocity = 100;
+		Edit.NoteData.NoteNumber = 60;
+		Edit.bDelete = bDelete;
+		return Edit;
+	}
+
+	/** Empty file with a single notes track holding one note per tick in NoteOnTicks, added in that order */
+	UMutableMidiFile* MakeFileWithNotes(TConstArrayView<int32> NoteOnTicks, int32& OutTrackIndex)
+	{
+		UMutableMidiFile* MidiFile = NewObject<UMutableMidiFile>();
+		MidiFile->InitializeEmpty();
+		OutTrackIndex = MidiFile->AddNotesTrack(TEXT("Notes"), 0);
+
+		TArray<FNotesEditCallbackData> Edits;
+		for (const int32 NoteOnTick : NoteOnTicks)
+		{
+			Edits.Add(MakeNoteEdit(OutTrackIndex, INDEX_NONE, NoteOnTick));
+		}
+		MidiFile->ModifyNotes(Edits);
+		return MidiFile;
+	}
+
+	/** NoteOnTicks of every note the iterator visits after seeking to Tick */
+	TArray<int32> GetNoteOnTicksFrom(UMutableMidiFile* MidiFile, int32 Tick)
+	{
+		FMidiFileIterator Iterator(MidiFile->GetOrBuildLinkedMidiData());
+		Iterator.SeekToTick(Tick);
+
+		TArray<int32> NoteOnTicks;
+		for (; Iterator.IsValid(); Iterator.Advance())
+		{
+			NoteOnTicks.Add(Iterator.GetCurrentNote().NoteOnTick);
+		}
+		return NoteOnTicks;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMidiNotesSeekAfterOutOfOrderAddTest, "MidiExtensions.NotesEdits.SeekAfterOutOfOrderAdd",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMidiNotesSeekAfterOutOfOrderAddTest::RunTest(const FString& Parameters)
+{
+	using namespace MidiNotesEditOrderTests;
+
+	int32 TrackIndex = INDEX_NONE;
+	UMutableMidiFile* MidiFile = MakeFileWithNotes({ 960, 1920, 2880 }, TrackIndex);
+
+	// Added after the existing notes in the array, but starts before all of them
+	MidiFile->ModifyNotes({ MakeNoteEdit(TrackIndex, INDEX_NONE, 480) });
+
+	TestEqual(TEXT("Seek to 0 visits every note in onset order"), GetNoteOnTicksFrom(MidiFile, 0), TArray<int32>({ 480, 960, 1920, 2880 }));
+	TestEqual(TEXT("Seek into the middle starts at the next onset"), GetNoteOnTicksFrom(MidiFile, 500), TArray<int32>({ 960, 1920, 2880 }));
+	TestEqual(TEXT("Existing notes moved up one index"), MidiFile->GetNoteIndexAfterLastEdit(TrackIndex, 0), 1);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMidiNotesSeekAfterMoveTest, "MidiExtensions.NotesEdits.SeekAfterMove",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMidiNotesSeekAfterMoveTest::RunTest(const FString& Parameters)
+{
+	using namespace MidiNotesEditOrderTests;
+
+	int32 TrackIndex = INDEX_NONE;
+	UMutableMidiFile* MidiFile = MakeFileWithNotes({ 960, 1920, 2880 }, TrackIndex);
+
+	// Moves the last note in front of the first one
+	MidiFile->ModifyNotes({ MakeNoteEdit(TrackIndex, 2, 240) });
+
+	TestEqual(TEXT("Seek to 0 visits every note in onset order"), GetNoteOnTicksFrom(MidiFile, 0), TArray<int32>({ 240, 960, 1920 }));
+	TestEqual(TEXT("Seek past the moved note skips it"), GetNoteOnTicksFrom(MidiFile, 961), TArray<int32>({ 1920 }));
+	TestEqual(TEXT("The moved note is now the first one"), MidiFile->GetNoteIndexAfterLastEdit(TrackIndex, 2), 0);
+
+	// Deleting a note shifts the ones after it and maps the deleted one to INDEX_NONE
+	MidiFile->ModifyNotes({ MakeNoteEdit(TrackIndex, 1, 0, true) });
+	TestEqual(TEXT("Deleted note has no index"), MidiFile->GetNoteIndexAfterLastEdit(TrackIndex, 1), INDEX_NONE);
+	TestEqual(TEXT("Later note moved down"), MidiFile->GetNoteIndexAfterLastEdit(TrackIndex, 2), 1);
+	TestEqual(TEXT("Seek after the delete"), GetNoteOnTicksFrom(MidiFile, 0), TArray<int32>({ 240, 1920 }));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMidiNotesHandleRangeAfterAddTest, "MidiExtensions.NotesEdits.HandleRangeAfterAdd",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMidiNotesHandleRangeAfterAddTest::RunTest(const FString& Parameters)
+{
+	using namespace MidiNotesEditOrderTests;
+
+	int32 TrackIndex = INDEX_NONE;
+	UMutableMidiFile* MidiFile = MakeFileWithNotes({ 960, 1920, 2880 }, TrackIndex);
+
+	// The handle shares the linked notes, it has to see edits made after it was created
+	UMidiNotesDataHandle* Handle = MidiFile->GetLinkedMidiDataHandle();
+	MidiFile->ModifyNotes({ MakeNoteEdit(TrackIndex, INDEX_NONE, 480), MakeNoteEdit(TrackIndex, INDEX_NONE, 1440) });
+
+	TArray<int32> NoteOnTicks;
+	for (const FLinkedMidiNote& Note : Handle->GetNotesInRange(TrackIndex, 0, 2000))
+	{
+		NoteOnTicks.Add(Note.NoteOnTick);
+	}
+	TestEqual(TEXT("Range query finds the added notes in onset order"), NoteOnTicks, TArray<int32>({ 480, 960, 1440, 1920 }));
+	TestEqual(TEXT("Range query agrees with the query index"), NoteOnTicks.Num(), Handle->CountNotesStartingInRange(TrackIndex, 0, 2000));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
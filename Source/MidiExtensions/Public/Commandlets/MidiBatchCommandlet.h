@@ -0,0 +1,94 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MidiBatchCommandlet.generated.h"
+
+class UMidiFile;
+struct FMidiFileData;
+
+/** Outcome of one MIDI file in a batch run, one row of the report */
+struct FMidiBatchFileResult
+{
+	FName PackageName;
+	bool bLoaded = false;
+
+	/** Timestamp of the package file, stored in the notes cache so stale caches are detected */
+	uint64 SourceStamp = 0;
+
+	int32 NumTracks = 0;
+	int32 NumNoteTracks = 0;
+	int32 NumNotes = 0;
+	int32 NumControllerPoints = 0;
+	int32 NumTempoChanges = 0;
+	int32 LowestNoteNumber = INDEX_NONE;
+	int32 HighestNoteNumber = INDEX_NONE;
+	int32 LengthTicks = 0;
+	double LengthMs = 0.0;
+
+	/** Problems found by validation, empty if the file is clean or was not validated */
+	TArray<FString> Issues;
+
+	bool bExported = false;
+	bool bCached = false;
+
+	/** Why processing stopped or an output failed, empty on success */
+	FString Error;
+
+	/** From this file's load request to its completion, includes waiting behind other files of the batch */
+	double LoadMs = 0.0;
+	double BuildMs = 0.0;
+	double ValidateMs = 0.0;
+	double ExportMs = 0.0;
+	double CacheMs = 0.0;
+
+	/** Time spent processing the file on its worker, loading excluded */
+	double ProcessMs = 0.0;
+};
+
+/**
+ * Processes every MIDI file asset under a path in parallel and writes a report with per-file stats and timings.
+ *
+ * UnrealEditor-Cmd <Project> -run=MidiBatch [-Path=/Game] [-Ops=Validate,Stats,Export,Cache] [-OutputDir=<dir>]
+ *     [-CacheDir=<dir>] [-Report=<file.json|file.csv>] [-BatchSize=32] [-FailOnIssues] -unattended -nullrhi
+ *
+ * Assets are found through the asset registry and loaded asynchronously BatchSize at a time. Each batch is then
+ * processed by ParallelFor workers and released, with a garbage collection before the next, so memory is bounded
+ * by the batch size rather than the size of the library. Nothing touches Slate or the RHI, it runs headless.
+ *  - Validate: reports notes without length, overlapping notes of the same pitch and files without notes
+ *  - Stats: track, note, controller and tempo counts, pitch range and length
+ *  - Export: writes each file as a Standard MIDI File under OutputDir, mirroring the package paths
+ *  - Cache: writes FMidiNotesCacheFile caches under CacheDir, Saved/MidiNotesCache by default
+ * Linked notes are always built, every operation reads them. The report is CSV if its name ends in .csv, JSON
+ * otherwise, and defaults to <OutputDir>/MidiBatchReport.json with OutputDir defaulting to Saved/MidiBatch.
+ */
+UCLASS()
+class MIDIEXTENSIONS_API UMidiBatchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMidiBatchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FOptions
+	{
+		bool bValidate = false;
+		bool bStats = false;
+		bool bExport = false;
+		bool bCache = false;
+		FString OutputDir;
+		FString CacheDir;
+	};
+
+	/** Runs the operations on a loaded file, called on worker threads with the file's data already in memory */
+	static void ProcessFile(UMidiFile* MidiFile, const FMidiFileData* ExportData, const FOptions& Options, FMidiBatchFileResult& Result);
+
+	static bool WriteJsonReport(const FString& ReportPath, TConstArrayView<FMidiBatchFileResult> Results, double TotalSeconds);
+
+	static bool WriteCsvReport(const FString& ReportPath, TConstArrayView<FMidiBatchFileResult> Results);
+};
@@ -0,0 +1,29 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MidiNotesCacheCommandlet.generated.h"
+
+/**
+ * Writes a memory-mappable notes cache (see FMidiNotesCacheFile) for every MIDI file asset in the project.
+ *
+ * UnrealEditor-Cmd <Project> -run=MidiNotesCache [-Path=/Game] [-OutputDir=<dir>] [-Force]
+ *
+ * Caches are written to Saved/MidiNotesCache unless -OutputDir is given, mirroring the package paths.
+ * Each cache is stamped with its package file's timestamp, up to date caches are skipped unless -Force is given.
+ */
+UCLASS()
+class MIDIEXTENSIONS_API UMidiNotesCacheCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMidiNotesCacheCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/** Stamp stored in the cache of a package, 0 if the package file can't be found */
+	static uint64 GetPackageSourceStamp(FName PackageName);
+};
@@ -17,9 +17,36 @@ class MIDIEXTENSIONS_API UMidiExtensionsHelperLib : public UBlueprintFunctionLib
 	
 public:
 
+	/** Creates an iterator over all notes of the MIDI file in time order */
 	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Utils")
-	static FMidiFileIterator MakeMidiFileIterator(FMidiNotesData MidiDataPtr);
+	static FMidiFileIterator MakeMidiFileIterator(class UMidiFile* MidiFile);
 
 	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Utils")
+	static bool IsMidiFileIteratorValid(const FMidiFileIterator& Iterator);
+
+	/** Reads the note under the iterator, returns false if the iterator is past the last note */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Utils")
+	static bool GetMidiFileIteratorNote(const FMidiFileIterator& Iterator, int32& TrackIndex, int32& NoteOnTick, int32& NoteOffTick, int32& NoteNumber, int32& Velocity);
+
+	/** Moves the iterator to the next note, returns false once all notes have been visited */
+	UFUNCTION(BlueprintCallable, Category = "MIDI Extensions|Utils")
+	static bool AdvanceMidiFileIterator(UPARAM(ref) FMidiFileIterator& Iterator);
+
+	/** Positions the iterator on the first note starting at or after Tick */
+	UFUNCTION(BlueprintCallable, Category = "MIDI Extensions|Utils")
+	static void SeekMidiFileIterator(UPARAM(ref) FMidiFileIterator& Iterator, int32 Tick);
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Utils", meta = (DeprecatedFunction, DeprecationMessage = "Copies every note at each pin, use MakeMidiNotesDataHandle instead"))
 	static FMidiNotesData MakeMidiNotesData(class UMidiFile* MidiFile);
+
+	/** Links the notes of a MIDI file once and returns a handle that can be passed around without copying them */
+	UFUNCTION(BlueprintCallable, Category = "MIDI Extensions|Utils")
+	static class UMidiNotesDataHandle* MakeMidiNotesDataHandle(class UMidiFile* MidiFile);
+
+	/** Loads a .mid file from disk at runtime into a new editable MIDI file, nullptr if it could not be read */
+	UFUNCTION(BlueprintCallable, Category = "MIDI Extensions|Utils")
+	static class UMutableMidiFile* LoadMidiFileFromDisk(const FString& FilePath);
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Utils")
+	static void BreakLinkedMidiNote(const FLinkedMidiNote& Note, int32& NoteOnTick, int32& NoteOffTick, int32& NoteNumber, int32& Velocity);
 };
@@ -0,0 +1,21 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Shared stat group for the MIDI extension modules, view with 'stat MidiExtensions'
+DECLARE_STATS_GROUP(TEXT("MIDI Extensions"), STATGROUP_MidiExtensions, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("BuildFromMidiFile"), STAT_MidiExtensions_BuildFromMidiFile, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ModifyNotes"), STAT_MidiExtensions_ModifyNotes, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("BuildQueryIndex"), STAT_MidiExtensions_BuildQueryIndex, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TransformNotes"), STAT_MidiExtensions_TransformNotes, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Quantize"), STAT_MidiExtensions_Quantize, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ReadStandardMidiFile"), STAT_MidiExtensions_ReadStandardMidiFile, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("WriteStandardMidiFile"), STAT_MidiExtensions_WriteStandardMidiFile, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+
+// Memory held by FMidiPackedNotes, against what the same notes take as plain arrays
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Packed Notes"), STAT_MidiExtensions_PackedNotesMemory, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Packed Notes (Unpacked Size)"), STAT_MidiExtensions_PackedNotesUnpackedMemory, STATGROUP_MidiExtensions, MIDIEXTENSIONS_API);
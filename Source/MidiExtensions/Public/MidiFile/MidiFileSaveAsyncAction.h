@@ -0,0 +1,41 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "MidiFileSaveAsyncAction.generated.h"
+
+class UMidiFile;
+class UMutableMidiFile;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMidiFileSaveAsyncResult, UMidiFile*, SavedFile);
+
+/** Blueprint node for UMutableMidiFile::SaveAsAssetAsync */
+UCLASS()
+class MIDIEXTENSIONS_API UMidiFileSaveAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Save a MIDI file as a new asset without blocking, edits made after the node runs are not part of the save */
+	UFUNCTION(BlueprintCallable, Category = "MIDI", meta = (BlueprintInternalUseOnly = "true", DisplayName = "Save MIDI File As Asset Async"))
+	static UMidiFileSaveAsyncAction* SaveMidiFileAsAssetAsync(UMutableMidiFile* MidiFile, const FString& PackagePath, const FString& AssetName);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnMidiFileSaveAsyncResult OnSaved;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnMidiFileSaveAsyncResult OnFailed;
+
+	virtual void Activate() override;
+
+private:
+	void HandleSaved(UMidiFile* SavedFile, bool bSuccess);
+
+	UPROPERTY()
+	TObjectPtr<UMutableMidiFile> MidiFile;
+
+	FString PackagePath;
+	FString AssetName;
+};
@@ -0,0 +1,56 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MidiFile/MidiNotesData.h"
+#include "HarmonixMidi/MidiTrack.h"
+
+class FSongMaps;
+
+enum class EMidiFileStreamFlags : uint8
+{
+	None = 0,
+
+	/** Also produce Harmonix tracks with the channel, tempo and time signature events, e.g. to populate a UMutableMidiFile */
+	BuildMidiTracks = 1 << 0,
+};
+ENUM_CLASS_FLAGS(EMidiFileStreamFlags);
+
+/** What FMidiFileStreamReader produced from a Standard MIDI File */
+struct MIDIEXTENSIONS_API FMidiFileStreamResult
+{
+	/** Linked notes and controller lanes, laid out exactly as FMidiNotesData::BuildFromMidiFile would for the same file */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData;
+
+	/** Tempo and time signature maps */
+	TSharedPtr<FSongMaps, ESPMode::ThreadSafe> SongMaps;
+
+	/** One per track chunk, only filled with EMidiFileStreamFlags::BuildMidiTracks */
+	TArray<FMidiTrack> MidiTracks;
+
+	/** SMF format, 0, 1 or 2 */
+	int32 Format = 0;
+
+	int32 NumTracks = 0;
+
+	/** Resolution of the file, ticks in the result are rescaled to Harmonix's ticks per quarter note */
+	int32 FileTicksPerQuarterNote = 0;
+
+	/** Why reading failed, empty on success */
+	FString Error;
+};
+
+/**
+ * Reads Standard MIDI Files straight into FMidiNotesData and song maps, without importing a UMidiFile asset first.
+ * 
+ * Files are memory mapped when the platform supports it and parsed in place, otherwise they are streamed through a
+ * file handle one chunk at a time. Notes are linked while the events are decoded, in a single pass over each track.
+ */
+class MIDIEXTENSIONS_API FMidiFileStreamReader
+{
+public:
+	static bool ReadFile(const FString& FilePath, FMidiFileStreamResult& OutResult, EMidiFileStreamFlags Flags = EMidiFileStreamFlags::None);
+
+	static bool ReadMemory(TConstArrayView<uint8> Bytes, FMidiFileStreamResult& OutResult, EMidiFileStreamFlags Flags = EMidiFileStreamFlags::None);
+};
@@ -0,0 +1,37 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MidiFileStreamWriter.generated.h"
+
+struct FMidiFileData;
+class FArchive;
+
+UENUM(BlueprintType)
+enum class EMidiFileExportFormat : uint8
+{
+	/** SMF type 0, all tracks merged into one */
+	SingleTrack,
+	/** SMF type 1, one track chunk per track */
+	MultiTrack
+};
+
+/**
+ * Writes FMidiFileData as a Standard MIDI File.
+ * 
+ * Channel messages use running status, each track chunk is sized in a first pass and then streamed through a fixed
+ * size buffer, so exports allocate the same small buffer whatever the size of the file. Only reads the data, so it
+ * can run on any thread as long as the data is not edited meanwhile.
+ * Channel, tempo, time signature and track name events are written, other text events are not.
+ */
+class MIDIEXTENSIONS_API FMidiFileStreamWriter
+{
+public:
+	static bool Write(const FMidiFileData& MidiData, FArchive& Ar, EMidiFileExportFormat Format = EMidiFileExportFormat::MultiTrack);
+
+	static bool WriteToFile(const FMidiFileData& MidiData, const FString& FilePath, EMidiFileExportFormat Format = EMidiFileExportFormat::MultiTrack);
+
+	/** Size of the buffer writes are streamed through */
+	static constexpr int32 StreamBufferSize = 64 * 1024;
+};
@@ -0,0 +1,73 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MidiFile/MidiNotesData.h"
+
+class FSongMaps;
+
+/**
+ * Read only search structures over a FMidiNotesData snapshot answering time queries in O(log n).
+ * Note indices in and out of the queries refer to FMidiNotesTrack::Notes of the indexed data.
+ * The index doesn't follow edits, check IsUpToDate() and rebuild when the notes changed.
+ */
+class MIDIEXTENSIONS_API FMidiNoteQueryIndex
+{
+public:
+	static TSharedRef<FMidiNoteQueryIndex, ESPMode::ThreadSafe> Build(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InNotesData);
+
+	/** True while the indexed data hasn't been edited since the index was built */
+	bool IsUpToDate() const { return NotesData.IsValid() && NotesData->Revision == BuiltRevision; }
+
+	int32 GetNumTracks() const { return Tracks.Num(); }
+
+	/** Appends the notes of a track sounding at Tick (NoteOnTick <= Tick < NoteOffTick), in onset order - O(log n + k log n) */
+	void GetNotesActiveAtTick(int32 TrackIndex, int32 Tick, TArray<int32>& OutNoteIndices) const;
+
+	/** Number of notes of a track sounding at Tick - O(log n) */
+	int32 CountNotesActiveAtTick(int32 TrackIndex, int32 Tick) const;
+
+	/** First note of a track starting strictly after Tick, INDEX_NONE if there is none - O(log n) */
+	int32 FindNextNoteOnset(int32 TrackIndex, int32 Tick) const;
+
+	/** Last note of a track starting strictly before Tick, INDEX_NONE if there is none - O(log n) */
+	int32 FindPreviousNoteOnset(int32 TrackIndex, int32 Tick) const;
+
+	/** Number of notes of a track starting in [StartTick, EndTick) - O(log n) */
+	int32 CountNotesStartingInRange(int32 TrackIndex, int32 StartTick, int32 EndTick) const;
+
+	void GetNotesActiveAtMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms, TArray<int32>& OutNoteIndices) const;
+	int32 CountNotesActiveAtMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms) const;
+	int32 FindNextNoteOnsetAfterMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms) const;
+	int32 FindPreviousNoteOnsetBeforeMs(const FSongMaps& SongMaps, int32 TrackIndex, double Ms) const;
+	int32 CountNotesStartingInMsRange(const FSongMaps& SongMaps, int32 TrackIndex, double StartMs, double EndMs) const;
+
+	/** Converts a song position to the tick queries use, shared by all millisecond variants */
+	static int32 MsToQueryTick(const FSongMaps& SongMaps, double Ms);
+
+	const TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe>& GetNotesData() const { return NotesData; }
+
+private:
+	struct FTrackIndex
+	{
+		/** Note indices sorted by NoteOnTick */
+		TArray<int32> OnsetOrder;
+
+		/** NoteOnTick of OnsetOrder, kept contiguous for the binary searches */
+		TArray<int32> OnsetTicks;
+
+		/** All NoteOffTicks sorted, counting offs before a tick gives the active count without visiting notes */
+		TArray<int32> SortedOffTicks;
+
+		/** Segment tree over onset order holding the max NoteOffTick of each node, leaves start at LeafCount */
+		TArray<int32> MaxOffTree;
+		int32 LeafCount = 0;
+	};
+
+	void CollectActive(const FTrackIndex& Track, int32 Node, int32 NodeBegin, int32 NodeEnd, int32 OnsetLimit, int32 Tick, TArray<int32>& OutNoteIndices) const;
+
+	TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> NotesData;
+	uint32 BuiltRevision = 0;
+	TArray<FTrackIndex> Tracks;
+};
@@ -0,0 +1,73 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiNoteTransform.generated.h"
+
+/** Identifies a note in FMidiNotesData by track and note index */
+struct FMidiNoteId
+{
+	int32 TrackIndex = INDEX_NONE;
+	int32 NoteIndex = INDEX_NONE;
+
+	bool operator==(const FMidiNoteId& Other) const
+	{
+		return TrackIndex == Other.TrackIndex && NoteIndex == Other.NoteIndex;
+	}
+
+	friend uint32 GetTypeHash(const FMidiNoteId& Key)
+	{
+		return HashCombine(GetTypeHash(Key.TrackIndex), GetTypeHash(Key.NoteIndex));
+	}
+
+	/** Splits a note set into sorted, duplicate free note indices per track */
+	static TMap<int32, TArray<int32>> GroupByTrack(TConstArrayView<FMidiNoteId> NoteIds);
+};
+
+/**
+ * Affine transform applied to a set of notes:
+ *   Tick'     = round((Tick - TickPivot) * TickScale) + TickPivot + TickOffset, clamped to >= 0
+ *   Note'     = Note + PitchOffset, clamped to [0, 127]
+ *   Velocity' = round(Velocity * VelocityScale) + VelocityOffset, clamped to [1, 127]
+ * Note-offs always stay at least one tick after their note-on.
+ */
+USTRUCT(BlueprintType)
+struct MIDIEXTENSIONS_API FMidiNoteTransform
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI")
+	float TickScale = 1.0f;
+
+	/** Tick that stays in place when scaling time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI")
+	int32 TickPivot = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI")
+	int32 TickOffset = 0;
+
+	/** Semitones to transpose by */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI")
+	int32 PitchOffset = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI")
+	float VelocityScale = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI")
+	int32 VelocityOffset = 0;
+
+	bool IsIdentity() const;
+
+	static FMidiNoteTransform MakeTranspose(int32 Semitones);
+	static FMidiNoteTransform MakeShift(int32 Ticks);
+	static FMidiNoteTransform MakeTimeScale(float Scale, int32 PivotTick);
+	static FMidiNoteTransform MakeVelocityScale(float Scale);
+
+	/** Transforms Notes[NoteIndices] in place, working on contiguous SoA columns four notes at a time */
+	void Apply(TArray<FLinkedMidiNote>& Notes, TConstArrayView<int32> NoteIndices) const;
+
+	/** Transforms a single note, matches Apply exactly */
+	FLinkedMidiNote Apply(const FLinkedMidiNote& Note) const;
+};
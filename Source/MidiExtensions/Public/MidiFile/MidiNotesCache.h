@@ -0,0 +1,201 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MidiFile/MidiNotesData.h"
+
+class UMidiFile;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Binary cache of the linked notes of a MIDI file, laid out to be used straight from a read-only memory mapping.
+ *
+ * The file is a header followed by sections, each aligned to 8 bytes and located by an offset from the start of
+ * the file, so the data is relocatable and nothing is patched on load:
+ *  - FMidiNotesCacheTrack records, one per linked track
+ *  - FLinkedMidiNote records of all tracks, each track's notes contiguous and sorted by NoteOnTick
+ *  - FMidiNotesCacheTempoSegment records with the song time each tempo starts at, the tick to time index
+ *  - FMidiNotesCacheTimeSignature records
+ *  - the track names as UTF-8
+ * Values are stored in native byte order, a cache written on a machine of the other endianness fails the magic check.
+ */
+namespace MidiNotesCache
+{
+	static constexpr uint32 Magic = 0x4843'4E4D; // "MNCH"
+	static constexpr uint32 Version = 1;
+	static constexpr uint32 SectionAlignment = 8;
+
+	/** Extension of the cache files written by FMidiNotesCacheWriter */
+	static constexpr const TCHAR* FileExtension = TEXT(".mnc");
+}
+
+struct FMidiNotesCacheHeader
+{
+	uint32 Magic = MidiNotesCache::Magic;
+	uint32 Version = MidiNotesCache::Version;
+	uint64 TotalSize = 0;
+
+	/** Opaque stamp of the source the cache was built from, lets the loader reject caches of older assets */
+	uint64 SourceStamp = 0;
+
+	int32 TicksPerQuarterNote = 0;
+	int32 LastNoteOffTick = 0;
+
+	uint32 NumTracks = 0;
+	uint32 TracksOffset = 0;
+	uint32 NumNotes = 0;
+	uint32 NotesOffset = 0;
+	uint32 NumTempoSegments = 0;
+	uint32 TempoSegmentsOffset = 0;
+	uint32 NumTimeSignatures = 0;
+	uint32 TimeSignaturesOffset = 0;
+	uint32 NamesSize = 0;
+	uint32 NamesOffset = 0;
+};
+
+struct FMidiNotesCacheTrack
+{
+	int32 TrackIndex = INDEX_NONE;
+	int32 ChannelIndex = INDEX_NONE;
+
+	/** Range of this track's notes in the notes section */
+	uint32 FirstNote = 0;
+	uint32 NumNotes = 0;
+
+	int32 FirstNoteOnTick = INDEX_NONE;
+	int32 LastNoteOffTick = 0;
+	int32 LowestNoteNumber = INDEX_NONE;
+	int32 HighestNoteNumber = INDEX_NONE;
+
+	/** Range of the UTF-8 name in the names section */
+	uint32 NameOffset = 0;
+	uint32 NameLength = 0;
+};
+
+struct FMidiNotesCacheTempoSegment
+{
+	int32 StartTick = 0;
+	int32 MicrosecondsPerQuarterNote = 500000;
+
+	/** Song time at StartTick */
+	double StartMs = 0.0;
+};
+
+struct FMidiNotesCacheTimeSignature
+{
+	int32 StartTick = 0;
+	int16 Numerator = 4;
+	int16 Denominator = 4;
+};
+
+// The records are read in place, their layout is the file format
+static_assert(sizeof(FLinkedMidiNote) == 12 && alignof(FLinkedMidiNote) == 4, "FLinkedMidiNote layout changed, bump MidiNotesCache::Version");
+static_assert(sizeof(FMidiNotesCacheHeader) == 72, "FMidiNotesCacheHeader layout changed, bump MidiNotesCache::Version");
+static_assert(sizeof(FMidiNotesCacheTrack) == 40, "FMidiNotesCacheTrack layout changed, bump MidiNotesCache::Version");
+static_assert(sizeof(FMidiNotesCacheTempoSegment) == 16, "FMidiNotesCacheTempoSegment layout changed, bump MidiNotesCache::Version");
+static_assert(sizeof(FMidiNotesCacheTimeSignature) == 8, "FMidiNotesCacheTimeSignature layout changed, bump MidiNotesCache::Version");
+
+/**
+ * Read-only view over cache bytes, it does not own them.
+ * Only create it from bytes that passed IsValidCache, the accessors trust the offsets after that.
+ */
+class MIDIEXTENSIONS_API FMidiNotesCacheView
+{
+public:
+	FMidiNotesCacheView() = default;
+
+	/** Checks the magic, version and that every section and name lies inside Bytes */
+	static bool IsValidCache(TConstArrayView64<uint8> Bytes);
+
+	explicit FMidiNotesCacheView(const uint8* InData)
+		: Data(InData)
+	{
+	}
+
+	bool IsValid() const { return Data != nullptr; }
+
+	const FMidiNotesCacheHeader& GetHeader() const { return *reinterpret_cast<const FMidiNotesCacheHeader*>(Data); }
+
+	TConstArrayView<FMidiNotesCacheTrack> GetTracks() const { return MakeSection<FMidiNotesCacheTrack>(GetHeader().TracksOffset, GetHeader().NumTracks); }
+
+	/** Notes of a track, sorted by NoteOnTick */
+	TConstArrayView<FLinkedMidiNote> GetTrackNotes(int32 TrackIndex) const;
+
+	FUtf8StringView GetTrackName(int32 TrackIndex) const;
+
+	TConstArrayView<FMidiNotesCacheTempoSegment> GetTempoSegments() const { return MakeSection<FMidiNotesCacheTempoSegment>(GetHeader().TempoSegmentsOffset, GetHeader().NumTempoSegments); }
+
+	TConstArrayView<FMidiNotesCacheTimeSignature> GetTimeSignatures() const { return MakeSection<FMidiNotesCacheTimeSignature>(GetHeader().TimeSignaturesOffset, GetHeader().NumTimeSignatures); }
+
+	/** Song time of Tick from the tempo segments - O(log tempo changes) */
+	double TickToMs(int32 Tick) const;
+
+	/** Index of the first note of a track starting at or after Tick - O(log notes) */
+	int32 FindFirstNoteAtOrAfterTick(int32 TrackIndex, int32 Tick) const;
+
+	/** Copies the notes into a FMidiNotesData, for code that edits or needs the controller lanes, which are not cached */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> ToNotesData() const;
+
+private:
+	template<typename RecordType>
+	TConstArrayView<RecordType> MakeSection(uint32 Offset, uint32 Num) const
+	{
+		return TConstArrayView<RecordType>(reinterpret_cast<const RecordType*>(Data + Offset), Num);
+	}
+
+	const uint8* Data = nullptr;
+};
+
+/**
+ * An opened cache file. The file is memory-mapped when the platform supports it, so opening costs one validation pass
+ * over the headers and the notes are paged in as they are read. Otherwise the file is loaded into memory.
+ */
+class MIDIEXTENSIONS_API FMidiNotesCacheFile
+{
+public:
+	/**
+	 * Opens and validates a cache file.
+	 * @param ExpectedSourceStamp If not 0, caches built from another version of the source are rejected
+	 * @return Null if the file is missing, invalid or stale
+	 */
+	static TUniquePtr<FMidiNotesCacheFile> Open(const FString& FilePath, uint64 ExpectedSourceStamp = 0);
+
+	~FMidiNotesCacheFile();
+
+	const FMidiNotesCacheView& GetView() const { return View; }
+
+	/** True if the file is read through a memory mapping rather than a loaded copy */
+	bool IsMapped() const { return MappedRegion.IsValid(); }
+
+private:
+	FMidiNotesCacheFile() = default;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** Fallback when the file can't be mapped */
+	TArray64<uint8> LoadedBytes;
+
+	FMidiNotesCacheView View;
+};
+
+struct MIDIEXTENSIONS_API FMidiNotesCacheWriter
+{
+	/** Builds the cache bytes for a MIDI file, SourceStamp is stored as is for FMidiNotesCacheFile::Open to compare */
+	static bool Write(UMidiFile* MidiFile, TArray64<uint8>& OutBytes, uint64 SourceStamp = 0);
+
+	static bool WriteToFile(UMidiFile* MidiFile, const FString& FilePath, uint64 SourceStamp = 0);
+
+	/** Write with notes the caller already built from MidiFile, the file itself only provides the tempo map */
+	static bool Write(UMidiFile* MidiFile, const FMidiNotesData& NotesData, TArray64<uint8>& OutBytes, uint64 SourceStamp = 0);
+
+	static bool WriteToFile(UMidiFile* MidiFile, const FMidiNotesData& NotesData, const FString& FilePath, uint64 SourceStamp = 0);
+
+	/** Directory the cache commandlet writes to by default, Saved/MidiNotesCache */
+	static FString GetDefaultCacheDirectory();
+
+	/** Path of the cache of a package under CacheDirectory, /Game/Music/Song maps to <CacheDirectory>/Game/Music/Song.mnc */
+	static FString GetCacheFilePath(const FString& CacheDirectory, FName PackageName);
+};
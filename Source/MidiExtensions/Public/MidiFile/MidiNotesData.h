@@ -5,8 +5,11 @@
 #include "CoreMinimal.h"
 #include "MidiNotesData.generated.h"
 
+struct FMidiNoteId;
+struct FMidiNoteTransform;
+
 // This struct links note-on and note-off events
-USTRUCT(BlueprintType)
+USTRUCT(BlueprintType, meta = (HasNativeBreak = "/Script/MidiExtensions.MidiExtensionsHelperLib.BreakLinkedMidiNote"))
 struct FLinkedMidiNote
 {
     GENERATED_BODY()
@@ -23,7 +26,10 @@ struct FLinkedMidiNote
     UPROPERTY()
     int8 NoteNumber = 0;
 
+    /** Velocities come in as int32 from painting and Blueprints, values past 127 would wrap in the int8 */
+    static int8 ClampVelocity(int32 InVelocity) { return static_cast<int8>(FMath::Clamp(InVelocity, 1, 127)); }
 
+    static int8 ClampNoteNumber(int32 InNoteNumber) { return static_cast<int8>(FMath::Clamp(InNoteNumber, 0, 127)); }
 };
 
 USTRUCT(BlueprintType)
@@ -44,11 +50,88 @@ struct FMidiNotesTrack
     UPROPERTY()
     int32 ChannelIndex = INDEX_NONE;
 
+    /** Earliest NoteOnTick in this track, INDEX_NONE if the track has no notes */
+    UPROPERTY()
+    int32 FirstNoteOnTick = INDEX_NONE;
+
+    /** Latest NoteOffTick in this track, 0 if the track has no notes */
+    UPROPERTY()
+    int32 LastNoteOffTick = 0;
+
+    /** Lowest and highest note numbers in this track, INDEX_NONE if the track has no notes */
+    UPROPERTY()
+    int32 LowestNoteNumber = INDEX_NONE;
+
+    UPROPERTY()
+    int32 HighestNoteNumber = INDEX_NONE;
+
+    bool HasNotes() const { return FirstNoteOnTick != INDEX_NONE; }
+
+    /** Grows the cached extents to include Note - O(1) */
+    void ExpandExtents(const FLinkedMidiNote& Note);
+
+    /** True if removing Note may shrink the cached extents, in which case they need to be recalculated */
+    bool IsOnExtentsBoundary(const FLinkedMidiNote& Note) const;
 
+    /** Recomputes the cached extents by scanning all notes in the track */
+    void RecalculateExtents();
 };
 
 
 
+UENUM(BlueprintType)
+enum class EMidiControllerType : uint8
+{
+    ControlChange,
+    PitchBend,
+    ChannelAftertouch,
+    PolyAftertouch
+};
+
+/**
+ * Value changes of one controller on one channel of a MIDI track, stored as sorted parallel tick/value arrays.
+ * Values are 0-127, except pitch bend which is centered, -8192 to 8191.
+ */
+USTRUCT(BlueprintType)
+struct MIDIEXTENSIONS_API FMidiControllerLane
+{
+    GENERATED_BODY()
+
+    /** Index of the MIDI track in the source file */
+    UPROPERTY()
+    int32 TrackIndex = INDEX_NONE;
+
+    UPROPERTY()
+    int32 ChannelIndex = 0;
+
+    UPROPERTY()
+    EMidiControllerType Type = EMidiControllerType::ControlChange;
+
+    /** Controller number for control changes, note number for poly aftertouch, 0 otherwise */
+    UPROPERTY()
+    int32 Number = 0;
+
+    UPROPERTY()
+    TArray<int32> Ticks;
+
+    UPROPERTY()
+    TArray<int16> Values;
+
+    bool Matches(int32 InTrackIndex, int32 InChannelIndex, EMidiControllerType InType, int32 InNumber) const
+    {
+        return TrackIndex == InTrackIndex && ChannelIndex == InChannelIndex && Type == InType && Number == InNumber;
+    }
+
+    /** Index of the last change at or before Tick, INDEX_NONE if the lane only changes after it - O(log n) */
+    int32 FindChangeIndexAtTick(int32 Tick) const;
+
+    /** Value in effect at Tick, DefaultValue before the first change - O(log n) */
+    int32 GetValueAtTick(int32 Tick, int32 DefaultValue = 0) const;
+
+    /** Appends a change, a change on the same tick as the last one replaces it */
+    void AddChange(int32 Tick, int32 Value);
+};
+
 USTRUCT(BlueprintType, meta = (HasNativeMake = "/Script/MidiExtensions.MidiExtensionsHelperLib.MakeMidiNotesData"))
 struct MIDIEXTENSIONS_API FMidiNotesData
 {
@@ -57,44 +140,86 @@ struct MIDIEXTENSIONS_API FMidiNotesData
     UPROPERTY()
     TArray<FMidiNotesTrack> Tracks;
 
+    /** Latest NoteOffTick across all tracks, kept up to date together with the per track extents */
+    UPROPERTY()
+    int32 LastNoteOffTick = 0;
+
+    /** Control change, pitch bend and aftertouch lanes, sorted by track, channel, type and number */
+    UPROPERTY()
+    TArray<FMidiControllerLane> ControllerLanes;
+
+    /** Bumped whenever the notes are edited in place, lets caches built from the data detect they are stale */
+    uint32 Revision = 0;
+
 	static TSharedPtr<FMidiNotesData> BuildFromMidiFile(class UMidiFile* MidiFile);
 
+    /** Last step of building the data: sorts each track's notes by NoteOnTick, orders the lanes and caches the extents */
+    void FinishBuild();
+
+    /** Refreshes LastNoteOffTick from the cached per track extents - O(tracks) */
+    void RefreshExtents();
+
+    /** Applies Transform to the given notes, keeps the tracks sorted by NoteOnTick and updates the extents, invalid ids are skipped */
+    void TransformNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiNoteTransform& Transform);
+
+    /** Finds the lane of a controller, nullptr if the file never changes it - O(lanes) */
+    const FMidiControllerLane* FindControllerLane(int32 TrackIndex, int32 ChannelIndex, EMidiControllerType Type, int32 Number = 0) const;
+
 
 };
 
+/**
+ * Walks all notes of a FMidiNotesData in NoteOnTick order, merging the tracks with a min-heap of per track cursors.
+ * The notes are referenced through a shared pointer and never copied, copying the iterator only copies the cursors.
+ * Expects the notes of each track to be sorted by NoteOnTick, as produced by FMidiNotesData::BuildFromMidiFile and
+ * kept by the UMutableMidiFile edits.
+ */
 USTRUCT(BlueprintType, meta = (HasNativeMake = "/Script/MidiExtensions.MidiExtensionsHelperLib.MakeMidiFileIterator"))
 struct MIDIEXTENSIONS_API FMidiFileIterator
 {
     GENERATED_BODY()
-    UPROPERTY()
-    FMidiNotesData MidiData;
-    UPROPERTY()
-    int32 CurrentTrackIndex = 0;
-    UPROPERTY()
-    int32 CurrentNoteIndex = 0;
-    bool IsValid() const
+
+    FMidiFileIterator() = default;
+
+    /** Creates an iterator positioned on the first note of the data */
+    explicit FMidiFileIterator(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InMidiData);
+
+    bool IsValid() const { return !Heap.IsEmpty(); }
+
+    /** The note under the cursor, only call while IsValid() */
+    const FLinkedMidiNote& GetCurrentNote() const;
+
+    /** Index of the track in the notes data the current note belongs to, INDEX_NONE if not valid */
+    int32 GetCurrentTrackIndex() const { return IsValid() ? Heap.HeapTop().TrackIndex : INDEX_NONE; }
+
+    /** Index of the current note within its track, INDEX_NONE if not valid */
+    int32 GetCurrentNoteIndex() const { return IsValid() ? TrackCursors[Heap.HeapTop().TrackIndex] : INDEX_NONE; }
+
+    /** Moves to the next note in time order, notes starting on the same tick are ordered by track - O(log tracks) */
+    void Advance();
+
+    /** Positions the iterator on the first note starting at or after Tick - O(tracks * log notes) */
+    void SeekToTick(int32 Tick);
+
+    const TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe>& GetMidiData() const { return MidiData; }
+
+private:
+    struct FTrackCursor
     {
-        if (CurrentTrackIndex < 0 || CurrentTrackIndex >= MidiData.Tracks.Num())
-        {
-            return false;
-        }
-        if (CurrentNoteIndex < 0 || CurrentNoteIndex >= MidiData.Tracks[CurrentTrackIndex].Notes.Num())
+        int32 Tick;
+        int32 TrackIndex;
+
+        bool operator<(const FTrackCursor& Other) const
         {
-            return false;
+            return Tick < Other.Tick || (Tick == Other.Tick && TrackIndex < Other.TrackIndex);
         }
-        return true;
-    }
-    FLinkedMidiNote GetCurrentNote() const
-    {
-        const FMidiNotesTrack& Track = MidiData.Tracks[CurrentTrackIndex];
-        check(CurrentNoteIndex >= 0 && CurrentNoteIndex < Track.Notes.Num());
-        return Track.Notes[CurrentNoteIndex];
-    }
-};
+    };
+
+    TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> MidiData;
 
-    //FLinkedMidiNote GetCurrentNote() const
-    //{
-    //   // const FMidiNotesTrack& Track = MidiData.Tracks[CurrentTrackIndex];
-    //   // check(CurrentNoteIndex >= 0 && CurrentNoteIndex < Track.Notes.Num());
-    //    return Track.Notes[CurrentNoteIndex];
-    //}
+    /** Next note index for each track */
+    TArray<int32> TrackCursors;
+
+    /** Min-heap of the tracks that still have notes, keyed by the NoteOnTick of their next note */
+    TArray<FTrackCursor> Heap;
+};
@@ -0,0 +1,110 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiFile/MidiNoteQueryIndex.h"
+#include "MidiNotesDataHandle.generated.h"
+
+/**
+ * Blueprint handle to shared linked notes data.
+ * Passing the handle around graphs copies a pointer, the notes are only copied out by the query functions.
+ * Time queries go through a FMidiNoteQueryIndex built on first use and rebuilt after the notes are edited,
+ * millisecond queries use the tempo map of the midi file the handle was created for.
+ */
+UCLASS(BlueprintType)
+class MIDIEXTENSIONS_API UMidiNotesDataHandle : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	static UMidiNotesDataHandle* Create(UObject* Outer, TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> InNotesData);
+
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> GetNotesData() const { return NotesData; }
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	bool HasNotesData() const { return NotesData.IsValid(); }
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	int32 GetNumTracks() const;
+
+	/** Total number of notes across all tracks */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	int32 GetNoteCount() const;
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	int32 GetTrackNoteCount(int32 TrackIndex) const;
+
+	/** Latest NoteOffTick across all tracks */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	int32 GetLastNoteOffTick() const;
+
+	/** Reads the description of a track, returns false if TrackIndex is out of range */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	bool GetTrackInfo(int32 TrackIndex, FString& TrackName, int32& MidiTrackIndex, int32& ChannelIndex, int32& FirstNoteOnTick, int32& LastNoteOffTick) const;
+
+	/** Notes of a track that start in [StartTick, EndTick), sorted by NoteOnTick */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	TArray<FLinkedMidiNote> GetNotesInRange(int32 TrackIndex, int32 StartTick, int32 EndTick) const;
+
+	/** Creates an iterator over all notes in time order, positioned on the first note starting at or after StartTick */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	FMidiFileIterator MakeIterator(int32 StartTick = 0) const;
+
+	/** Reads a single note, returns false if the indices are out of range */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes")
+	bool GetNote(int32 TrackIndex, int32 NoteIndex, FLinkedMidiNote& Note) const;
+
+	/** Indices of the notes of a track sounding at Tick */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	TArray<int32> GetNotesActiveAtTick(int32 TrackIndex, int32 Tick) const;
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 CountNotesActiveAtTick(int32 TrackIndex, int32 Tick) const;
+
+	/** Index of the first note of a track starting after Tick, -1 if there is none */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 FindNextNoteOnset(int32 TrackIndex, int32 Tick) const;
+
+	/** Index of the last note of a track starting before Tick, -1 if there is none */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 FindPreviousNoteOnset(int32 TrackIndex, int32 Tick) const;
+
+	/** Number of notes of a track starting in [StartTick, EndTick) */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 CountNotesStartingInRange(int32 TrackIndex, int32 StartTick, int32 EndTick) const;
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	TArray<int32> GetNotesActiveAtMs(int32 TrackIndex, float Ms) const;
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 CountNotesActiveAtMs(int32 TrackIndex, float Ms) const;
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 FindNextNoteOnsetAfterMs(int32 TrackIndex, float Ms) const;
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 FindPreviousNoteOnsetBeforeMs(int32 TrackIndex, float Ms) const;
+
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Notes|Query")
+	int32 CountNotesStartingInMsRange(int32 TrackIndex, float StartMs, float EndMs) const;
+
+	/** True if the file has changes for the controller, TrackIndex is the MIDI track in the source file */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Controllers")
+	bool HasControllerLane(int32 TrackIndex, int32 ChannelIndex, EMidiControllerType Type, int32 Number = 0) const;
+
+	/** Value of a controller at Tick, DefaultValue if it hasn't changed by then. Pitch bend is centered on 0 */
+	UFUNCTION(BlueprintPure, Category = "MIDI Extensions|Controllers")
+	int32 GetControllerValueAtTick(int32 TrackIndex, int32 ChannelIndex, EMidiControllerType Type, int32 Number, int32 Tick, int32 DefaultValue = 0) const;
+
+	/** The query index for the current notes, rebuilt if the notes were edited since the last query */
+	const FMidiNoteQueryIndex& GetQueryIndex() const;
+
+private:
+	const FSongMaps* GetSongMaps() const;
+
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData;
+	mutable TSharedPtr<FMidiNoteQueryIndex, ESPMode::ThreadSafe> QueryIndex;
+};
@@ -0,0 +1,100 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/RefCounting.h"
+#include "MidiFile/MidiNotesData.h"
+#include <atomic>
+
+/**
+ * Immutable version of the linked notes of a file. Tracks are held by shared pointer, so a snapshot published after an
+ * edit shares every track the edit did not touch with the previous one, and the controller lanes with all of them.
+ * Nothing in a snapshot changes after it is published, any number of threads can read it without synchronization.
+ */
+class MIDIEXTENSIONS_API FMidiNotesSnapshot : public FThreadSafeRefCountedObject
+{
+public:
+	using FTrackPtr = TSharedPtr<const FMidiNotesTrack, ESPMode::ThreadSafe>;
+	using FControllerLanesPtr = TSharedPtr<const TArray<FMidiControllerLane>, ESPMode::ThreadSafe>;
+
+	/**
+	 * Builds a snapshot of NotesData. Tracks not listed in EditedTracks are taken from Previous when it is given,
+	 * the caller guarantees those tracks did not change since Previous was built.
+	 */
+	static TRefCountPtr<FMidiNotesSnapshot> Build(const FMidiNotesData& NotesData, uint32 ContentVersion, const FMidiNotesSnapshot* Previous = nullptr, TConstArrayView<int32> EditedTracks = {});
+
+	int32 GetNumTracks() const { return Tracks.Num(); }
+
+	/** A track of the snapshot, null if TrackIndex is out of range */
+	const FMidiNotesTrack* GetTrack(int32 TrackIndex) const { return Tracks.IsValidIndex(TrackIndex) ? Tracks[TrackIndex].Get() : nullptr; }
+
+	/** The shared pointer to a track, lets readers keep one track alive past the snapshot */
+	const FTrackPtr& GetTrackPtr(int32 TrackIndex) const { return Tracks[TrackIndex]; }
+
+	TConstArrayView<FMidiControllerLane> GetControllerLanes() const { return ControllerLanes.IsValid() ? TConstArrayView<FMidiControllerLane>(*ControllerLanes) : TConstArrayView<FMidiControllerLane>(); }
+
+	int32 GetLastNoteOffTick() const { return LastNoteOffTick; }
+
+	/** Content version of the file the snapshot was taken at, see UMutableMidiFile::GetContentVersion */
+	uint32 GetContentVersion() const { return ContentVersion; }
+
+	/** Copies the snapshot into a plain FMidiNotesData, e.g. for code that takes the mutable type */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> ToNotesData() const;
+
+private:
+	TArray<FTrackPtr> Tracks;
+
+	FControllerLanesPtr ControllerLanes;
+
+	int32 LastNoteOffTick = 0;
+
+	uint32 ContentVersion = 0;
+};
+
+/**
+ * Holds the current snapshot of a file and hands it to readers on any thread without locks.
+ *
+ * Publishing swaps the pointer atomically. A reader announces itself in one of two counters around the load and the
+ * reference increment. The publisher never waits for readers: it retires the old snapshot and drops its reference once
+ * both counters were seen at zero after the swap, checked by this and later Publish calls, so a reader never
+ * increments the count of a freed snapshot. Every Publish moves new readers to the other counter, so the one they left
+ * drains even under continuous reading. The reader side is a handful of atomic operations and never waits either.
+ */
+class MIDIEXTENSIONS_API FMidiNotesSnapshotPublisher
+{
+public:
+	FMidiNotesSnapshotPublisher() = default;
+	~FMidiNotesSnapshotPublisher();
+
+	FMidiNotesSnapshotPublisher(const FMidiNotesSnapshotPublisher&) = delete;
+	FMidiNotesSnapshotPublisher& operator=(const FMidiNotesSnapshotPublisher&) = delete;
+
+	/** Reader side, any thread. The returned snapshot stays valid for as long as it is held */
+	TRefCountPtr<const FMidiNotesSnapshot> Acquire() const;
+
+	/** Publisher side, a single thread at a time */
+	void Publish(TRefCountPtr<FMidiNotesSnapshot> Snapshot);
+
+private:
+	std::atomic<const FMidiNotesSnapshot*> Current = nullptr;
+
+	/** Selects the counter new readers announce themselves in, flipped by every Publish */
+	std::atomic<uint32> Epoch = 0;
+
+	/** Readers between loading Current and taking their reference, by the epoch parity they entered with */
+	mutable std::atomic<int32> ActiveReaders[2] = { 0, 0 };
+
+	/** A swapped out snapshot still holding the publisher's reference, and which counters were seen at zero since */
+	struct FRetiredSnapshot
+	{
+		const FMidiNotesSnapshot* Snapshot = nullptr;
+		bool bReadersDrained[2] = { false, false };
+	};
+
+	/** Publisher side only */
+	TArray<FRetiredSnapshot> RetiredSnapshots;
+
+	/** Releases the retired snapshots no reader can still be about to reference */
+	void ReclaimRetiredSnapshots();
+};
@@ -0,0 +1,185 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MidiFile/MidiNotesData.h"
+#include "Algo/BinarySearch.h"
+
+/**
+ * Compact read-only encoding of the notes of a FMidiNotesData, for keeping large note libraries in memory.
+ *
+ * Each track is cut into blocks of NotesPerBlock notes, every block starts at the byte offset kept in its header
+ * and decodes on its own. A note is written as:
+ *  - the zigzag varint delta of its NoteOnTick to the previous note, the first note of a block starts from the header
+ *  - the varint duration in ticks
+ *  - one byte holding the 7-bit note number, the high bit is set when the velocity repeats the previous note's
+ *  - one byte holding the 7-bit velocity, only when it changed
+ *
+ * Tracks sorted by NoteOnTick, as produced by FMidiNotesData::BuildFromMidiFile, keep the deltas to a byte or two
+ * and let range queries binary search the block headers. Controller lanes are not packed.
+ */
+struct MIDIEXTENSIONS_API FMidiPackedNotes
+{
+	static constexpr int32 NotesPerBlock = 128;
+
+	struct FBlockHeader
+	{
+		int32 FirstNoteOnTick = 0;
+		uint32 ByteOffset = 0;
+	};
+
+	struct FTrack
+	{
+		FString TrackName;
+		int32 TrackIndex = INDEX_NONE;
+		int32 ChannelIndex = INDEX_NONE;
+		int32 NumNotes = 0;
+
+		/** Extents of the track, same meaning as in FMidiNotesTrack */
+		int32 FirstNoteOnTick = INDEX_NONE;
+		int32 LastNoteOffTick = 0;
+		int32 LowestNoteNumber = INDEX_NONE;
+		int32 HighestNoteNumber = INDEX_NONE;
+
+		/** False if the notes were not in NoteOnTick order, range queries then scan every block */
+		bool bSortedByNoteOnTick = true;
+
+		TArray<FBlockHeader> Blocks;
+		TArray<uint8> Bytes;
+	};
+
+	FMidiPackedNotes() = default;
+	FMidiPackedNotes(FMidiPackedNotes&& Other);
+	FMidiPackedNotes& operator=(FMidiPackedNotes&& Other);
+	~FMidiPackedNotes();
+
+	/** Copies would double count the memory stats, the packed data is meant to be built once and shared */
+	FMidiPackedNotes(const FMidiPackedNotes&) = delete;
+	FMidiPackedNotes& operator=(const FMidiPackedNotes&) = delete;
+
+	/** Packs the notes of NotesData, velocities and note numbers outside 0-127 are clamped */
+	static FMidiPackedNotes Pack(const FMidiNotesData& NotesData);
+
+	/** Decodes everything back into plain note arrays */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> Unpack() const;
+
+	const TArray<FTrack>& GetTracks() const { return Tracks; }
+
+	int32 GetLastNoteOffTick() const { return LastNoteOffTick; }
+
+	/** Total number of notes across all tracks */
+	int32 GetNumNotes() const;
+
+	/** Decodes the notes of a track in their packed order, appending them to OutNotes */
+	void DecodeTrack(int32 TrackIndex, TArray<FLinkedMidiNote>& OutNotes) const;
+
+	/** Calls Visitor with every note of a track in its packed order */
+	template<typename VisitorType>
+	void ForEachNote(int32 TrackIndex, VisitorType&& Visitor) const
+	{
+		if (!Tracks.IsValidIndex(TrackIndex))
+		{
+			return;
+		}
+
+		const FTrack& Track = Tracks[TrackIndex];
+		for (int32 BlockIndex = 0; BlockIndex < Track.Blocks.Num(); ++BlockIndex)
+		{
+			DecodeBlock(Track, BlockIndex, Visitor);
+		}
+	}
+
+	/** Calls Visitor with the notes of a track that start in [StartTick, EndTick), skipping whole blocks on sorted tracks */
+	template<typename VisitorType>
+	void ForEachNoteInRange(int32 TrackIndex, int32 StartTick, int32 EndTick, VisitorType&& Visitor) const
+	{
+		if (!Tracks.IsValidIndex(TrackIndex) || StartTick >= EndTick)
+		{
+			return;
+		}
+
+		const FTrack& Track = Tracks[TrackIndex];
+		auto VisitInRange = [StartTick, EndTick, &Visitor](const FLinkedMidiNote& Note)
+		{
+			if (Note.NoteOnTick >= StartTick && Note.NoteOnTick < EndTick)
+			{
+				Visitor(Note);
+			}
+		};
+
+		if (!Track.bSortedByNoteOnTick)
+		{
+			for (int32 BlockIndex = 0; BlockIndex < Track.Blocks.Num(); ++BlockIndex)
+			{
+				DecodeBlock(Track, BlockIndex, VisitInRange);
+			}
+			return;
+		}
+
+		// The last block starting at or before StartTick is the first that can hold a match
+		const int32 FirstBlock = FMath::Max(0, Algo::UpperBoundBy(Track.Blocks, StartTick, &FBlockHeader::FirstNoteOnTick) - 1);
+		for (int32 BlockIndex = FirstBlock; BlockIndex < Track.Blocks.Num() && Track.Blocks[BlockIndex].FirstNoteOnTick < EndTick; ++BlockIndex)
+		{
+			DecodeBlock(Track, BlockIndex, VisitInRange);
+		}
+	}
+
+	/** Bytes held by the packed tracks, headers included */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Bytes the same notes take as plain FLinkedMidiNote arrays, to compare against GetAllocatedSize */
+	SIZE_T GetUnpackedSize() const;
+
+private:
+	static FORCEINLINE uint32 ReadVarLen(const uint8*& Cursor)
+	{
+		uint32 Value = 0;
+		int32 Shift = 0;
+		uint8 Byte;
+		do
+		{
+			Byte = *Cursor++;
+			Value |= static_cast<uint32>(Byte & 0x7F) << Shift;
+			Shift += 7;
+		} while ((Byte & 0x80) && Shift < 35);
+		return Value;
+	}
+
+	template<typename VisitorType>
+	static void DecodeBlock(const FTrack& Track, int32 BlockIndex, VisitorType& Visitor)
+	{
+		const FBlockHeader& Header = Track.Blocks[BlockIndex];
+		const int32 NumBlockNotes = FMath::Min(NotesPerBlock, Track.NumNotes - BlockIndex * NotesPerBlock);
+		const uint8* Cursor = Track.Bytes.GetData() + Header.ByteOffset;
+
+		FLinkedMidiNote Note;
+		int32 Tick = Header.FirstNoteOnTick;
+		int8 Velocity = 0;
+		for (int32 NoteIndex = 0; NoteIndex < NumBlockNotes; ++NoteIndex)
+		{
+			const uint32 ZigZagDelta = ReadVarLen(Cursor);
+			Tick += static_cast<int32>(ZigZagDelta >> 1) ^ -static_cast<int32>(ZigZagDelta & 1);
+			const int32 Duration = static_cast<int32>(ReadVarLen(Cursor));
+
+			const uint8 PitchByte = *Cursor++;
+			if (!(PitchByte & 0x80))
+			{
+				Velocity = static_cast<int8>(*Cursor++);
+			}
+
+			Note.NoteOnTick = Tick;
+			Note.NoteOffTick = Tick + Duration;
+			Note.NoteNumber = static_cast<int8>(PitchByte & 0x7F);
+			Note.Velocity = Velocity;
+			Visitor(static_cast<const FLinkedMidiNote&>(Note));
+		}
+	}
+
+	/** Adds or removes this object's sizes from the memory stats */
+	void UpdateMemoryStats(bool bAdd) const;
+
+	TArray<FTrack> Tracks;
+
+	int32 LastNoteOffTick = 0;
+};
@@ -0,0 +1,69 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HarmonixMidi/SongMaps.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiQuantize.generated.h"
+
+struct FMidiNoteId;
+struct FNotesEditCallbackData;
+
+/** How FMidiQuantizer moves notes towards the grid and how much it randomises them afterwards */
+USTRUCT(BlueprintType)
+struct MIDIEXTENSIONS_API FMidiQuantizeSettings
+{
+	GENERATED_BODY()
+
+	/** Grid to quantize to, follows the time signature at each note */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quantize")
+	EMidiClockSubdivisionQuantization Division = EMidiClockSubdivisionQuantization::SixteenthNote;
+
+	/** 0 leaves notes in place, 1 moves them all the way to the grid */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quantize", meta = (ClampMin = "0", ClampMax = "1"))
+	float Strength = 1.0f;
+
+	/** Delays every second grid point by this fraction of a grid step, 0 is straight and 1/3 a triplet feel */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quantize", meta = (ClampMin = "0", ClampMax = "1"))
+	float Swing = 0.0f;
+
+	/** Quantize note-offs to the grid as well, otherwise notes keep their duration */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quantize")
+	bool bQuantizeNoteEnds = false;
+
+	/** Maximum random offset in ticks added to each note after quantizing */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Humanize", meta = (ClampMin = "0"))
+	int32 HumanizeTicks = 0;
+
+	/** Maximum random change in velocity */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Humanize", meta = (ClampMin = "0", ClampMax = "127"))
+	int32 HumanizeVelocity = 0;
+
+	/** Seed for humanize, the same seed gives the same result for the same notes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Humanize")
+	int32 Seed = 0;
+};
+
+/**
+ * Quantize and humanize over whole tracks or note sets.
+ * Notes are processed in parallel batches and the result is a list of edits to commit in a single ModifyNotes call.
+ */
+class MIDIEXTENSIONS_API FMidiQuantizer
+{
+public:
+	/** Notes per parallel batch */
+	static constexpr int32 BatchSize = 4096;
+
+	/** Nearest grid point to Tick using the time signature at Tick */
+	static int32 SnapTickToGrid(const FSongMaps& SongMaps, int32 Tick, EMidiClockSubdivisionQuantization Division);
+
+	/** Quantizes a single note, deterministic for a given note id and seed */
+	static FLinkedMidiNote QuantizeNote(const FSongMaps& SongMaps, const FLinkedMidiNote& Note, const FMidiQuantizeSettings& Settings, const FMidiNoteId& NoteId);
+
+	/** Builds modification edits for the given notes, notes that don't move are left out */
+	static TArray<FNotesEditCallbackData> BuildEdits(const FMidiNotesData& NotesData, const FSongMaps& SongMaps, TConstArrayView<FMidiNoteId> NoteIds, const FMidiQuantizeSettings& Settings);
+
+	/** Ids of every note in a track, for quantizing whole tracks */
+	static TArray<FMidiNoteId> GetTrackNoteIds(const FMidiNotesData& NotesData, int32 TrackIndex);
+};
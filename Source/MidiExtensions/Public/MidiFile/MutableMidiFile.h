@@ -5,6 +5,9 @@
 #include "CoreMinimal.h"
 #include "HarmonixMidi/MidiFile.h"
 #include "MidiFile/MidiNotesData.h"
+#include "MidiFile/MidiQuantize.h"
+#include "MidiFile/MidiFileStreamWriter.h"
+#include "MidiFile/MidiNotesSnapshot.h"
 #include "MutableMidiFile.generated.h"
 
 DECLARE_MULTICAST_DELEGATE(FOnMutableMidiFileChanged);
@@ -18,6 +21,9 @@ struct FNotesEditCallbackData
 };
 
 DECLARE_DELEGATE_OneParam(FOnNotesEdit, const TArray<FNotesEditCallbackData>&);
+
+/** Completion of UMutableMidiFile::SaveAsAssetAsync, the saved asset is null if saving failed */
+DECLARE_DELEGATE_TwoParams(FOnMidiFileSaved, UMidiFile* /*SavedFile*/, bool /*bSuccess*/);
  
 /**
  * 
@@ -34,27 +40,153 @@ bool bIsMutableMidiFile = true;
 
 TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> LinkedMidiData;
 
-	/** Removes note-on and note-off events from a MIDI track */
-	void RemoveNoteEventsFromTrack(FMidiTrack* Track, const FLinkedMidiNote& Note, int32 Channel);
+	/**
+	 * Linked notes of the mutable file this one was copied from, read only and shared until this file needs its own.
+	 * They are only reused while their revision still matches SharedSourceRevision, the source may edit them in place.
+	 */
+	TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> SharedSourceMidiData;
+	uint32 SharedSourceRevision = 0;
+
+	/** Gives this file its own up to date LinkedMidiData, copied from the shared source notes or built from the tracks */
+	void EnsureLinkedMidiData();
+
+	/** Bumped on every change to the MIDI data, starts at 1 so caches can use 0 for never built */
+	uint32 ContentVersion = 1;
+
+	/** ContentVersion LinkedMidiData matches, the notes are rebuilt when the two differ */
+	uint32 LinkedMidiDataVersion = 0;
+
+	/** Bumps ContentVersion, LinkedMidiData is stale afterwards unless the caller updated it and syncs the version */
+	void MarkContentChanged() { ++ContentVersion; }
+
+	/** Removes the events of RemovedNotes and adds events for AddedNotes, in one pass over the track's events */
+	void RewriteNoteEvents(FMidiTrack* Track, int32 Channel, TConstArrayView<FLinkedMidiNote> RemovedNotes, TConstArrayView<FLinkedMidiNote> AddedNotes);
 
 	/** Adds note-on and note-off events to a MIDI track */
 	void AddNoteEventsToTrack(FMidiTrack* Track, const FLinkedMidiNote& Note, int32 Channel);
 
+	/** Creates the package and asset object for SaveAsAsset, holding a copy of this file's current MIDI data */
+	UMutableMidiFile* CreateAssetCopy(const FString& PackagePath, const FString& AssetName, FString& OutPackageFilename) const;
+
+	/**
+	 * Shared tail of the note edits: sorts the edited notes, refreshes extents, sorts and rescans the tracks, updates
+	 * proxies and notifies. NoteOriginsByTrack holds the index every note of an edited track had before the edits,
+	 * INDEX_NONE for added notes, tracks without an entry were edited in place.
+	 */
+	void FinishNoteEdits(TConstArrayView<int32> EditedTracks, const TMap<int32, TArray<int32>>& NoteOriginsByTrack = {});
+
+	/** Stable sorts the edited linked tracks by NoteOnTick again and records where each note moved in LastEditNoteIndices */
+	void SortEditedNotes(TConstArrayView<int32> EditedTracks, const TMap<int32, TArray<int32>>& NoteOriginsByTrack);
+
+	/** Per edited track, the index after the last note edit of each note index before it, INDEX_NONE if deleted */
+	TMap<int32, TArray<int32>> LastEditNoteIndices;
+
+	/** ContentVersion the last note edit or added track produced, LastEditNoteIndices only describe that change */
+	uint32 LastNoteEditVersion = 0;
+
+	/** Immutable snapshots of the linked notes for readers on other threads, see GetSnapshotPublisher */
+	TSharedRef<FMidiNotesSnapshotPublisher, ESPMode::ThreadSafe> SnapshotPublisher = MakeShared<FMidiNotesSnapshotPublisher, ESPMode::ThreadSafe>();
+
+	/** Snapshots are only built once somebody asked for the publisher */
+	bool bPublishSnapshots = false;
+
+	/** Linked notes the current snapshot was built from, an incremental snapshot needs the same notes one edit later */
+	const FMidiNotesData* SnapshotSource = nullptr;
+
+	/** Publishes a snapshot of the linked notes, sharing every track not in EditedTracks with the previous one when it can */
+	void PublishSnapshot(TConstArrayView<int32> EditedTracks = {});
+
 public:
 	virtual TSharedPtr<Audio::IProxyData> CreateProxyData(const Audio::FProxyDataInitParams& InitParams) override;
 
+	virtual void Serialize(FArchive& Ar) override;
+
+#if WITH_EDITOR
+	virtual void PostEditUndo() override;
+#endif
+
+	/**
+	 * Copies the MIDI data of SourceFile into this file.
+	 * A mutable source is already sorted and scanned, so only its tracks are copied. The linked notes are not built here,
+	 * they are copied from the source or built from the tracks on the first edit or handle request.
+	 */
 	void InitializeFromMidiFile(UMidiFile* SourceFile);
 
+	/**
+	 * Loads a Standard MIDI File from disk at runtime, without going through the asset import.
+	 * The linked notes are built in the same pass that reads the events.
+	 * @return False if the file could not be read, the file is left unchanged then
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	bool InitializeFromStandardMidiFile(const FString& FilePath);
+
+	/** Resets this file to a conductor track with a single tempo and time signature and no notes */
+	void InitializeEmpty(float TempoBPM = 120.0f, int32 TimeSigNumerator = 4, int32 TimeSigDenominator = 4);
+
+	/**
+	 * Appends an empty track to the MIDI file.
+	 * @return Index of the new track in the linked MIDI data, to be used as FNotesEditCallbackData::TrackIndex
+	 */
+	int32 AddNotesTrack(const FString& TrackName, int32 Channel);
+
 	/** 
 	 * Batch modify notes in the MIDI file.
-	 * Handles additions, modifications, and deletions efficiently.
+	 * Handles additions, modifications, and deletions efficiently. The edited tracks are sorted by NoteOnTick again
+	 * afterwards, GetNoteIndexAfterLastEdit maps note indices taken before the edit.
 	 * @param NotesEdits Array of edit operations to perform
 	 * @param OnNotesEditComplete Optional callback executed after all edits complete
 	 */
 	void ModifyNotes(const TArray<FNotesEditCallbackData>& NotesEdits, FOnNotesEdit OnNotesEditComplete = FOnNotesEdit());
 
-	/** Get the linked MIDI data for reading */
-	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> GetLinkedMidiData() const { return LinkedMidiData; }
+	/**
+	 * Applies an affine tick/pitch/velocity transform to a set of notes.
+	 * Their events are rewritten in one pass per track, notes moved past others change index, see GetNoteIndexAfterLastEdit.
+	 */
+	void TransformNotes(TConstArrayView<struct FMidiNoteId> NoteIds, const struct FMidiNoteTransform& Transform);
+
+	/** Quantizes and humanizes a set of notes, committed as a single ModifyNotes batch */
+	void QuantizeNotes(TConstArrayView<struct FMidiNoteId> NoteIds, const FMidiQuantizeSettings& Settings);
+
+	/** Quantizes and humanizes every note of a track in the linked MIDI data */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	void QuantizeTrack(int32 TrackIndex, const FMidiQuantizeSettings& Settings);
+
+	/**
+	 * Where a note ended up after the last change to this file. Edits keep every track sorted by NoteOnTick, so
+	 * moved, added and deleted notes shift the indices of other notes in their track.
+	 * @return The note's index now, INDEX_NONE if it was deleted or the last change replaced the notes, e.g. a reload
+	 */
+	int32 GetNoteIndexAfterLastEdit(int32 TrackIndex, int32 NoteIndex) const;
+
+	/**
+	 * Get the linked MIDI data only if it is already built and current, null if it was not built yet or is stale after
+	 * the data was reloaded. Use GetOrBuildLinkedMidiData unless building is not an option, e.g. in const code.
+	 */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> GetLinkedMidiDataIfCurrent() const { return LinkedMidiDataVersion == ContentVersion ? LinkedMidiData : nullptr; }
+
+	/** Get the linked MIDI data, building it first if it is missing or stale */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> GetOrBuildLinkedMidiData()
+	{
+		EnsureLinkedMidiData();
+		return LinkedMidiData;
+	}
+
+	/**
+	 * Publisher of immutable snapshots of the linked notes. Readers on any thread call Acquire() to get a consistent
+	 * version without locks while edits continue on the game thread. Each edit publishes a new snapshot that shares
+	 * the tracks it did not touch with the previous one. Snapshots are published from the first call on.
+	 */
+	TSharedRef<FMidiNotesSnapshotPublisher, ESPMode::ThreadSafe> GetSnapshotPublisher();
+
+	/**
+	 * Version of the MIDI data, increases with every edit, initialization and load of this file.
+	 * Caches built from the file can key on the file and this version instead of comparing contents.
+	 */
+	uint32 GetContentVersion() const { return ContentVersion; }
+
+	/** Get a Blueprint handle sharing the linked MIDI data, it reflects later edits to this file */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	class UMidiNotesDataHandle* GetLinkedMidiDataHandle();
 
 	/**
 	 * Save this MIDI file as a new asset.
@@ -65,5 +197,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MIDI")
 	UMidiFile* SaveAsAsset(const FString& PackagePath, const FString& AssetName);
 
+	/**
+	 * Save this MIDI file as a new asset without waiting for the disk.
+	 * The data is copied into the new asset before this returns, so edits made while the save is in flight are not
+	 * part of it. The file write happens on background threads and OnSaved is called on the game thread once it lands.
+	 */
+	void SaveAsAssetAsync(const FString& PackagePath, const FString& AssetName, FOnMidiFileSaved OnSaved);
+
+	/**
+	 * Writes this file to disk as a Standard MIDI File, without creating an asset.
+	 * @return False if the file could not be written
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	bool ExportToStandardMidiFile(const FString& FilePath, EMidiFileExportFormat Format = EMidiFileExportFormat::MultiTrack) const;
+
+	/** Writes this file as a Standard MIDI File to any saving archive, e.g. a memory writer */
+	bool ExportToArchive(FArchive& Ar, EMidiFileExportFormat Format = EMidiFileExportFormat::MultiTrack) const;
+
 	FOnMutableMidiFileChanged OnMutableMidiFileChanged;
 };
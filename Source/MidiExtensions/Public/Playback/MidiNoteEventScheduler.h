@@ -0,0 +1,133 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularQueue.h"
+#include "MidiFile/MidiNotesData.h"
+#include "Playback/MidiPlaybackClock.h"
+#include "MidiNoteEventScheduler.generated.h"
+
+class FSongMaps;
+
+/** A note start or end produced by FMidiNoteEventScheduler */
+USTRUCT(BlueprintType)
+struct MIDIEXTENSIONS_API FMidiNoteEvent
+{
+	GENERATED_BODY()
+
+	/** Index of the track in the linked notes data */
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	int32 TrackIndex = INDEX_NONE;
+
+	/** Index of the note within its track */
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	int32 NoteIndex = INDEX_NONE;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	int32 NoteNumber = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	int32 Velocity = 0;
+
+	/** The tick of the note-on or note-off */
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	int32 Tick = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	bool bIsNoteOn = true;
+
+	/** Song position of the event in milliseconds */
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	double SongTimeMs = 0.0;
+
+	/** Audio device clock time in seconds at which the event sounds, can be ahead of now by the lookahead */
+	UPROPERTY(BlueprintReadOnly, Category = "MIDI")
+	double AudioTimeSeconds = 0.0;
+};
+
+/**
+ * Walks linked notes in lockstep with an audio clock and hands note-on/off events to the game thread.
+ * The notes of each track must be sorted by NoteOnTick, as FMidiNotesData builds and UMutableMidiFile edits keep them.
+ * 
+ * The producer side (ProcessAudioBlock) runs on a single thread, normally the audio render thread, and
+ * pushes into a lock-free single producer single consumer ring. The consumer side (Drain) runs on the game thread.
+ * Start, Stop and SetLookaheadMs are safe to call from the game thread while the producer runs.
+ */
+class MIDIEXTENSIONS_API FMidiNoteEventScheduler
+{
+public:
+	FMidiNoteEventScheduler(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InNotesData, TSharedPtr<const FSongMaps, ESPMode::ThreadSafe> InSongMaps, uint32 RingCapacity = 4096);
+
+	/** Requests playback from StartSongMs, anchored to the audio clock of the next processed block */
+	void Start(double StartSongMs);
+
+	/** Stops producing events, events already in the ring can still be drained */
+	void Stop();
+
+	/** Publishes the song position of every processed block to the clock, set before the producer starts running */
+	void SetPlaybackClock(TSharedPtr<FMidiPlaybackClock, ESPMode::ThreadSafe> InPlaybackClock) { PlaybackClock = MoveTemp(InPlaybackClock); }
+
+	/** Events are produced this far ahead of the audio clock so gameplay can prepare for them */
+	void SetLookaheadMs(double InLookaheadMs) { LookaheadMs.store(FMath::Max(0.0, InLookaheadMs), std::memory_order_relaxed); }
+
+	/** Producer side: advances the schedule to the end of an audio block starting at AudioClockSeconds */
+	void ProcessAudioBlock(double AudioClockSeconds, double BlockDurationSeconds);
+
+	/** Consumer side: hands all pending events to Callback in time order, returns the number of events drained */
+	int32 Drain(TFunctionRef<void(const FMidiNoteEvent&)> Callback);
+
+	/** Audio clock of the last processed block */
+	double GetLastAudioClockSeconds() const { return LastAudioClockSeconds.load(std::memory_order_relaxed); }
+
+	/** Number of events dropped because the ring was full */
+	uint32 GetNumDroppedEvents() const { return NumDroppedEvents.load(std::memory_order_relaxed); }
+
+	bool IsRunning() const { return bIsRunning.load(std::memory_order_relaxed); }
+
+private:
+	struct FPendingNoteOff
+	{
+		int32 Tick;
+		int32 TrackIndex;
+		int32 NoteIndex;
+
+		bool operator<(const FPendingNoteOff& Other) const
+		{
+			return Tick < Other.Tick || (Tick == Other.Tick && TrackIndex < Other.TrackIndex);
+		}
+	};
+
+	/** Most notes sounding at the same tick, the bound on PendingNoteOffs */
+	static int32 GetMaxPolyphony(const FMidiNotesData& InNotesData);
+
+	void Push(const FMidiNoteEvent& Event);
+	FMidiNoteEvent MakeEvent(int32 TrackIndex, int32 NoteIndex, bool bIsNoteOn) const;
+
+	TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> NotesData;
+	TSharedPtr<const FSongMaps, ESPMode::ThreadSafe> SongMaps;
+
+	TCircularQueue<FMidiNoteEvent> Ring;
+
+	TSharedPtr<FMidiPlaybackClock, ESPMode::ThreadSafe> PlaybackClock;
+
+	// Game thread -> producer requests
+	std::atomic<bool> bStartRequested = false;
+	std::atomic<bool> bStopRequested = false;
+	std::atomic<double> RequestedStartSongMs = 0.0;
+	std::atomic<double> LookaheadMs = 50.0;
+
+	// Producer -> game thread state
+	std::atomic<bool> bIsRunning = false;
+	std::atomic<double> LastAudioClockSeconds = 0.0;
+	std::atomic<uint32> NumDroppedEvents = 0;
+
+	// Producer only state
+	FMidiFileIterator NoteOnCursor;
+	/** Min-heap of note-offs still to come, reserved for the notes' polyphony so pushing never allocates */
+	TArray<FPendingNoteOff> PendingNoteOffs;
+	double AnchorAudioClockSeconds = 0.0;
+	double AnchorSongMs = 0.0;
+	double PublishedSongMs = 0.0;
+	int32 ScheduledUpToTick = 0;
+};
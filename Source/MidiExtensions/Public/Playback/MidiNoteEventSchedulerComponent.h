@@ -0,0 +1,105 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Playback/MidiNoteEventScheduler.h"
+#include "MidiNoteEventSchedulerComponent.generated.h"
+
+class UMidiFile;
+class FMidiNoteEventSubmixListener;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMidiNoteEventMulticast, const FMidiNoteEvent&, Event);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnMidiNoteEvent, const FMidiNoteEvent&, Event);
+
+/**
+ * Schedules the notes of a midi file against the audio device clock and delivers them on the game thread.
+ * Events are produced on the audio render thread in lockstep with the main submix and drained every tick,
+ * each carrying the audio clock time it sounds at. Start it together with the Harmonix player of the same file
+ * to follow the music, use LookaheadMs to receive events early enough to prepare gameplay for them.
+ *
+ * The song position runs from StartSongMs at real time against the audio device clock, converted to ticks with the
+ * file's tempo map, so tempo changes written in the file are followed. It does not follow a Harmonix player's clock:
+ * seeking, pausing or changing the speed of the player is not seen here. Call StopScheduling when pausing and
+ * StartScheduling with the player's position after a seek or resume to stay in sync.
+ */
+UCLASS(ClassGroup = (Audio), meta = (BlueprintSpawnableComponent))
+class MIDIEXTENSIONS_API UMidiNoteEventSchedulerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMidiNoteEventSchedulerComponent();
+
+	/** The midi file to schedule, a snapshot of its notes is taken when scheduling starts */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI")
+	TObjectPtr<UMidiFile> MidiFile;
+
+	/** How far ahead of the audio clock events are delivered */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, BlueprintSetter = SetLookaheadMs, Category = "MIDI", meta = (ClampMin = "0", Units = "ms"))
+	float LookaheadMs = 50.f;
+
+	/** Capacity of the audio to game thread event ring, events beyond it are dropped */
+	UPROPERTY(EditAnywhere, Category = "MIDI", AdvancedDisplay, meta = (ClampMin = "16"))
+	int32 EventRingCapacity = 4096;
+
+	UPROPERTY(BlueprintAssignable, Category = "MIDI")
+	FOnMidiNoteEventMulticast OnNoteOn;
+
+	UPROPERTY(BlueprintAssignable, Category = "MIDI")
+	FOnMidiNoteEventMulticast OnNoteOff;
+
+	/** Starts scheduling from StartSongMs, anchored to the next audio buffer. Call again to seek, see the class comment */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	void StartScheduling(float StartSongMs = 0.f);
+
+	/** Stops scheduling, note-offs for sounding notes are still delivered */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	void StopScheduling();
+
+	UFUNCTION(BlueprintPure, Category = "MIDI")
+	bool IsScheduling() const;
+
+	UFUNCTION(BlueprintSetter)
+	void SetLookaheadMs(float InLookaheadMs);
+
+	/** Calls Delegate for every note-on and note-off of the given track */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	void SubscribeToTrack(int32 TrackIndex, FOnMidiNoteEvent Delegate);
+
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	void UnsubscribeFromTrack(int32 TrackIndex, FOnMidiNoteEvent Delegate);
+
+	/** Audio clock of the last buffer rendered, compare against FMidiNoteEvent::AudioTimeSeconds */
+	UFUNCTION(BlueprintPure, Category = "MIDI")
+	double GetAudioClockSeconds() const;
+
+	/** Song position of the scheduled playback, interpolated between audio buffers */
+	UFUNCTION(BlueprintPure, Category = "MIDI")
+	double GetPlaybackPositionMs() const;
+
+	TSharedPtr<FMidiNoteEventScheduler, ESPMode::ThreadSafe> GetScheduler() const { return Scheduler; }
+
+	/** Clock published from the audio thread, stays valid across StartScheduling calls so readers can hold on to it */
+	TSharedRef<FMidiPlaybackClock, ESPMode::ThreadSafe> GetPlaybackClock() const { return PlaybackClock; }
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	struct FTrackSubscription
+	{
+		int32 TrackIndex;
+		FOnMidiNoteEvent Delegate;
+	};
+
+	void RegisterListener();
+	void UnregisterListener();
+	void DispatchEvent(const FMidiNoteEvent& Event);
+
+	TSharedPtr<FMidiNoteEventScheduler, ESPMode::ThreadSafe> Scheduler;
+	TSharedRef<FMidiPlaybackClock, ESPMode::ThreadSafe> PlaybackClock;
+	TSharedPtr<FMidiNoteEventSubmixListener, ESPMode::ThreadSafe> SubmixListener;
+	TArray<FTrackSubscription> TrackSubscriptions;
+};
@@ -0,0 +1,58 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/** A consistent copy of the playback state, as last published by the clock's producer */
+struct FMidiPlaybackClockSnapshot
+{
+	/** Song position at the time of the publish */
+	double SongPositionMs = 0.0;
+
+	/** FPlatformTime::Seconds() at the time of the publish */
+	double PublishedAtSeconds = 0.0;
+
+	float PlaybackRate = 1.0f;
+
+	bool bIsPlaying = false;
+};
+
+/**
+ * Playback position shared between an audio thread producer and any number of readers, e.g. UI widgets.
+ * 
+ * The producer publishes once per audio buffer, readers extrapolate from the last publish with the platform clock so
+ * the position advances smoothly between buffers. Publishing never blocks or allocates, readers retry the copy only
+ * if they race a publish (sequence lock).
+ */
+class MIDIEXTENSIONS_API FMidiPlaybackClock
+{
+public:
+	/** Producer side, a single thread at a time */
+	void Publish(double SongPositionMs, bool bIsPlaying, float PlaybackRate = 1.0f);
+
+	FMidiPlaybackClockSnapshot Read() const;
+
+	/**
+	 * Song position at NowSeconds, extrapolated from the last publish while playing.
+	 * Extrapolation is capped so a stalled producer does not run the position away.
+	 */
+	double GetSongPositionMs(double NowSeconds) const;
+
+	double GetSongPositionMs() const { return GetSongPositionMs(FPlatformTime::Seconds()); }
+
+	bool IsPlaying() const { return Read().bIsPlaying; }
+
+	/** The longest a position is extrapolated past the last publish */
+	static constexpr double MaxExtrapolationSeconds = 0.1;
+
+private:
+	/** Odd while a publish is in flight */
+	std::atomic<uint32> Sequence = 0;
+
+	std::atomic<double> SongPositionMs = 0.0;
+	std::atomic<double> PublishedAtSeconds = 0.0;
+	std::atomic<float> PlaybackRate = 1.0f;
+	std::atomic<bool> bIsPlaying = false;
+};
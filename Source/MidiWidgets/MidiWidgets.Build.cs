@@ -40,7 +40,8 @@ public class MidiWidgets : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
-                "InputCore"
+                "InputCore",
+				"SlateNullRenderer"
             }
 			);
 		
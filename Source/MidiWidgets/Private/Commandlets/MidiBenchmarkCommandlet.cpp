@@ -0,0 +1,457 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "Commandlets/MidiBenchmarkCommandlet.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiFile/MidiNoteQueryIndex.h"
+#include "MidiFile/MidiNoteTransform.h"
+#include "MidiFile/MidiQuantize.h"
+#include "MidiFile/MutableMidiFile.h"
+#include "MidiFile/MidiFileStreamReader.h"
+#include "MidiFile/MidiPackedNotes.h"
+#include "Serialization/MemoryWriter.h"
+#include "SMidiPianoroll.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Interfaces/ISlateNullRendererModule.h"
+#include "Modules/ModuleManager.h"
+#include "Input/HittestGrid.h"
+#include "Rendering/DrawElements.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+	TArray<int32> ParseIntList(const FString& Params, const TCHAR* Key, const TArray<int32>& Defaults)
+	{
+		FString Value;
+		if (!FParse::Value(*Params, Key, Value, false))
+		{
+			return Defaults;
+		}
+
+		TArray<FString> Parts;
+		Value.ParseIntoArray(Parts, TEXT(","));
+
+		TArray<int32> Result;
+		for (const FString& Part : Parts)
+		{
+			Result.Add(FCString::Atoi(*Part));
+		}
+		return Result;
+	}
+
+	/** Picks Count distinct note indices spread across the linked tracks */
+	TArray<FNotesEditCallbackData> MakeEdits(const FMidiNotesData& NotesData, int32 Count, FRandomStream& Random, bool bDelete, int32 DeltaTicks, int32 DeltaNotes)
+	{
+		TArray<FNotesEditCallbackData> Edits;
+		Edits.Reserve(Count);
+
+		TSet<TPair<int32, int32>> Picked;
+		for (int32 Attempt = 0; Edits.Num() < Count && Attempt < Count * 4; ++Attempt)
+		{
+			const int32 TrackIndex = Random.RandHelper(NotesData.Tracks.Num());
+			const FMidiNotesTrack& Track = NotesData.Tracks[TrackIndex];
+			if (Track.Notes.IsEmpty())
+			{
+				continue;
+			}
+
+			const int32 NoteIndex = Random.RandHelper(Track.Notes.Num());
+			bool bAlreadyPicked = false;
+			Picked.Add(TPair<int32, int32>(TrackIndex, NoteIndex), &bAlreadyPicked);
+			if (bAlreadyPicked)
+			{
+				continue;
+			}
+
+			FNotesEditCallbackData Edit;
+			Edit.TrackIndex = TrackIndex;
+			Edit.NoteIndex = NoteIndex;
+			Edit.NoteData = Track.Notes[NoteIndex];
+			Edit.NoteData.NoteOnTick = FMath::Max(0, Edit.NoteData.NoteOnTick + DeltaTicks);
+			Edit.NoteData.NoteOffTick = FMath::Max(Edit.NoteData.NoteOnTick + 1, Edit.NoteData.NoteOffTick + DeltaTicks);
+			Edit.NoteData.NoteNumber = FMath::Clamp(Edit.NoteData.NoteNumber + DeltaNotes, 0, 127);
+			Edit.bDelete = bDelete;
+			Edits.Add(Edit);
+		}
+
+		return Edits;
+	}
+
+	/** Random (track, tick) pairs spread over the song for the query scenarios */
+	TArray<TPair<int32, int32>> MakeQueries(const FMidiNotesData& NotesData, int32 Count, FRandomStream& Random)
+	{
+		TArray<TPair<int32, int32>> Queries;
+		Queries.Reserve(Count);
+		for (int32 QueryIdx = 0; QueryIdx < Count; ++QueryIdx)
+		{
+			Queries.Emplace(Random.RandHelper(NotesData.Tracks.Num()), Random.RandRange(0, NotesData.LastNoteOffTick));
+		}
+		return Queries;
+	}
+}
+
+UMidiBenchmarkCommandlet::UMidiBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+UMutableMidiFile* UMidiBenchmarkCommandlet::CreateSyntheticMidiFile(int32 NumNotes, int32 NumTracks, int32 Seed)
+{
+	UMutableMidiFile* MidiFile = NewObject<UMutableMidiFile>(GetTransientPackage());
+	MidiFile->InitializeEmpty();
+
+	NumTracks = FMath::Clamp(NumTracks, 1, 128);
+	FRandomStream Random(Seed);
+
+	TArray<FNotesEditCallbackData> Additions;
+	Additions.Reserve(NumNotes);
+
+	const int32 NotesPerTrack = FMath::DivideAndRoundUp(NumNotes, NumTracks);
+	for (int32 TrackIdx = 0; TrackIdx < NumTracks; ++TrackIdx)
+	{
+		const int32 LinkedTrackIndex = MidiFile->AddNotesTrack(FString::Printf(TEXT("Synthetic %d"), TrackIdx), TrackIdx % 16);
+
+		// Roughly a sixteenth note apart with some overlap, so density resembles a busy real take
+		int32 Tick = Random.RandRange(0, 120);
+		const int32 NotesInTrack = FMath::Min(NotesPerTrack, NumNotes - Additions.Num());
+		for (int32 NoteIdx = 0; NoteIdx < NotesInTrack; ++NoteIdx)
+		{
+			FNotesEditCallbackData Edit;
+			Edit.TrackIndex = LinkedTrackIndex;
+			Edit.NoteIndex = INDEX_NONE;
+			Edit.NoteData.NoteOnTick = Tick;
+			Edit.NoteData.NoteOffTick = Tick + Random.RandRange(30, 960);
+			Edit.NoteData.NoteNumber = (int8)Random.RandRange(24, 108);
+			Edit.NoteData.Velocity = (int8)Random.RandRange(20, 127);
+			Additions.Add(Edit);
+
+			Tick += Random.RandRange(0, 240);
+		}
+	}
+
+	MidiFile->ModifyNotes(Additions);
+	return MidiFile;
+}
+
+void UMidiBenchmarkCommandlet::RunBenchmark(const FString& Scenario, int32 NumNotes, int32 NumTracks, int32 Iterations, TFunctionRef<void()> Setup, TFunctionRef<void()> Body)
+{
+	FBenchmarkResult Result;
+	Result.Scenario = Scenario;
+	Result.NumNotes = NumNotes;
+	Result.NumTracks = NumTracks;
+	Result.Iterations = Iterations;
+	Result.MinMs = TNumericLimits<double>::Max();
+
+	double TotalMs = 0.0;
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		Setup();
+
+		const double StartTime = FPlatformTime::Seconds();
+		Body();
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		TotalMs += ElapsedMs;
+		Result.MinMs = FMath::Min(Result.MinMs, ElapsedMs);
+		Result.MaxMs = FMath::Max(Result.MaxMs, ElapsedMs);
+	}
+	Result.MeanMs = Iterations > 0 ? TotalMs / Iterations : 0.0;
+
+	UE_LOG(LogTemp, Display, TEXT("%-24s notes=%-8d tracks=%-4d mean=%10.3fms min=%10.3fms max=%10.3fms"),
+		*Scenario, NumNotes, NumTracks, Result.MeanMs, Result.MinMs, Result.MaxMs);
+
+	Results.Add(MoveTemp(Result));
+}
+
+int32 UMidiBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TArray<int32> NoteCounts = ParseIntList(Params, TEXT("Notes="), { 1000, 10000, 100000, 1000000 });
+	const TArray<int32> TrackCounts = ParseIntList(Params, TEXT("Tracks="), { 1, 16, 128 });
+
+	int32 Iterations = 5;
+	int32 MaxEdits = 1000;
+	int32 Seed = 1234;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Edits="), MaxEdits);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	Iterations = FMath::Max(1, Iterations);
+
+	FString OutputPath;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+	{
+		OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("MidiBenchmark_%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	// The offscreen paint pass needs Slate's renderer-independent services, commandlets don't bring Slate up on their own
+	const bool bCreatedSlate = !FSlateApplication::IsInitialized() && InitializeOffscreenSlate();
+	const bool bCanPaint = FSlateApplication::IsInitialized();
+	if (!bCanPaint)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("MidiBenchmark: Slate could not be initialized, the piano roll paint benchmark is reported as skipped"));
+	}
+
+	for (const int32 NumNotes : NoteCounts)
+	{
+		for (const int32 NumTracks : TrackCounts)
+		{
+			UMutableMidiFile* MidiFile = CreateSyntheticMidiFile(NumNotes, NumTracks, Seed);
+			MidiFile->AddToRoot();
+
+			RunBenchmark(TEXT("BuildFromMidiFile"), NumNotes, NumTracks, Iterations, [] {}, [MidiFile]
+			{
+				TSharedPtr<FMidiNotesData> NotesData = FMidiNotesData::BuildFromMidiFile(MidiFile);
+			});
+
+			const int32 NumEdits = FMath::Clamp(NumNotes / 100, 1, MaxEdits);
+			FRandomStream Random(Seed);
+
+			// Query index against the linear scans it replaces, each iteration answers NumQueries random queries
+			{
+				constexpr int32 NumQueries = 1000;
+				const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData = MidiFile->GetOrBuildLinkedMidiData();
+				const TArray<TPair<int32, int32>> Queries = MakeQueries(*NotesData, NumQueries, Random);
+				TSharedPtr<FMidiNoteQueryIndex, ESPMode::ThreadSafe> QueryIndex;
+				TArray<int32> ActiveNotes;
+				volatile int32 Sink = 0;
+
+				RunBenchmark(TEXT("QueryIndex.Build"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					QueryIndex = FMidiNoteQueryIndex::Build(NotesData);
+				});
+
+				RunBenchmark(TEXT("Query.ActiveAtTick.Index"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					for (const TPair<int32, int32>& Query : Queries)
+					{
+						ActiveNotes.Reset();
+						QueryIndex->GetNotesActiveAtTick(Query.Key, Query.Value, ActiveNotes);
+						Sink = Sink + ActiveNotes.Num();
+					}
+				});
+
+				RunBenchmark(TEXT("Query.ActiveAtTick.Linear"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					for (const TPair<int32, int32>& Query : Queries)
+					{
+						ActiveNotes.Reset();
+						const TArray<FLinkedMidiNote>& Notes = NotesData->Tracks[Query.Key].Notes;
+						for (int32 NoteIndex = 0; NoteIndex < Notes.Num(); ++NoteIndex)
+						{
+							if (Notes[NoteIndex].NoteOnTick <= Query.Value && Query.Value < Notes[NoteIndex].NoteOffTick)
+							{
+								ActiveNotes.Add(NoteIndex);
+							}
+						}
+						Sink = Sink + ActiveNotes.Num();
+					}
+				});
+
+				RunBenchmark(TEXT("Query.NextOnset.Index"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					for (const TPair<int32, int32>& Query : Queries)
+					{
+						Sink = Sink + QueryIndex->FindNextNoteOnset(Query.Key, Query.Value);
+					}
+				});
+
+				RunBenchmark(TEXT("Query.NextOnset.Linear"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					for (const TPair<int32, int32>& Query : Queries)
+					{
+						const TArray<FLinkedMidiNote>& Notes = NotesData->Tracks[Query.Key].Notes;
+						int32 NextNoteIndex = INDEX_NONE;
+						for (int32 NoteIndex = 0; NoteIndex < Notes.Num(); ++NoteIndex)
+						{
+							if (Notes[NoteIndex].NoteOnTick > Query.Value && (NextNoteIndex == INDEX_NONE || Notes[NoteIndex].NoteOnTick < Notes[NextNoteIndex].NoteOnTick))
+							{
+								NextNoteIndex = NoteIndex;
+							}
+						}
+						Sink = Sink + NextNoteIndex;
+					}
+				});
+			}
+			TArray<FNotesEditCallbackData> Edits;
+
+			RunBenchmark(TEXT("ModifyNotes.Add"), NumNotes, NumTracks, Iterations, [&]
+			{
+				Edits = MakeEdits(*MidiFile->GetOrBuildLinkedMidiData(), NumEdits, Random, false, 0, 0);
+				for (FNotesEditCallbackData& Edit : Edits)
+				{
+					Edit.NoteIndex = INDEX_NONE;
+				}
+			}, [&] { MidiFile->ModifyNotes(Edits); });
+
+			RunBenchmark(TEXT("ModifyNotes.Move"), NumNotes, NumTracks, Iterations, [&]
+			{
+				Edits = MakeEdits(*MidiFile->GetOrBuildLinkedMidiData(), NumEdits, Random, false, 120, 1);
+			}, [&] { MidiFile->ModifyNotes(Edits); });
+
+			RunBenchmark(TEXT("ModifyNotes.Delete"), NumNotes, NumTracks, Iterations, [&]
+			{
+				Edits = MakeEdits(*MidiFile->GetOrBuildLinkedMidiData(), NumEdits, Random, true, 0, 0);
+			}, [&] { MidiFile->ModifyNotes(Edits); });
+
+			RunBenchmark(TEXT("Quantize.AllTracks"), NumNotes, NumTracks, Iterations, [] {}, [&]
+			{
+				FMidiQuantizeSettings Settings;
+				Settings.Strength = 0.8f;
+				Settings.Swing = 0.2f;
+				Settings.HumanizeTicks = 10;
+				Settings.Seed = Seed;
+
+				TArray<FMidiNoteId> NoteIds;
+				const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData = MidiFile->GetOrBuildLinkedMidiData();
+				for (int32 TrackIndex = 0; TrackIndex < NotesData->Tracks.Num(); ++TrackIndex)
+				{
+					NoteIds.Append(FMidiQuantizer::GetTrackNoteIds(*NotesData, TrackIndex));
+				}
+				MidiFile->QuantizeNotes(NoteIds, Settings);
+			});
+
+			// Packed notes against the plain arrays, each iteration decodes every note once
+			{
+				const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData = MidiFile->GetOrBuildLinkedMidiData();
+				FMidiPackedNotes PackedNotes;
+				volatile int32 Sink = 0;
+
+				RunBenchmark(TEXT("Packed.Encode"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					PackedNotes = FMidiPackedNotes::Pack(*NotesData);
+				});
+
+				RunBenchmark(TEXT("Packed.Iterate"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					int32 TickSum = 0;
+					for (int32 TrackIndex = 0; TrackIndex < PackedNotes.GetTracks().Num(); ++TrackIndex)
+					{
+						PackedNotes.ForEachNote(TrackIndex, [&TickSum](const FLinkedMidiNote& Note) { TickSum += Note.NoteOnTick; });
+					}
+					Sink = Sink + TickSum;
+				});
+
+				RunBenchmark(TEXT("Plain.Iterate"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					int32 TickSum = 0;
+					for (const FMidiNotesTrack& Track : NotesData->Tracks)
+					{
+						for (const FLinkedMidiNote& Note : Track.Notes)
+						{
+							TickSum += Note.NoteOnTick;
+						}
+					}
+					Sink = Sink + TickSum;
+				});
+
+				UE_LOG(LogTemp, Display, TEXT("MidiBenchmark: %d notes in %d tracks pack into %llu bytes, %llu bytes as plain arrays"),
+					NumNotes, NumTracks, static_cast<uint64>(PackedNotes.GetAllocatedSize()), static_cast<uint64>(PackedNotes.GetUnpackedSize()));
+			}
+
+			TArray<uint8> SmfBytes;
+			RunBenchmark(TEXT("Smf.Write"), NumNotes, NumTracks, Iterations, [&] { SmfBytes.Reset(); }, [&]
+			{
+				FMemoryWriter Writer(SmfBytes);
+				MidiFile->ExportToArchive(Writer);
+			});
+
+			RunBenchmark(TEXT("Smf.Read"), NumNotes, NumTracks, Iterations, [] {}, [&]
+			{
+				FMidiFileStreamResult ReadResult;
+				FMidiFileStreamReader::ReadMemory(SmfBytes, ReadResult);
+			});
+
+			if (bCanPaint)
+			{
+				const FMidiFileVisualizationData VisualizationData = FMidiFileVisualizationData::BuildFromLinkedMidiData(*MidiFile->GetOrBuildLinkedMidiData());
+				TSharedPtr<FSongMaps, ESPMode::ThreadSafe> SongsMap = MakeShared<FSongMaps, ESPMode::ThreadSafe>(*MidiFile->GetSongMaps());
+
+				TSharedRef<SMidiPianoroll> Pianoroll = SNew(SMidiPianoroll)
+					.LinkedMidiData(MidiFile->GetOrBuildLinkedMidiData())
+					.LinkedSongsMap(SongsMap)
+					.VisualizationData(&VisualizationData)
+					.TimeMode(EMidiTrackTimeMode::TimeLinear)
+					.GridPointType(EPianorollGridPointType::Subdivision);
+
+				const FVector2D ViewportSize(1920.0f, 1080.0f);
+				const FGeometry Geometry = FGeometry::MakeRoot(ViewportSize, FSlateLayoutTransform());
+				const FSlateRect CullingRect(FVector2D::ZeroVector, ViewportSize);
+				FHittestGrid HittestGrid;
+				const FPaintArgs PaintArgs(nullptr, HittestGrid, FVector2D::ZeroVector, FPlatformTime::Seconds(), 0.016f);
+
+				RunBenchmark(TEXT("Pianoroll.Paint"), NumNotes, NumTracks, Iterations, [] {}, [&]
+				{
+					FSlateWindowElementList ElementList(nullptr);
+					Pianoroll->OnPaint(PaintArgs, Geometry, CullingRect, ElementList, 0, FWidgetStyle(), true);
+				});
+			}
+			else
+			{
+				AddSkipped(TEXT("Pianoroll.Paint"), NumNotes, NumTracks, TEXT("Slate not initialized"));
+			}
+
+			MidiFile->RemoveFromRoot();
+			CollectGarbage(RF_NoFlags);
+		}
+	}
+
+	if (bCreatedSlate)
+	{
+		FSlateApplication::Shutdown();
+	}
+
+	return WriteResults(OutputPath) ? 0 : 1;
+}
+
+bool UMidiBenchmarkCommandlet::InitializeOffscreenSlate()
+{
+	// The null renderer measures text and collects draw elements without a RHI, which is all the paint pass needs
+	ISlateNullRendererModule* NullRendererModule = FModuleManager::LoadModulePtr<ISlateNullRendererModule>(TEXT("SlateNullRenderer"));
+	if (!NullRendererModule)
+	{
+		return false;
+	}
+
+	FSlateApplication::Create();
+	if (!FSlateApplication::Get().InitializeRenderer(NullRendererModule->CreateSlateNullRenderer(), true))
+	{
+		FSlateApplication::Shutdown();
+		return false;
+	}
+	return true;
+}
+
+void UMidiBenchmarkCommandlet::AddSkipped(const FString& Scenario, int32 NumNotes, int32 NumTracks, const FString& Reason)
+{
+	UE_LOG(LogTemp, Display, TEXT("%-24s notes=%-8d tracks=%-4d skipped: %s"), *Scenario, NumNotes, NumTracks, *Reason);
+
+	FBenchmarkResult Result;
+	Result.Scenario = Scenario;
+	Result.NumNotes = NumNotes;
+	Result.NumTracks = NumTracks;
+	Result.SkipReason = Reason;
+	Results.Add(MoveTemp(Result));
+}
+
+bool UMidiBenchmarkCommandlet::WriteResults(const FString& OutputPath) const
+{
+	FString Csv = TEXT("Scenario,Notes,Tracks,Iterations,MeanMs,MinMs,MaxMs,Skipped\n");
+	for (const FBenchmarkResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%.4f,%.4f,%.4f,%s\n"),
+			*Result.Scenario, Result.NumNotes, Result.NumTracks, Result.Iterations, Result.MeanMs, Result.MinMs, Result.MaxMs, *Result.SkipReason);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("MidiBenchmark: Failed to write results to '%s'"), *OutputPath);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("MidiBenchmark: Wrote %d results to '%s'"), Results.Num(), *OutputPath);
+	return true;
+}
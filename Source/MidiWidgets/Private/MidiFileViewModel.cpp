@@ -0,0 +1,233 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiFileViewModel.h"
+#include "MidiFile/MutableMidiFile.h"
+#include "MidiFile/MidiNoteQueryIndex.h"
+#include "MidiFile/MidiNoteTransform.h"
+#include "MidiFile/MidiQuantize.h"
+#include "HarmonixMidi/MidiFile.h"
+#include "HarmonixMidi/SongMaps.h"
+
+TMap<TObjectKey<UMidiFile>, FMidiFileViewModel*> FMidiFileViewModel::Models;
+
+TSharedRef<FMidiFileViewModel> FMidiFileViewModel::Get(UMidiFile* MidiFile)
+{
+	check(IsInGameThread());
+
+	// Only live models are in the map, a model going away removes itself before its memory is released
+	if (FMidiFileViewModel* const* Existing = Models.Find(MidiFile))
+	{
+		return (*Existing)->AsShared();
+	}
+
+	TSharedRef<FMidiFileViewModel> Model = MakeShareable(new FMidiFileViewModel(MidiFile));
+	Models.Add(Model->ModelKey, &Model.Get());
+	return Model;
+}
+
+FMidiFileViewModel::FMidiFileViewModel(UMidiFile* InMidiFile)
+	: MidiFile(InMidiFile)
+	, ModelKey(InMidiFile)
+{
+	if (UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(InMidiFile))
+	{
+		FileChangedHandle = MutableFile->OnMutableMidiFileChanged.AddRaw(this, &FMidiFileViewModel::HandleFileChanged);
+	}
+}
+
+FMidiFileViewModel::~FMidiFileViewModel()
+{
+	if (UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(MidiFile.Get()))
+	{
+		MutableFile->OnMutableMidiFileChanged.Remove(FileChangedHandle);
+	}
+
+	Models.Remove(ModelKey);
+}
+
+TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> FMidiFileViewModel::GetNotesData()
+{
+	UMidiFile* File = MidiFile.Get();
+	if (UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(File))
+	{
+		// Edits happen on the file's own notes, sharing them keeps every view's note indices in sync with the file
+		NotesData = MutableFile->GetOrBuildLinkedMidiData();
+	}
+	else if (!NotesData.IsValid() && File)
+	{
+		NotesData = FMidiNotesData::BuildFromMidiFile(File);
+	}
+	return NotesData;
+}
+
+TSharedPtr<FSongMaps, ESPMode::ThreadSafe> FMidiFileViewModel::GetSongMaps()
+{
+	UMidiFile* File = MidiFile.Get();
+	const uint32 ContentVersion = GetContentVersion();
+	if (File && (!SongMaps.IsValid() || SongMapsVersion != ContentVersion))
+	{
+		SongMaps = MakeShared<FSongMaps, ESPMode::ThreadSafe>(*File->GetSongMaps());
+		SongMapsVersion = ContentVersion;
+	}
+	return SongMaps;
+}
+
+TSharedPtr<FMidiNoteQueryIndex, ESPMode::ThreadSafe> FMidiFileViewModel::GetQueryIndex()
+{
+	const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> CurrentNotes = GetNotesData();
+	if (CurrentNotes.IsValid() && (!QueryIndex.IsValid() || !QueryIndex->IsUpToDate() || QueryIndex->GetNotesData() != CurrentNotes))
+	{
+		QueryIndex = FMidiNoteQueryIndex::Build(CurrentNotes);
+	}
+	return QueryIndex;
+}
+
+TSharedPtr<const FMidiOverviewSummary, ESPMode::ThreadSafe> FMidiFileViewModel::GetOverviewSummary()
+{
+	const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> CurrentNotes = GetNotesData();
+	if (!CurrentNotes.IsValid())
+	{
+		return nullptr;
+	}
+
+	const uint32 ContentVersion = GetContentVersion();
+	if (!OverviewSummary.IsValid())
+	{
+		OverviewSummary = MakeShared<FMidiOverviewSummary, ESPMode::ThreadSafe>();
+		OverviewSummary->Build(*CurrentNotes);
+	}
+	else if (OverviewSummaryVersion != ContentVersion)
+	{
+		// Only an edit that moved the file on by exactly one version from the summary's is covered by the dirty ticks
+		const bool bIsSingleEdit = PendingSummaryDirtyTicks.IsSet() && PendingSummaryFromVersion == OverviewSummaryVersion && ContentVersion == OverviewSummaryVersion + 1;
+		if (bIsSingleEdit)
+		{
+			OverviewSummary->UpdateRange(*CurrentNotes, *PendingSummaryDirtyTicks);
+		}
+		else
+		{
+			OverviewSummary->Build(*CurrentNotes);
+		}
+	}
+
+	OverviewSummaryVersion = ContentVersion;
+	PendingSummaryDirtyTicks.Reset();
+	return OverviewSummary;
+}
+
+TOptional<FInt32Interval> FMidiFileViewModel::ModifyNotes(const TArray<FNotesEditCallbackData>& Edits)
+{
+	UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(MidiFile.Get());
+	if (!MutableFile || Edits.IsEmpty())
+	{
+		return TOptional<FInt32Interval>();
+	}
+
+	// The ticks the edits move notes from and to, covering whole notes since the summary tracks sounding notes
+	TOptional<FInt32Interval> DirtyTicks;
+	auto AddDirtyNote = [&DirtyTicks](const FLinkedMidiNote& Note)
+	{
+		const int32 StartTick = FMath::Min(Note.NoteOnTick, Note.NoteOffTick);
+		const int32 EndTick = FMath::Max(Note.NoteOnTick, Note.NoteOffTick);
+		DirtyTicks = DirtyTicks.IsSet() ? FInt32Interval(FMath::Min(DirtyTicks->Min, StartTick), FMath::Max(DirtyTicks->Max, EndTick)) : FInt32Interval(StartTick, EndTick);
+	};
+
+	const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> CurrentNotes = GetNotesData();
+	for (const FNotesEditCallbackData& Edit : Edits)
+	{
+		if (CurrentNotes.IsValid() && CurrentNotes->Tracks.IsValidIndex(Edit.TrackIndex) && CurrentNotes->Tracks[Edit.TrackIndex].Notes.IsValidIndex(Edit.NoteIndex))
+		{
+			AddDirtyNote(CurrentNotes->Tracks[Edit.TrackIndex].Notes[Edit.NoteIndex]);
+		}
+		if (!Edit.bDelete)
+		{
+			AddDirtyNote(Edit.NoteData);
+		}
+	}
+
+	BeginEdit(DirtyTicks, MutableFile->GetContentVersion());
+	MutableFile->ModifyNotes(Edits);
+	return DirtyTicks;
+}
+
+void FMidiFileViewModel::BeginEdit(const TOptional<FInt32Interval>& DirtyTicks, uint32 FromVersion)
+{
+	// Set before editing, the file notifies the views from inside the edit
+	PendingSummaryDirtyTicks = DirtyTicks;
+	PendingSummaryFromVersion = FromVersion;
+	LastEditDirtyTicks = DirtyTicks;
+	LastEditFromVersion = FromVersion;
+}
+
+TOptional<FInt32Interval> FMidiFileViewModel::TransformNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiNoteTransform& Transform)
+{
+	UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(MidiFile.Get());
+	const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> CurrentNotes = GetNotesData();
+	if (!MutableFile || !CurrentNotes.IsValid() || NoteIds.IsEmpty() || Transform.IsIdentity())
+	{
+		return TOptional<FInt32Interval>();
+	}
+
+	TOptional<FInt32Interval> OldTicks;
+	for (const FMidiNoteId& NoteId : NoteIds)
+	{
+		if (CurrentNotes->Tracks.IsValidIndex(NoteId.TrackIndex) && CurrentNotes->Tracks[NoteId.TrackIndex].Notes.IsValidIndex(NoteId.NoteIndex))
+		{
+			const FLinkedMidiNote& Note = CurrentNotes->Tracks[NoteId.TrackIndex].Notes[NoteId.NoteIndex];
+			OldTicks = OldTicks.IsSet() ? FInt32Interval(FMath::Min(OldTicks->Min, Note.NoteOnTick), FMath::Max(OldTicks->Max, Note.NoteOffTick)) : FInt32Interval(Note.NoteOnTick, Note.NoteOffTick);
+		}
+	}
+	if (!OldTicks.IsSet())
+	{
+		return TOptional<FInt32Interval>();
+	}
+
+	// The tick mapping is monotonic, so the transformed notes lie between the images of the old extents. A note-off can
+	// be pushed to one tick after its note-on, hence the extra tick at the end
+	auto TransformTick = [&Transform](int32 Tick)
+	{
+		FLinkedMidiNote Note;
+		Note.NoteOnTick = Tick;
+		Note.NoteOffTick = Tick + 1;
+		return Transform.Apply(Note).NoteOnTick;
+	};
+	const int32 NewFirstTick = TransformTick(OldTicks->Min);
+	const int32 NewLastTick = TransformTick(OldTicks->Max);
+	const FInt32Interval DirtyTicks(
+		FMath::Min3(OldTicks->Min, NewFirstTick, NewLastTick),
+		FMath::Max3(OldTicks->Max, NewFirstTick, NewLastTick) + 1);
+
+	// The file's bulk transform keeps its column kernel and one pass event rewrite, only the dirty ticks come from here
+	BeginEdit(DirtyTicks, MutableFile->GetContentVersion());
+	MutableFile->TransformNotes(NoteIds, Transform);
+	return DirtyTicks;
+}
+
+TOptional<FInt32Interval> FMidiFileViewModel::QuantizeNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiQuantizeSettings& Settings)
+{
+	UMidiFile* File = MidiFile.Get();
+	const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> CurrentNotes = GetNotesData();
+	if (!File || !CurrentNotes.IsValid() || NoteIds.IsEmpty())
+	{
+		return TOptional<FInt32Interval>();
+	}
+
+	return ModifyNotes(FMidiQuantizer::BuildEdits(*CurrentNotes, *File->GetSongMaps(), NoteIds, Settings));
+}
+
+TOptional<FInt32Interval> FMidiFileViewModel::GetLastEditDirtyTicks() const
+{
+	const uint32 ContentVersion = GetContentVersion();
+	return ContentVersion != 0 && ContentVersion == LastEditFromVersion + 1 ? LastEditDirtyTicks : TOptional<FInt32Interval>();
+}
+
+uint32 FMidiFileViewModel::GetContentVersion() const
+{
+	const UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(MidiFile.Get());
+	return MutableFile ? MutableFile->GetContentVersion() : 0;
+}
+
+void FMidiFileViewModel::HandleFileChanged()
+{
+	OnChanged.Broadcast();
+}
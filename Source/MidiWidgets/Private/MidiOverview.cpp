@@ -0,0 +1,132 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiOverview.h"
+#include "MidiPianoroll.h"
+#include "MidiFileViewModel.h"
+#include "SMidiOverview.h"
+
+void UMidiOverview::SetPianoroll(UMidiPianoroll* InPianoroll)
+{
+	Pianoroll = InPianoroll;
+	if (OverviewWidget.IsValid())
+	{
+		BindPianoroll();
+		HandlePianorollRefreshed();
+	}
+}
+
+void UMidiOverview::SetOverviewHeight(float InOverviewHeight)
+{
+	OverviewHeight = InOverviewHeight;
+	if (OverviewWidget.IsValid())
+	{
+		OverviewWidget->SetHeight(OverviewHeight);
+	}
+}
+
+void UMidiOverview::SetViewportColor(FLinearColor InViewportColor)
+{
+	ViewportColor = InViewportColor;
+	if (OverviewWidget.IsValid())
+	{
+		OverviewWidget->SetViewportColor(ViewportColor);
+	}
+}
+
+TSharedRef<SWidget> UMidiOverview::RebuildWidget()
+{
+	SAssignNew(OverviewWidget, SMidiOverview)
+		.Height(OverviewHeight)
+		.ViewportColor(ViewportColor);
+
+	BindPianoroll();
+	HandlePianorollRefreshed();
+
+	return OverviewWidget.ToSharedRef();
+}
+
+void UMidiOverview::SynchronizeProperties()
+{
+	Super::SynchronizeProperties();
+
+	if (!OverviewWidget.IsValid())
+	{
+		return;
+	}
+
+	OverviewWidget->SetHeight(OverviewHeight);
+	OverviewWidget->SetViewportColor(ViewportColor);
+}
+
+void UMidiOverview::ReleaseSlateResources(bool bReleaseChildren)
+{
+	Super::ReleaseSlateResources(bReleaseChildren);
+
+	UnbindPianoroll();
+	OverviewWidget.Reset();
+}
+
+void UMidiOverview::BindPianoroll()
+{
+	if (BoundPianoroll.Get() == Pianoroll && PianorollRefreshedHandle.IsValid())
+	{
+		return;
+	}
+
+	UnbindPianoroll();
+	if (Pianoroll)
+	{
+		BoundPianoroll = Pianoroll;
+		PianorollRefreshedHandle = Pianoroll->OnDisplayRefreshed.AddUObject(this, &UMidiOverview::HandlePianorollRefreshed);
+	}
+}
+
+void UMidiOverview::UnbindPianoroll()
+{
+	if (UMidiPianoroll* PreviousPianoroll = BoundPianoroll.Get())
+	{
+		PreviousPianoroll->OnDisplayRefreshed.Remove(PianorollRefreshedHandle);
+	}
+	BoundPianoroll.Reset();
+	PianorollRefreshedHandle.Reset();
+}
+
+void UMidiOverview::HandlePianorollRefreshed()
+{
+	if (!OverviewWidget.IsValid())
+	{
+		return;
+	}
+
+	UMidiPianoroll* FollowedPianoroll = BoundPianoroll.Get();
+	if (!FollowedPianoroll)
+	{
+		OverviewWidget->SetPianoroll(nullptr);
+		OverviewWidget->SetSummary(nullptr);
+		return;
+	}
+
+	// The overview can be built before the piano roll, taking its widget builds it once and UMG reuses it
+	if (!FollowedPianoroll->GetPianorollWidget().IsValid())
+	{
+		FollowedPianoroll->TakeWidget();
+	}
+
+	const TSharedPtr<FMidiFileViewModel> ViewModel = FollowedPianoroll->GetViewModel();
+	OverviewWidget->SetPianoroll(FollowedPianoroll->GetPianorollWidget());
+	OverviewWidget->SetSummary(ViewModel.IsValid() ? ViewModel->GetOverviewSummary() : nullptr);
+}
+
+#if WITH_EDITOR
+
+void UMidiOverview::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UMidiOverview, Pianoroll))
+	{
+		SetPianoroll(Pianoroll);
+	}
+}
+
+#endif
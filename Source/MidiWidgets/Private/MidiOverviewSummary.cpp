@@ -0,0 +1,136 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "MidiOverviewSummary.h"
+#include "MidiExtensionsStats.h"
+#include "Algo/BinarySearch.h"
+
+DECLARE_CYCLE_STAT(TEXT("Overview Summary Build"), STAT_MidiOverviewSummary_Build, STATGROUP_MidiExtensions);
+DECLARE_CYCLE_STAT(TEXT("Overview Summary Update"), STAT_MidiOverviewSummary_Update, STATGROUP_MidiExtensions);
+
+void FMidiOverviewSummary::Build(const FMidiNotesData& NotesData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiOverviewSummary_Build);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiOverviewSummary::Build);
+
+	const int32 LengthTicks = FMath::Max(NotesData.LastNoteOffTick, 1);
+	BucketTicks = FMath::Max(MinBucketTicks, FMath::DivideAndRoundUp(LengthTicks, TargetNumBuckets));
+	NumBuckets = FMath::DivideAndRoundUp(LengthTicks, BucketTicks);
+
+	TrackBuckets.SetNum(NotesData.Tracks.Num());
+	TrackMaxNoteTicks.Reset();
+	TrackMaxNoteTicks.SetNumZeroed(NotesData.Tracks.Num());
+	for (int32 TrackIndex = 0; TrackIndex < NotesData.Tracks.Num(); ++TrackIndex)
+	{
+		TrackBuckets[TrackIndex].Reset();
+		TrackBuckets[TrackIndex].SetNum(NumBuckets);
+		AddNotes(TrackIndex, NotesData.Tracks[TrackIndex], 0, NumBuckets - 1);
+	}
+
+	UpdateMaxNumNotes();
+	++Version;
+}
+
+void FMidiOverviewSummary::UpdateRange(const FMidiNotesData& NotesData, FInt32Interval DirtyTicks)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiOverviewSummary_Update);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMidiOverviewSummary::UpdateRange);
+
+	// Growing a little keeps the bucket size, a song that doubled would summarize into too many buckets
+	const int32 NeededBuckets = FMath::DivideAndRoundUp(FMath::Max(NotesData.LastNoteOffTick, 1), BucketTicks);
+	if (TrackBuckets.Num() != NotesData.Tracks.Num() || NeededBuckets > TargetNumBuckets * 2 || !DirtyTicks.IsValid())
+	{
+		Build(NotesData);
+		return;
+	}
+
+	if (NeededBuckets > NumBuckets)
+	{
+		NumBuckets = NeededBuckets;
+		for (TArray<FBucket>& Buckets : TrackBuckets)
+		{
+			Buckets.SetNum(NumBuckets);
+		}
+	}
+
+	const int32 FirstBucket = FMath::Clamp(DirtyTicks.Min / BucketTicks, 0, NumBuckets - 1);
+	const int32 LastBucket = FMath::Clamp(DirtyTicks.Max / BucketTicks, 0, NumBuckets - 1);
+	for (int32 TrackIndex = 0; TrackIndex < NotesData.Tracks.Num(); ++TrackIndex)
+	{
+		TArray<FBucket>& Buckets = TrackBuckets[TrackIndex];
+		for (int32 Bucket = FirstBucket; Bucket <= LastBucket; ++Bucket)
+		{
+			Buckets[Bucket] = FBucket();
+		}
+		AddNotes(TrackIndex, NotesData.Tracks[TrackIndex], FirstBucket, LastBucket);
+	}
+
+	UpdateMaxNumNotes();
+	++Version;
+}
+
+void FMidiOverviewSummary::AddNotes(int32 TrackIndex, const FMidiNotesTrack& Track, int32 FirstBucket, int32 LastBucket)
+{
+	TArray<FBucket>& Buckets = TrackBuckets[TrackIndex];
+	int32& MaxNoteTicks = TrackMaxNoteTicks[TrackIndex];
+
+	// Notes are sorted by NoteOnTick, so only the ones starting at most MaxNoteTicks before FirstBucket can reach it
+	// and the walk ends at the first one starting past LastBucket
+	const int32 FirstNoteIndex = FirstBucket > 0 ? Algo::LowerBoundBy(Track.Notes, FirstBucket * BucketTicks - MaxNoteTicks, &FLinkedMidiNote::NoteOnTick) : 0;
+	for (int32 NoteIndex = FirstNoteIndex; NoteIndex < Track.Notes.Num(); ++NoteIndex)
+	{
+		const FLinkedMidiNote& Note = Track.Notes[NoteIndex];
+		if (Note.NoteOnTick / BucketTicks > LastBucket)
+		{
+			break;
+		}
+
+		// Edited notes start inside the dirty range, so the walk sees them and the maximum stays an upper bound
+		MaxNoteTicks = FMath::Max(MaxNoteTicks, Note.NoteOffTick - Note.NoteOnTick);
+
+		// A note sounds in every bucket from its onset to the tick before its note off
+		const int32 NoteFirstBucket = FMath::Max(Note.NoteOnTick / BucketTicks, FirstBucket);
+		const int32 NoteLastBucket = FMath::Min(FMath::Max(Note.NoteOnTick, Note.NoteOffTick - 1) / BucketTicks, LastBucket);
+		if (NoteFirstBucket > NoteLastBucket)
+		{
+			continue;
+		}
+
+		FBucket NoteBucket;
+		NoteBucket.LowestNoteNumber = static_cast<uint8>(FLinkedMidiNote::ClampNoteNumber(Note.NoteNumber));
+		NoteBucket.HighestNoteNumber = NoteBucket.LowestNoteNumber;
+		NoteBucket.NumNotes = 1;
+		for (int32 Bucket = NoteFirstBucket; Bucket <= NoteLastBucket; ++Bucket)
+		{
+			Buckets[Bucket].Merge(NoteBucket);
+		}
+	}
+}
+
+void FMidiOverviewSummary::UpdateMaxNumNotes()
+{
+	MaxNumNotes = 0;
+	for (const TArray<FBucket>& Buckets : TrackBuckets)
+	{
+		for (const FBucket& Bucket : Buckets)
+		{
+			MaxNumNotes = FMath::Max<int32>(MaxNumNotes, Bucket.NumNotes);
+		}
+	}
+}
+
+bool FMidiOverviewSummary::GetRange(int32 TrackIndex, int32 StartTick, int32 EndTick, FBucket& OutBucket) const
+{
+	if (!TrackBuckets.IsValidIndex(TrackIndex) || NumBuckets == 0)
+	{
+		return false;
+	}
+
+	const int32 FirstBucket = FMath::Max(StartTick / BucketTicks, 0);
+	const int32 LastBucket = FMath::Min((FMath::Max(StartTick, EndTick - 1)) / BucketTicks, NumBuckets - 1);
+	OutBucket = FBucket();
+	for (int32 Bucket = FirstBucket; Bucket <= LastBucket; ++Bucket)
+	{
+		OutBucket.Merge(TrackBuckets[TrackIndex][Bucket]);
+	}
+	return !OutBucket.IsEmpty();
+}
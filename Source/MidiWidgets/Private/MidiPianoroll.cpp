@@ -1,36 +1,130 @@
 // Copyright notice in the Description page of Project Settings.
 
 #include "MidiPianoroll.h"
+#include "MidiFileViewModel.h"
 #include "HarmonixMidi/MidiFile.h"
 #include "MidiFile/MidiNotesData.h"
 #include "MidiFile/MutableMidiFile.h"
+#include "MidiFile/MidiNoteTransform.h"
+#include "SMidiControllerLane.h"
+#include "Playback/MidiNoteEventSchedulerComponent.h"
+#include "Widgets/SBoxPanel.h"
 
 
 void UMidiPianoroll::SetMidiFile(UMidiFile* InMidiFile)
+{
+    SetMidiFileInternal(InMidiFile, TOptional<FInt32Interval>());
+}
+
+void UMidiPianoroll::SetMidiFileInternal(UMidiFile* InMidiFile, TOptional<FInt32Interval> DirtyTicks)
 {
     LinkedMidiFile = InMidiFile;
     
     if (PianorollWidget.IsValid())
     {
-        // Clear selection when changing MIDI files
-        PianorollWidget->ClearSelection();
+        // Clear selection only when changing MIDI files, edits keep it so transforms can be repeated on the same notes
+        if (!ViewModel.IsValid() || ViewModel->GetMidiFile() != LinkedMidiFile)
+        {
+            PianorollWidget->ClearSelection();
+        }
         
+        UpdateViewModel();
         if (LinkedMidiFile)
         {
-            TSharedPtr<FSongMaps, ESPMode::ThreadSafe> SongsMap = MakeShared<FSongMaps, ESPMode::ThreadSafe>(*LinkedMidiFile->GetSongMaps());
-			auto MidiData = FMidiNotesData::BuildFromMidiFile(LinkedMidiFile);
-            PianorollWidget->SetMidiData(MidiData, SongsMap);
-            VisualizationData = FMidiFileVisualizationData::BuildFromLinkedMidiData(*MidiData);
-            // bIsEditable is now a TAttribute that automatically checks IsEditable()
+            const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> MidiData = GetDisplayMidiData();
+            PianorollWidget->SetMidiData(MidiData, ViewModel->GetSongMaps());
+            UpdateVisualizationDataForContent(*MidiData);
         }
         else
         {
             PianorollWidget->SetMidiData(nullptr, nullptr);
             VisualizationData = FMidiFileVisualizationData();
+            VisualizationDataSource.Reset();
         }
+
+        PianorollWidget->SetIsEditable(IsEditable());
+        PushVisualizationData();
+
+        for (const TSharedPtr<SMidiControllerLane>& LaneWidget : LaneWidgets)
+        {
+            LaneWidget->SetMidiData(PianorollWidget->GetMidiData(), DirtyTicks);
+        }
+
+        OnDisplayRefreshed.Broadcast();
     }
 }
 
+void UMidiPianoroll::UpdateViewModel()
+{
+    if (ViewModel.IsValid() && ViewModel->GetMidiFile() == LinkedMidiFile)
+    {
+        return;
+    }
+
+    ReleaseViewModel();
+    if (LinkedMidiFile)
+    {
+        ViewModel = FMidiFileViewModel::Get(LinkedMidiFile);
+        ViewModelChangedHandle = ViewModel->OnChanged.AddUObject(this, &UMidiPianoroll::HandleViewModelChanged);
+    }
+}
+
+void UMidiPianoroll::ReleaseViewModel()
+{
+    if (ViewModel.IsValid())
+    {
+        ViewModel->OnChanged.Remove(ViewModelChangedHandle);
+        ViewModelChangedHandle.Reset();
+        ViewModel.Reset();
+    }
+}
+
+void UMidiPianoroll::HandleViewModelChanged()
+{
+    // Edits keep the notes sorted by onset, this widget's own included, so the selection has to follow its notes
+    RemapSelectionAfterEdit();
+
+    if (!bIsApplyingEdit && PianorollWidget.IsValid())
+    {
+        SetMidiFileInternal(LinkedMidiFile, ViewModel.IsValid() ? ViewModel->GetLastEditDirtyTicks() : TOptional<FInt32Interval>());
+    }
+}
+
+void UMidiPianoroll::RemapSelectionAfterEdit()
+{
+    const UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(LinkedMidiFile);
+    if (!PianorollWidget.IsValid() || !MutableFile)
+    {
+        return;
+    }
+
+    PianorollWidget->RemapNoteIndices([MutableFile](int32 TrackIndex, int32 NoteIndex)
+    {
+        return MutableFile->GetNoteIndexAfterLastEdit(TrackIndex, NoteIndex);
+    });
+}
+
+TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> UMidiPianoroll::GetDisplayMidiData()
+{
+    // A mutable file's own notes keep the note indices the widget hands back in edits in sync with the file
+    UpdateViewModel();
+    return ViewModel.IsValid() ? ViewModel->GetNotesData() : nullptr;
+}
+
+void UMidiPianoroll::UpdateVisualizationDataForContent(FMidiNotesData& MidiData)
+{
+    const UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(LinkedMidiFile);
+    const uint32 ContentVersion = MutableFile ? MutableFile->GetContentVersion() : 0;
+    if (VisualizationDataSource == LinkedMidiFile && VisualizationDataContentVersion == ContentVersion)
+    {
+        return;
+    }
+
+    VisualizationData = FMidiFileVisualizationData::BuildFromLinkedMidiData(MidiData);
+    VisualizationDataSource = LinkedMidiFile;
+    VisualizationDataContentVersion = ContentVersion;
+}
+
 void UMidiPianoroll::MakeEditableCopyOfLinkedMidiFile()
 {
     if (LinkedMidiFile)
@@ -47,31 +141,171 @@ void UMidiPianoroll::MakeEditableCopyOfLinkedMidiFile()
 
 void UMidiPianoroll::SaveMidiFileToAsset()
 {
-	SaveMidiFileAsAsset(TEXT("/Game/MIDI"), LinkedMidiFile ? LinkedMidiFile->GetName() + TEXT("_Saved") : TEXT("NewMidiFile"));
+	UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(LinkedMidiFile);
+	if (!MutableFile)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SaveMidiFileToAsset: LinkedMidiFile is not a MutableMidiFile"));
+		return;
+	}
+
+	// The editor button saves in the background so large files don't stall the editor
+	MutableFile->SaveAsAssetAsync(TEXT("/Game/MIDI"), MutableFile->GetName() + TEXT("_Saved"), FOnMidiFileSaved());
 }
 
 void UMidiPianoroll::SetEditingTrackIndex(int32 InTrackIndex)
 {
     EditingTrackIndex = InTrackIndex;
-    // The Slate widget will pick this up via the TAttribute binding
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetEditingTrackIndex(EditingTrackIndex);
+    }
 }
 
 void UMidiPianoroll::SetEditMode(EPianorollEditMode InEditMode)
 {
     EditMode = InEditMode;
-    // The Slate widget will pick this up via the TAttribute binding
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetEditMode(EditMode);
+    }
 }
 
 void UMidiPianoroll::SetDefaultNoteVelocity(int32 InVelocity)
 {
     DefaultNoteVelocity = FMath::Clamp(InVelocity, 1, 127);
-    // The Slate widget will pick this up via the TAttribute binding
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetDefaultNoteVelocity(DefaultNoteVelocity);
+    }
 }
 
 void UMidiPianoroll::SetDefaultNoteDurationTicks(int32 InDurationTicks)
 {
     DefaultNoteDurationTicks = FMath::Max(1, InDurationTicks);
-    // The Slate widget will pick this up via the TAttribute binding
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetDefaultNoteDurationTicks(DefaultNoteDurationTicks);
+    }
+}
+
+void UMidiPianoroll::SetTimeDisplayMode(EMidiTrackTimeMode InTimeDisplayMode)
+{
+    TimeDisplayMode = InTimeDisplayMode;
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetTimeMode(TimeDisplayMode);
+    }
+}
+
+void UMidiPianoroll::SetGridPointType(EPianorollGridPointType InGridPointType)
+{
+    GridPointType = InGridPointType;
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetGridPointType(GridPointType);
+    }
+}
+
+void UMidiPianoroll::SetGridSubdivision(EMidiClockSubdivisionQuantization InGridSubdivision)
+{
+    GridSubdivision = InGridSubdivision;
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetGridSubdivision(GridSubdivision);
+    }
+}
+
+void UMidiPianoroll::SetSnapToGrid(bool bInSnapToGrid)
+{
+    bSnapToGrid = bInSnapToGrid;
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetSnapToGrid(bSnapToGrid);
+    }
+}
+
+void UMidiPianoroll::SetNoteDuration(EMidiClockSubdivisionQuantization InNoteDuration)
+{
+    NoteDuration = InNoteDuration;
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetNoteDuration(NoteDuration);
+    }
+}
+
+void UMidiPianoroll::SetFollowPlayback(bool bInFollowPlayback)
+{
+    bFollowPlayback = bInFollowPlayback;
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetFollowPlayback(bFollowPlayback);
+    }
+}
+
+void UMidiPianoroll::SetPlaybackSource(UMidiNoteEventSchedulerComponent* InScheduler)
+{
+    SetPlaybackClock(InScheduler ? InScheduler->GetPlaybackClock().ToSharedPtr() : nullptr);
+}
+
+void UMidiPianoroll::SetPlaybackClock(TSharedPtr<const FMidiPlaybackClock, ESPMode::ThreadSafe> InPlaybackClock)
+{
+    PlaybackClock = MoveTemp(InPlaybackClock);
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetPlaybackClock(PlaybackClock);
+    }
+}
+
+void UMidiPianoroll::SetLanes(const TArray<FMidiPianorollLane>& InLanes)
+{
+    Lanes = InLanes;
+    RebuildLaneWidgets();
+}
+
+void UMidiPianoroll::RebuildLaneWidgets()
+{
+    if (!LanesBox.IsValid() || !PianorollWidget.IsValid())
+    {
+        return;
+    }
+
+    // The piano roll is always the first slot
+    for (const TSharedPtr<SMidiControllerLane>& LaneWidget : LaneWidgets)
+    {
+        LanesBox->RemoveSlot(LaneWidget.ToSharedRef());
+    }
+    LaneWidgets.Reset();
+
+    for (const FMidiPianorollLane& Lane : Lanes)
+    {
+        TSharedPtr<SMidiControllerLane> LaneWidget;
+        LanesBox->AddSlot()
+            .AutoHeight()
+            .Padding(0.0f, 1.0f, 0.0f, 0.0f)
+            [
+                SAssignNew(LaneWidget, SMidiControllerLane)
+                .Clipping(EWidgetClipping::ClipToBounds)
+                .Pianoroll(PianorollWidget)
+                .Lane(Lane)
+            ];
+        LaneWidgets.Add(LaneWidget);
+    }
+}
+
+void UMidiPianoroll::SetVisualizationData(const FMidiFileVisualizationData& InVisualizationData)
+{
+    VisualizationData = InVisualizationData;
+    PushVisualizationData();
+    OnDisplayRefreshed.Broadcast();
+}
+
+void UMidiPianoroll::PushVisualizationData()
+{
+    ++VisualizationDataVersion;
+    if (PianorollWidget.IsValid())
+    {
+        PianorollWidget->SetVisualizationData(&VisualizationData, VisualizationDataVersion);
+    }
 }
 
 void UMidiPianoroll::DeleteSelectedNotes()
@@ -109,12 +343,131 @@ void UMidiPianoroll::DeleteSelectedNotes()
     PianorollWidget->ClearSelection();
 
     // Apply the deletions
-    MutableFile->ModifyNotes(Edits);
+    UpdateViewModel();
+    {
+        TGuardValue<bool> ApplyingEditGuard(bIsApplyingEdit, true);
+        ViewModel->ModifyNotes(Edits);
+    }
 
     // Refresh the display
     SetMidiFile(LinkedMidiFile);
 }
 
+void UMidiPianoroll::TransformSelectedNotes(const FMidiNoteTransform& Transform)
+{
+    if (!PianorollWidget.IsValid() || !LinkedMidiFile)
+    {
+        return;
+    }
+
+    UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(LinkedMidiFile);
+    if (!MutableFile)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TransformSelectedNotes: LinkedMidiFile is not a MutableMidiFile"));
+        return;
+    }
+
+    const auto& SelectedNotes = PianorollWidget->GetSelectedNotes();
+    if (SelectedNotes.Num() == 0 || Transform.IsIdentity())
+    {
+        return;
+    }
+
+    TArray<FMidiNoteId> NoteIds;
+    NoteIds.Reserve(SelectedNotes.Num());
+    for (const auto& NoteId : SelectedNotes)
+    {
+        NoteIds.Add({ NoteId.TrackIndex, NoteId.NoteIndex });
+    }
+
+    // Through the view model so the overview summary and the lanes only update the ticks the transform touched
+    UpdateViewModel();
+    TOptional<FInt32Interval> DirtyTicks;
+    {
+        TGuardValue<bool> ApplyingEditGuard(bIsApplyingEdit, true);
+        DirtyTicks = ViewModel->TransformNotes(NoteIds, Transform);
+    }
+
+    // Refresh the display
+    SetMidiFileInternal(LinkedMidiFile, DirtyTicks);
+}
+
+void UMidiPianoroll::TransposeSelectedNotes(int32 Semitones)
+{
+    TransformSelectedNotes(FMidiNoteTransform::MakeTranspose(Semitones));
+}
+
+void UMidiPianoroll::ShiftSelectedNotes(int32 Ticks)
+{
+    TransformSelectedNotes(FMidiNoteTransform::MakeShift(Ticks));
+}
+
+void UMidiPianoroll::ScaleSelectedNotesTime(float Scale)
+{
+    const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> MidiData = PianorollWidget.IsValid() ? PianorollWidget->GetMidiData() : nullptr;
+    if (!MidiData.IsValid())
+    {
+        return;
+    }
+
+    int32 PivotTick = TNumericLimits<int32>::Max();
+    for (const auto& NoteId : PianorollWidget->GetSelectedNotes())
+    {
+        if (MidiData->Tracks.IsValidIndex(NoteId.TrackIndex) && MidiData->Tracks[NoteId.TrackIndex].Notes.IsValidIndex(NoteId.NoteIndex))
+        {
+            PivotTick = FMath::Min(PivotTick, MidiData->Tracks[NoteId.TrackIndex].Notes[NoteId.NoteIndex].NoteOnTick);
+        }
+    }
+
+    if (PivotTick != TNumericLimits<int32>::Max())
+    {
+        TransformSelectedNotes(FMidiNoteTransform::MakeTimeScale(Scale, PivotTick));
+    }
+}
+
+void UMidiPianoroll::ScaleSelectedNotesVelocity(float Scale)
+{
+    TransformSelectedNotes(FMidiNoteTransform::MakeVelocityScale(Scale));
+}
+
+void UMidiPianoroll::QuantizeSelectedNotes(const FMidiQuantizeSettings& Settings)
+{
+    if (!PianorollWidget.IsValid() || !LinkedMidiFile)
+    {
+        return;
+    }
+
+    UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(LinkedMidiFile);
+    if (!MutableFile)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("QuantizeSelectedNotes: LinkedMidiFile is not a MutableMidiFile"));
+        return;
+    }
+
+    const auto& SelectedNotes = PianorollWidget->GetSelectedNotes();
+    if (SelectedNotes.Num() == 0)
+    {
+        return;
+    }
+
+    TArray<FMidiNoteId> NoteIds;
+    NoteIds.Reserve(SelectedNotes.Num());
+    for (const auto& NoteId : SelectedNotes)
+    {
+        NoteIds.Add({ NoteId.TrackIndex, NoteId.NoteIndex });
+    }
+
+    UpdateViewModel();
+    TOptional<FInt32Interval> DirtyTicks;
+    {
+        TGuardValue<bool> ApplyingEditGuard(bIsApplyingEdit, true);
+        DirtyTicks = ViewModel->QuantizeNotes(NoteIds, Settings);
+    }
+
+    // Refresh the display
+    SetMidiFileInternal(LinkedMidiFile, DirtyTicks);
+}
+
 UMidiFile* UMidiPianoroll::SaveMidiFileAsAsset(const FString& PackagePath, const FString& AssetName)
 {
     UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(LinkedMidiFile);
@@ -156,47 +509,89 @@ TSharedRef<SWidget> UMidiPianoroll::RebuildWidget()
 
     if(LinkedMidiFile)
     {
-        MidiData = FMidiNotesData::BuildFromMidiFile(LinkedMidiFile);
-        SongsMap = MakeShared<FSongMaps, ESPMode::ThreadSafe>(*LinkedMidiFile->GetSongMaps());
-        VisualizationData = FMidiFileVisualizationData::BuildFromLinkedMidiData(*MidiData);
+        MidiData = GetDisplayMidiData();
+        SongsMap = ViewModel->GetSongMaps();
+        UpdateVisualizationDataForContent(*MidiData);
     }
 
+    // Values are pushed rather than bound, the setters and SynchronizeProperties forward changes to the Slate widget
     SAssignNew(PianorollWidget, SMidiPianoroll)
         .Clipping(EWidgetClipping::ClipToBounds)
         .LinkedMidiData(MidiData)
         .LinkedSongsMap(SongsMap)
-        // Bind to getter using lambda - will be called each frame during paint
-        .VisualizationData(TAttribute<FMidiFileVisualizationData>::CreateLambda([this]() { return GetVisualizationData(); }))
-        .TimeMode(TAttribute<EMidiTrackTimeMode>::CreateLambda([this]() { return GetTimeDisplayMode(); }))
+        .VisualizationData(&VisualizationData)
+        .TimeMode(TimeDisplayMode)
         .PianorollStyle(&PianorollStyle)
         .Offset(FVector2D::ZeroVector)
         .Zoom(FVector2D(1.0f, 1.0f))
-        .GridPointType(TAttribute<EPianorollGridPointType>::CreateLambda([this]() { return GetGridPointType(); }))
-        .EditMode(TAttribute<EPianorollEditMode>::CreateLambda([this]() { return GetEditMode(); }))
-        .EditingTrackIndex(TAttribute<int32>::CreateLambda([this]() { return GetEditingTrackIndex(); }))
-        .DefaultNoteVelocity(TAttribute<int32>::CreateLambda([this]() { return GetDefaultNoteVelocity(); }))
-        .DefaultNoteDurationTicks(TAttribute<int32>::CreateLambda([this]() { return GetDefaultNoteDurationTicks(); }))
-        .GridSubdivision(TAttribute<EMidiClockSubdivisionQuantization>::CreateLambda([this]() { return GetGridSubdivision(); }))
-        .bSnapToGrid(TAttribute<bool>::CreateLambda([this]() { return GetSnapToGrid(); }))
-        .NoteDuration(TAttribute<EMidiClockSubdivisionQuantization>::CreateLambda([this]() { return GetNoteDuration(); }))
-        .bIsEditable(TAttribute<bool>::CreateLambda([this]() { return IsEditable(); }));
+        .GridPointType(GridPointType)
+        .EditMode(EditMode)
+        .EditingTrackIndex(EditingTrackIndex)
+        .DefaultNoteVelocity(DefaultNoteVelocity)
+        .DefaultNoteDurationTicks(DefaultNoteDurationTicks)
+        .GridSubdivision(GridSubdivision)
+        .bSnapToGrid(bSnapToGrid)
+        .NoteDuration(NoteDuration)
+        .bIsEditable(IsEditable());
 
     // Bind the delete delegate
     PianorollWidget->OnDeleteSelectedNotes.BindUObject(this, &UMidiPianoroll::DeleteSelectedNotes);
+    PianorollWidget->OnTransformSelectedNotes.BindUObject(this, &UMidiPianoroll::TransformSelectedNotes);
+
+    PianorollWidget->SetFollowPlayback(bFollowPlayback);
+    PianorollWidget->SetPlaybackClock(PlaybackClock);
 
     // Bind the notes modified delegate for painting/moving
     PianorollWidget->OnNotesModified.BindLambda([this](const TArray<FNotesEditCallbackData>& Edits)
     {
-        UMutableMidiFile* MutableFile = Cast<UMutableMidiFile>(LinkedMidiFile);
-        if (MutableFile && Edits.Num() > 0)
+        if (IsEditable() && Edits.Num() > 0)
         {
-            MutableFile->ModifyNotes(Edits);
+            UpdateViewModel();
+
+            // The model returns the ticks the edits move notes from and to, lanes only need to refresh that span
+            TOptional<FInt32Interval> DirtyTicks;
+            {
+                TGuardValue<bool> ApplyingEditGuard(bIsApplyingEdit, true);
+                DirtyTicks = ViewModel->ModifyNotes(Edits);
+            }
             // Refresh the display
-            SetMidiFile(LinkedMidiFile);
+            SetMidiFileInternal(LinkedMidiFile, DirtyTicks);
         }
     });
 
-    return PianorollWidget.ToSharedRef();
+    SAssignNew(LanesBox, SVerticalBox)
+        + SVerticalBox::Slot()
+        .FillHeight(1.0f)
+        [
+            PianorollWidget.ToSharedRef()
+        ];
+    RebuildLaneWidgets();
+
+    OnDisplayRefreshed.Broadcast();
+
+    return LanesBox.ToSharedRef();
+}
+
+void UMidiPianoroll::SynchronizeProperties()
+{
+    Super::SynchronizeProperties();
+
+    if (!PianorollWidget.IsValid())
+    {
+        return;
+    }
+
+    PianorollWidget->SetTimeMode(TimeDisplayMode);
+    PianorollWidget->SetGridPointType(GridPointType);
+    PianorollWidget->SetEditMode(EditMode);
+    PianorollWidget->SetEditingTrackIndex(EditingTrackIndex);
+    PianorollWidget->SetDefaultNoteVelocity(DefaultNoteVelocity);
+    PianorollWidget->SetDefaultNoteDurationTicks(DefaultNoteDurationTicks);
+    PianorollWidget->SetGridSubdivision(GridSubdivision);
+    PianorollWidget->SetSnapToGrid(bSnapToGrid);
+    PianorollWidget->SetNoteDuration(NoteDuration);
+    PianorollWidget->SetIsEditable(IsEditable());
+    PianorollWidget->SetFollowPlayback(bFollowPlayback);
 }
 
 void UMidiPianoroll::ReleaseSlateResources(bool bReleaseChildren)
@@ -204,6 +599,9 @@ void UMidiPianoroll::ReleaseSlateResources(bool bReleaseChildren)
     Super::ReleaseSlateResources(bReleaseChildren);
 
     PianorollWidget.Reset();
+    LanesBox.Reset();
+    LaneWidgets.Reset();
+    ReleaseViewModel();
 }
 
 #if WITH_EDITOR
@@ -216,6 +614,14 @@ void UMidiPianoroll::PostEditChangeProperty(FPropertyChangedEvent& PropertyChang
     {
 		SetMidiFile(LinkedMidiFile);
 	}
+	else if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UMidiPianoroll, VisualizationData))
+	{
+		PushVisualizationData();
+	}
+	else if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UMidiPianoroll, Lanes))
+	{
+		RebuildLaneWidgets();
+	}
 }
 
 #endif
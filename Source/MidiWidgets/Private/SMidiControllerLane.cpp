@@ -0,0 +1,325 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "SMidiControllerLane.h"
+#include "SMidiPianoroll.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/AppStyle.h"
+#include "MidiExtensionsStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Controller Lane OnPaint"), STAT_MidiControllerLane_OnPaint, STATGROUP_MidiExtensions);
+DECLARE_CYCLE_STAT(TEXT("Controller Lane Update"), STAT_MidiControllerLane_Update, STATGROUP_MidiExtensions);
+
+void FMidiLaneDecimationCache::Build(TConstArrayView<int16> InValues)
+{
+	Values = InValues;
+	MinLevels.Reset();
+	MaxLevels.Reset();
+
+	const TArray<int16>* PreviousMin = &Values;
+	const TArray<int16>* PreviousMax = &Values;
+	while (PreviousMin->Num() > 1)
+	{
+		const int32 NumBlocks = FMath::DivideAndRoundUp(PreviousMin->Num(), 2);
+		TArray<int16>& LevelMin = MinLevels.AddDefaulted_GetRef();
+		TArray<int16>& LevelMax = MaxLevels.AddDefaulted_GetRef();
+		LevelMin.SetNumUninitialized(NumBlocks);
+		LevelMax.SetNumUninitialized(NumBlocks);
+
+		// Adding levels may have moved the previous ones
+		PreviousMin = MinLevels.Num() > 1 ? &MinLevels[MinLevels.Num() - 2] : &Values;
+		PreviousMax = MaxLevels.Num() > 1 ? &MaxLevels[MaxLevels.Num() - 2] : &Values;
+
+		for (int32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			const int32 Left = Block * 2;
+			const int32 Right = FMath::Min(Left + 1, PreviousMin->Num() - 1);
+			LevelMin[Block] = FMath::Min((*PreviousMin)[Left], (*PreviousMin)[Right]);
+			LevelMax[Block] = FMath::Max((*PreviousMax)[Left], (*PreviousMax)[Right]);
+		}
+
+		PreviousMin = &LevelMin;
+		PreviousMax = &LevelMax;
+	}
+}
+
+void FMidiLaneDecimationCache::UpdateRange(TConstArrayView<int16> InValues, int32 First, int32 Last)
+{
+	check(InValues.Num() == Values.Num());
+	First = FMath::Max(First, 0);
+	Last = FMath::Min(Last, Values.Num() - 1);
+	if (First > Last)
+	{
+		return;
+	}
+
+	FMemory::Memcpy(Values.GetData() + First, InValues.GetData() + First, (Last - First + 1) * sizeof(int16));
+
+	for (int32 Level = 0; Level < MinLevels.Num(); ++Level)
+	{
+		const TArray<int16>& PreviousMin = Level > 0 ? MinLevels[Level - 1] : Values;
+		const TArray<int16>& PreviousMax = Level > 0 ? MaxLevels[Level - 1] : Values;
+		First /= 2;
+		Last /= 2;
+
+		for (int32 Block = First; Block <= Last; ++Block)
+		{
+			const int32 Left = Block * 2;
+			const int32 Right = FMath::Min(Left + 1, PreviousMin.Num() - 1);
+			MinLevels[Level][Block] = FMath::Min(PreviousMin[Left], PreviousMin[Right]);
+			MaxLevels[Level][Block] = FMath::Max(PreviousMax[Left], PreviousMax[Right]);
+		}
+	}
+}
+
+bool FMidiLaneDecimationCache::GetMinMax(int32 First, int32 Last, int16& OutMin, int16& OutMax) const
+{
+	First = FMath::Max(First, 0);
+	Last = FMath::Min(Last, Values.Num());
+	if (First >= Last)
+	{
+		return false;
+	}
+
+	OutMin = TNumericLimits<int16>::Max();
+	OutMax = TNumericLimits<int16>::Lowest();
+
+	// Take the largest aligned block that fits at each step, there are at most two per level
+	while (First < Last)
+	{
+		int32 Level = 0;
+		while (Level < MinLevels.Num() && (First & ((2 << Level) - 1)) == 0 && First + (2 << Level) <= Last)
+		{
+			++Level;
+		}
+
+		if (Level == 0)
+		{
+			OutMin = FMath::Min(OutMin, Values[First]);
+			OutMax = FMath::Max(OutMax, Values[First]);
+		}
+		else
+		{
+			const int32 Block = First >> Level;
+			OutMin = FMath::Min(OutMin, MinLevels[Level - 1][Block]);
+			OutMax = FMath::Max(OutMax, MaxLevels[Level - 1][Block]);
+		}
+		First += 1 << Level;
+	}
+	return true;
+}
+
+SMidiControllerLane::~SMidiControllerLane()
+{
+	if (TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin())
+	{
+		PinnedPianoroll->OnViewChanged.Remove(ViewChangedHandle);
+	}
+}
+
+void SMidiControllerLane::Construct(const FArguments& InArgs)
+{
+	Lane = InArgs._Lane;
+	Pianoroll = InArgs._Pianoroll;
+
+	if (TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin())
+	{
+		ViewChangedHandle = PinnedPianoroll->OnViewChanged.AddSP(this, &SMidiControllerLane::HandleViewChanged);
+		SetMidiData(PinnedPianoroll->GetMidiData());
+	}
+}
+
+void SMidiControllerLane::SetLane(const FMidiPianorollLane& InLane)
+{
+	Lane = InLane;
+	SetMidiData(MidiData);
+}
+
+void SMidiControllerLane::SetMidiData(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InMidiData, TOptional<FInt32Interval> DirtyTicks)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiControllerLane_Update);
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMidiControllerLane::SetMidiData);
+
+	MidiData = MoveTemp(InMidiData);
+
+	TArray<int32> NewTicks;
+	TArray<int16> NewValues;
+	ExtractPoints(NewTicks, NewValues);
+
+	// With an unchanged point count every point outside the dirty range keeps its index, so only those blocks change
+	if (DirtyTicks.IsSet() && NewTicks.Num() == Cache.Num() && !NewTicks.IsEmpty())
+	{
+		const int32 First = Algo::LowerBound(NewTicks, DirtyTicks->Min);
+		const int32 Last = Algo::UpperBound(NewTicks, DirtyTicks->Max) - 1;
+		Cache.UpdateRange(NewValues, First, Last);
+	}
+	else
+	{
+		Cache.Build(NewValues);
+	}
+	PointTicks = MoveTemp(NewTicks);
+
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SMidiControllerLane::ExtractPoints(TArray<int32>& OutTicks, TArray<int16>& OutValues) const
+{
+	if (!MidiData.IsValid())
+	{
+		return;
+	}
+
+	if (Lane.LaneType == EMidiPianorollLaneType::Velocity)
+	{
+		if (!MidiData->Tracks.IsValidIndex(Lane.TrackIndex))
+		{
+			return;
+		}
+
+		// Notes should already be sorted by onset, the stable sort keeps notes sharing a tick in index order so the
+		// point order is the same on every extraction and the decimation levels outside a dirty span stay valid
+		const TArray<FLinkedMidiNote>& Notes = MidiData->Tracks[Lane.TrackIndex].Notes;
+		TArray<int32> Order;
+		Order.SetNumUninitialized(Notes.Num());
+		for (int32 NoteIndex = 0; NoteIndex < Notes.Num(); ++NoteIndex)
+		{
+			Order[NoteIndex] = NoteIndex;
+		}
+		Algo::StableSortBy(Order, [&Notes](int32 NoteIndex) { return Notes[NoteIndex].NoteOnTick; });
+
+		OutTicks.SetNumUninitialized(Notes.Num());
+		OutValues.SetNumUninitialized(Notes.Num());
+		for (int32 Position = 0; Position < Order.Num(); ++Position)
+		{
+			OutTicks[Position] = Notes[Order[Position]].NoteOnTick;
+			OutValues[Position] = Notes[Order[Position]].Velocity;
+		}
+		return;
+	}
+
+	const bool bHasNumber = Lane.ControllerType == EMidiControllerType::ControlChange || Lane.ControllerType == EMidiControllerType::PolyAftertouch;
+	if (const FMidiControllerLane* ControllerLane = MidiData->FindControllerLane(Lane.TrackIndex, Lane.ChannelIndex, Lane.ControllerType, bHasNumber ? Lane.ControllerNumber : 0))
+	{
+		OutTicks = ControllerLane->Ticks;
+		OutValues = ControllerLane->Values;
+	}
+}
+
+void SMidiControllerLane::GetValueRange(int32& OutMin, int32& OutMax) const
+{
+	if (Lane.LaneType == EMidiPianorollLaneType::Controller && Lane.ControllerType == EMidiControllerType::PitchBend)
+	{
+		OutMin = -8192;
+		OutMax = 8191;
+		return;
+	}
+
+	OutMin = 0;
+	OutMax = 127;
+}
+
+int32 SMidiControllerLane::GetDefaultValue() const
+{
+	return 0;
+}
+
+FVector2D SMidiControllerLane::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D(100.0f, Lane.Height);
+}
+
+int32 SMidiControllerLane::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiControllerLane_OnPaint);
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMidiControllerLane::OnPaint);
+
+	const FVector2D LocalSize = AllottedGeometry.GetLocalSize();
+	const FSlateBrush* WhiteBrush = FAppStyle::GetBrush("WhiteBrush");
+
+	FSlateDrawElement::MakeBox(
+		OutDrawElements,
+		LayerId,
+		AllottedGeometry.ToPaintGeometry(),
+		WhiteBrush,
+		ESlateDrawEffect::None,
+		FLinearColor(0.015f, 0.015f, 0.015f));
+
+	const TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin();
+	const bool bIsVelocityLane = Lane.LaneType == EMidiPianorollLaneType::Velocity;
+	if (!PinnedPianoroll.IsValid() || (PointTicks.IsEmpty() && bIsVelocityLane))
+	{
+		return LayerId + 1;
+	}
+
+	int32 MinValue, MaxValue;
+	GetValueRange(MinValue, MaxValue);
+	const double ValueScale = (LocalSize.Y - 2.0) / FMath::Max(1, MaxValue - MinValue);
+	auto ValueToY = [&](int32 Value)
+	{
+		return LocalSize.Y - 1.0 - (FMath::Clamp(Value, MinValue, MaxValue) - MinValue) * ValueScale;
+	};
+
+	// Each pixel column covers the ticks up to the next column, its points are read from the cache as one min/max
+	const int32 NumColumns = FMath::CeilToInt32(LocalSize.X);
+	int32 PointIndex = Algo::LowerBound(PointTicks, FMath::FloorToInt32(PinnedPianoroll->ViewXToTick(0.0)));
+	const TConstArrayView<int32> Ticks(PointTicks);
+
+	TArray<FVector2D> Points;
+	Points.Reserve(bIsVelocityLane ? NumColumns * 3 : NumColumns * 4 + 2);
+
+	const double BaseY = ValueToY(MinValue);
+	int32 CurrentValue = PointIndex > 0 ? Cache.GetValue(PointIndex - 1) : GetDefaultValue();
+	if (!bIsVelocityLane)
+	{
+		Points.Emplace(0.0, ValueToY(CurrentValue));
+	}
+
+	for (int32 Column = 0; Column < NumColumns && PointIndex < PointTicks.Num(); ++Column)
+	{
+		const int32 ColumnEndTick = FMath::FloorToInt32(PinnedPianoroll->ViewXToTick(Column + 1.0));
+		const int32 EndIndex = PointIndex + Algo::LowerBound(Ticks.Slice(PointIndex, Ticks.Num() - PointIndex), ColumnEndTick);
+
+		int16 ColumnMin, ColumnMax;
+		if (Cache.GetMinMax(PointIndex, EndIndex, ColumnMin, ColumnMax))
+		{
+			const double X = Column + 0.5;
+			if (bIsVelocityLane)
+			{
+				// Stems zigzag along the baseline so every column stays in the same polyline
+				Points.Emplace(X, BaseY);
+				Points.Emplace(X, ValueToY(ColumnMax));
+				Points.Emplace(X, BaseY);
+			}
+			else
+			{
+				Points.Emplace(X, ValueToY(CurrentValue));
+				Points.Emplace(X, ValueToY(ColumnMin));
+				Points.Emplace(X, ValueToY(ColumnMax));
+				CurrentValue = Cache.GetValue(EndIndex - 1);
+				Points.Emplace(X, ValueToY(CurrentValue));
+			}
+		}
+		PointIndex = EndIndex;
+	}
+
+	if (!bIsVelocityLane)
+	{
+		Points.Emplace(LocalSize.X, ValueToY(CurrentValue));
+	}
+
+	if (Points.Num() >= 2)
+	{
+		FSlateDrawElement::MakeLines(
+			OutDrawElements,
+			LayerId + 1,
+			AllottedGeometry.ToPaintGeometry(),
+			Points,
+			ESlateDrawEffect::None,
+			Lane.Color,
+			false,
+			1.0f);
+	}
+
+	return LayerId + 2;
+}
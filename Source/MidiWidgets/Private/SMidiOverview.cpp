@@ -0,0 +1,265 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "SMidiOverview.h"
+#include "SMidiPianoroll.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/AppStyle.h"
+#include "MidiExtensionsStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Overview OnPaint"), STAT_MidiOverview_OnPaint, STATGROUP_MidiExtensions);
+
+SMidiOverview::~SMidiOverview()
+{
+	if (TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin())
+	{
+		PinnedPianoroll->OnViewChanged.Remove(ViewChangedHandle);
+	}
+}
+
+void SMidiOverview::Construct(const FArguments& InArgs)
+{
+	Summary = InArgs._Summary;
+	Height = InArgs._Height;
+	ViewportColor = InArgs._ViewportColor;
+	SetPianoroll(InArgs._Pianoroll);
+}
+
+void SMidiOverview::SetPianoroll(TSharedPtr<SMidiPianoroll> InPianoroll)
+{
+	if (InPianoroll == Pianoroll.Pin())
+	{
+		return;
+	}
+
+	if (TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin())
+	{
+		PinnedPianoroll->OnViewChanged.Remove(ViewChangedHandle);
+	}
+
+	Pianoroll = InPianoroll;
+	ViewChangedHandle.Reset();
+	if (InPianoroll.IsValid())
+	{
+		ViewChangedHandle = InPianoroll->OnViewChanged.AddSP(this, &SMidiOverview::HandleViewChanged);
+	}
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SMidiOverview::SetSummary(TSharedPtr<const FMidiOverviewSummary, ESPMode::ThreadSafe> InSummary)
+{
+	Summary = MoveTemp(InSummary);
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SMidiOverview::SetHeight(float InHeight)
+{
+	Height = InHeight;
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SMidiOverview::SetViewportColor(const FLinearColor& InViewportColor)
+{
+	ViewportColor = InViewportColor;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+double SMidiOverview::GetLengthTicks() const
+{
+	return Summary.IsValid() ? FMath::Max(Summary->GetLengthTicks(), 1) : 1.0;
+}
+
+bool SMidiOverview::GetViewTickRange(double& OutStartTick, double& OutEndTick) const
+{
+	const TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin();
+	if (!PinnedPianoroll.IsValid())
+	{
+		return false;
+	}
+
+	OutStartTick = PinnedPianoroll->ViewXToTick(0.0);
+	OutEndTick = PinnedPianoroll->ViewXToTick(PinnedPianoroll->GetTickSpaceGeometry().GetLocalSize().X);
+	return true;
+}
+
+FVector2D SMidiOverview::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D(100.0f, Height);
+}
+
+int32 SMidiOverview::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MidiOverview_OnPaint);
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMidiOverview::OnPaint);
+
+	const FVector2D LocalSize = AllottedGeometry.GetLocalSize();
+	const FSlateBrush* WhiteBrush = FAppStyle::GetBrush("WhiteBrush");
+
+	FSlateDrawElement::MakeBox(
+		OutDrawElements,
+		LayerId,
+		AllottedGeometry.ToPaintGeometry(),
+		WhiteBrush,
+		ESlateDrawEffect::None,
+		FLinearColor(0.015f, 0.015f, 0.015f));
+
+	const TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin();
+	const int32 NumColumns = FMath::CeilToInt32(LocalSize.X);
+	if (Summary.IsValid() && Summary->GetNumBuckets() > 0 && NumColumns > 0)
+	{
+		const double TicksPerColumn = GetLengthTicks() / LocalSize.X;
+		const double RowHeight = LocalSize.Y / 128.0;
+		const float MaxNumNotes = FMath::Max(1, Summary->GetMaxNumNotes());
+
+		// Densities are bucketed into a few alpha steps so neighbouring columns merge into runs more often
+		constexpr int32 NumAlphaSteps = 8;
+		auto GetAlphaStep = [MaxNumNotes](const FMidiOverviewSummary::FBucket& Bucket)
+		{
+			return FMath::Clamp(FMath::CeilToInt32(FMath::Sqrt(Bucket.NumNotes / MaxNumNotes) * NumAlphaSteps), 1, NumAlphaSteps);
+		};
+
+		for (int32 TrackIndex = 0; TrackIndex < Summary->GetNumTracks(); ++TrackIndex)
+		{
+			if (PinnedPianoroll.IsValid() && !PinnedPianoroll->IsTrackVisible(TrackIndex))
+			{
+				continue;
+			}
+			const FLinearColor TrackColor = PinnedPianoroll.IsValid() ? PinnedPianoroll->GetTrackColor(TrackIndex) : FLinearColor::White;
+
+			auto MakeRunBox = [&](int32 FirstColumn, int32 EndColumn, const FMidiOverviewSummary::FBucket& Bucket, int32 AlphaStep)
+			{
+				const double Top = (127 - Bucket.HighestNoteNumber) * RowHeight;
+				const double Bottom = (128 - Bucket.LowestNoteNumber) * RowHeight;
+				FLinearColor Color = TrackColor;
+				Color.A *= 0.25f + 0.75f * AlphaStep / NumAlphaSteps;
+				FSlateDrawElement::MakeBox(
+					OutDrawElements,
+					LayerId + 1,
+					AllottedGeometry.ToPaintGeometry(FVector2D(EndColumn - FirstColumn, FMath::Max(1.0, Bottom - Top)), FSlateLayoutTransform(FVector2D(FirstColumn, Top))),
+					WhiteBrush,
+					ESlateDrawEffect::None,
+					Color);
+			};
+
+			int32 RunStart = INDEX_NONE;
+			FMidiOverviewSummary::FBucket RunBucket;
+			int32 RunAlphaStep = 0;
+			for (int32 Column = 0; Column < NumColumns; ++Column)
+			{
+				FMidiOverviewSummary::FBucket ColumnBucket;
+				const bool bHasNotes = Summary->GetRange(TrackIndex, FMath::FloorToInt32(Column * TicksPerColumn), FMath::FloorToInt32((Column + 1) * TicksPerColumn), ColumnBucket);
+				const int32 AlphaStep = bHasNotes ? GetAlphaStep(ColumnBucket) : 0;
+
+				const bool bContinuesRun = RunStart != INDEX_NONE && bHasNotes && AlphaStep == RunAlphaStep
+					&& ColumnBucket.LowestNoteNumber == RunBucket.LowestNoteNumber && ColumnBucket.HighestNoteNumber == RunBucket.HighestNoteNumber;
+				if (bContinuesRun)
+				{
+					continue;
+				}
+
+				if (RunStart != INDEX_NONE)
+				{
+					MakeRunBox(RunStart, Column, RunBucket, RunAlphaStep);
+				}
+				RunStart = bHasNotes ? Column : INDEX_NONE;
+				RunBucket = ColumnBucket;
+				RunAlphaStep = AlphaStep;
+			}
+			if (RunStart != INDEX_NONE)
+			{
+				MakeRunBox(RunStart, NumColumns, RunBucket, RunAlphaStep);
+			}
+		}
+	}
+
+	double ViewStartTick, ViewEndTick;
+	if (GetViewTickRange(ViewStartTick, ViewEndTick))
+	{
+		const double Left = FMath::Clamp(TickToLocalX(ViewStartTick, LocalSize.X), 0.0, LocalSize.X);
+		const double Right = FMath::Clamp(TickToLocalX(ViewEndTick, LocalSize.X), Left + 1.0, LocalSize.X);
+
+		FLinearColor FillColor = ViewportColor;
+		FillColor.A *= 0.15f;
+		FSlateDrawElement::MakeBox(
+			OutDrawElements,
+			LayerId + 2,
+			AllottedGeometry.ToPaintGeometry(FVector2D(Right - Left, LocalSize.Y), FSlateLayoutTransform(FVector2D(Left, 0.0))),
+			WhiteBrush,
+			ESlateDrawEffect::None,
+			FillColor);
+
+		const TArray<FVector2D> Outline = {
+			FVector2D(Left, 0.5),
+			FVector2D(Right - 0.5, 0.5),
+			FVector2D(Right - 0.5, LocalSize.Y - 0.5),
+			FVector2D(Left, LocalSize.Y - 0.5),
+			FVector2D(Left, 0.5)
+		};
+		FSlateDrawElement::MakeLines(
+			OutDrawElements,
+			LayerId + 3,
+			AllottedGeometry.ToPaintGeometry(),
+			Outline,
+			ESlateDrawEffect::None,
+			ViewportColor,
+			false,
+			1.0f);
+	}
+
+	return LayerId + 4;
+}
+
+FReply SMidiOverview::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin();
+	double ViewStartTick, ViewEndTick;
+	if (MouseEvent.GetEffectingButton() != EKeys::LeftMouseButton || !PinnedPianoroll.IsValid() || !GetViewTickRange(ViewStartTick, ViewEndTick))
+	{
+		return FReply::Unhandled();
+	}
+
+	const double Width = MyGeometry.GetLocalSize().X;
+	const double ClickTick = LocalXToTick(MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition()).X, Width);
+
+	// Grabbing the viewport keeps the grabbed point under the cursor, clicking outside centers the view on the click
+	if (ClickTick >= ViewStartTick && ClickTick <= ViewEndTick)
+	{
+		DragGrabTicks = ClickTick - ViewStartTick;
+	}
+	else
+	{
+		DragGrabTicks = (ViewEndTick - ViewStartTick) * 0.5;
+		PinnedPianoroll->ScrollToTick(ClickTick - DragGrabTicks);
+	}
+
+	bIsDragging = true;
+	return FReply::Handled().CaptureMouse(SharedThis(this));
+}
+
+FReply SMidiOverview::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const TSharedPtr<SMidiPianoroll> PinnedPianoroll = Pianoroll.Pin();
+	if (!bIsDragging || !PinnedPianoroll.IsValid())
+	{
+		return FReply::Unhandled();
+	}
+
+	const double Tick = LocalXToTick(MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition()).X, MyGeometry.GetLocalSize().X);
+	PinnedPianoroll->ScrollToTick(Tick - DragGrabTicks);
+	return FReply::Handled();
+}
+
+FReply SMidiOverview::OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	if (!bIsDragging || MouseEvent.GetEffectingButton() != EKeys::LeftMouseButton)
+	{
+		return FReply::Unhandled();
+	}
+
+	bIsDragging = false;
+	return FReply::Handled().ReleaseMouseCapture();
+}
+
+TOptional<EMouseCursor::Type> SMidiOverview::GetCursor() const
+{
+	return bIsDragging ? EMouseCursor::GrabHandClosed : EMouseCursor::GrabHand;
+}
@@ -2,12 +2,25 @@
 
 
 #include "SMidiPianoroll.h"
+#include "SMidiPlayhead.h"
 #include "SlateOptMacros.h"
 #include "Rendering/DrawElements.h"
 #include "Styling/CoreStyle.h"
 #include "Styling/AppStyle.h"
 #include "MidiFile/MutableMidiFile.h"
+#include "MidiFile/MidiQuantize.h"
+#include "MidiExtensionsStats.h"
+#include "HAL/IConsoleManager.h"
 
+DECLARE_CYCLE_STAT(TEXT("Pianoroll OnPaint"), STAT_MidiPianoroll_OnPaint, STATGROUP_MidiExtensions);
+DECLARE_CYCLE_STAT(TEXT("Pianoroll RecalculateGrid"), STAT_MidiPianoroll_RecalculateGrid, STATGROUP_MidiExtensions);
+DECLARE_CYCLE_STAT(TEXT("Pianoroll PaintGridLines"), STAT_MidiPianoroll_PaintGridLines, STATGROUP_MidiExtensions);
+DECLARE_CYCLE_STAT(TEXT("Pianoroll PaintTimeline"), STAT_MidiPianoroll_PaintTimeline, STATGROUP_MidiExtensions);
+DECLARE_CYCLE_STAT(TEXT("Pianoroll HitTest"), STAT_MidiPianoroll_HitTest, STATGROUP_MidiExtensions);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pianoroll Notes Considered"), STAT_MidiPianoroll_NotesConsidered, STATGROUP_MidiExtensions);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pianoroll Notes Culled"), STAT_MidiPianoroll_NotesCulled, STATGROUP_MidiExtensions);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pianoroll Draw Elements"), STAT_MidiPianoroll_DrawElements, STATGROUP_MidiExtensions);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pianoroll TickToMs Calls"), STAT_MidiPianoroll_TickToMsCalls, STATGROUP_MidiExtensions);
 
 namespace
 {
@@ -18,6 +31,14 @@ namespace
 
     // Constants for timeline marking density
     constexpr int32 MinPixelsPerBarText = 60;
+
+    // Live piano rolls, for the paint stats console command
+    TArray<const SMidiPianoroll*> LivePianorolls;
+
+    FAutoConsoleCommand DumpPaintStatsCommand(
+        TEXT("MidiPianoroll.DumpPaintStats"),
+        TEXT("Logs paint statistics for every live MIDI piano roll widget"),
+        FConsoleCommandDelegate::CreateStatic(&SMidiPianoroll::DumpAllPaintStats));
 };
 
 SLATE_IMPLEMENT_WIDGET(SMidiPianoroll)
@@ -25,7 +46,6 @@ void SMidiPianoroll::PrivateRegisterAttributes(FSlateAttributeInitializer& Attri
 {
 	SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION_WITH_NAME(AttributeInitializer, "Offset", Offset, EInvalidateWidgetReason::Paint);
 	SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION_WITH_NAME(AttributeInitializer, "Zoom", Zoom, EInvalidateWidgetReason::Paint);
-	SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION_WITH_NAME(AttributeInitializer, "VisualizationData", VisualizationData, EInvalidateWidgetReason::Paint);
 	SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION_WITH_NAME(AttributeInitializer, "TimeMode", TimeMode, EInvalidateWidgetReason::Paint);
 	SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION_WITH_NAME(AttributeInitializer, "GridPointType", GridPointType, EInvalidateWidgetReason::Paint);
 	SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION_WITH_NAME(AttributeInitializer, "EditMode", EditMode, EInvalidateWidgetReason::Paint);
@@ -41,7 +61,6 @@ void SMidiPianoroll::PrivateRegisterAttributes(FSlateAttributeInitializer& Attri
 SMidiPianoroll::SMidiPianoroll()
 	: Offset(*this, FVector2D::ZeroVector)
 	, Zoom(*this, FVector2D(1.0f, 1.0f))
-	, VisualizationData(*this, FMidiFileVisualizationData())
 	, TimeMode(*this, EMidiTrackTimeMode::TimeLinear)
 	, GridPointType(*this, EPianorollGridPointType::Bar)
 	, EditMode(*this, EPianorollEditMode::Select)
@@ -53,6 +72,33 @@ SMidiPianoroll::SMidiPianoroll()
 	, NoteDuration(*this, EMidiClockSubdivisionQuantization::SixteenthNote)
 	, bIsEditable(*this, false)
 {
+	LivePianorolls.Add(this);
+}
+
+SMidiPianoroll::~SMidiPianoroll()
+{
+	LivePianorolls.RemoveSingleSwap(this);
+}
+
+void SMidiPianoroll::DumpAllPaintStats()
+{
+	UE_LOG(LogTemp, Log, TEXT("MIDI piano roll paint stats (%d widgets):"), LivePianorolls.Num());
+	for (const SMidiPianoroll* Pianoroll : LivePianorolls)
+	{
+		const FPianorollPaintStats& Stats = Pianoroll->PaintStats;
+		const int32 NumTracks = Pianoroll->LinkedMidiData.IsValid() ? Pianoroll->LinkedMidiData->Tracks.Num() : 0;
+		UE_LOG(LogTemp, Log, TEXT("  [%p] tracks=%d paints=%llu last=%.3fms avg=%.3fms peak=%.3fms notes=%d culled=%d elements=%d tickToMs=%d"),
+			Pianoroll,
+			NumTracks,
+			Stats.PaintCount,
+			Stats.LastPaintMs,
+			Stats.PaintCount > 0 ? Stats.TotalPaintMs / Stats.PaintCount : 0.0,
+			Stats.PeakPaintMs,
+			Stats.NotesConsidered,
+			Stats.NotesCulled,
+			Stats.DrawElements,
+			Stats.TickToMsCalls);
+	}
 }
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
@@ -72,7 +118,7 @@ void SMidiPianoroll::Construct(const FArguments& InArgs)
 
 	Offset.Assign(*this, InArgs._Offset);
 	Zoom.Assign(*this, InArgs._Zoom);
-	VisualizationData.Assign(*this, InArgs._VisualizationData);
+	VisualizationData = InArgs._VisualizationData;
 	TimeMode.Assign(*this, InArgs._TimeMode);
 	GridPointType.Assign(*this, InArgs._GridPointType);
 	EditMode.Assign(*this, InArgs._EditMode);
@@ -84,13 +130,117 @@ void SMidiPianoroll::Construct(const FArguments& InArgs)
 	NoteDuration.Assign(*this, InArgs._NoteDuration);
 	bIsEditable.Assign(*this, InArgs._bIsEditable);
 
+	RebuildTrackVisualizationLookup();
+
+	// The playhead is the only child, it is painted over the notes and repaints on its own while playing
 	ChildSlot
 	[
-		SNullWidget::NullWidget
+		SAssignNew(PlayheadWidget, SMidiPlayhead)
+		.Color(PianorollStyle->PlayheadColor)
+		.TopOffset(TimelineHeight)
 	];
 }
+
+void SMidiPianoroll::SetPlaybackClock(TSharedPtr<const FMidiPlaybackClock, ESPMode::ThreadSafe> InPlaybackClock)
+{
+	PlaybackClock = MoveTemp(InPlaybackClock);
+
+	if (PlaybackClock.IsValid() && !PlayheadTimerHandle.IsValid())
+	{
+		PlayheadTimerHandle = RegisterActiveTimer(1.0f / PlayheadUpdateRate, FWidgetActiveTimerDelegate::CreateSP(this, &SMidiPianoroll::UpdatePlayhead));
+	}
+	else if (!PlaybackClock.IsValid())
+	{
+		if (PlayheadTimerHandle.IsValid())
+		{
+			UnRegisterActiveTimer(PlayheadTimerHandle.ToSharedRef());
+			PlayheadTimerHandle.Reset();
+		}
+		PlayheadWidget->SetPlayheadX(TOptional<double>());
+	}
+}
+
+void SMidiPianoroll::ScrollToTick(double Tick)
+{
+	const FVector2D CurrentOffset = Offset.Get();
+	const FVector2D NewOffset = ClampOffset(FVector2D(TickToPixel(Tick), CurrentOffset.Y), GetTickSpaceGeometry().GetLocalSize());
+	if (!FMath::IsNearlyEqual(NewOffset.X, CurrentOffset.X))
+	{
+		Offset.Set(*this, NewOffset);
+		OnViewChanged.Broadcast();
+	}
+}
+
+void SMidiPianoroll::RemapNoteIndices(TFunctionRef<int32(int32 TrackIndex, int32 NoteIndex)> GetNewNoteIndex)
+{
+	TSet<FNoteIdentifier> RemappedSelection;
+	RemappedSelection.Reserve(SelectedNotes.Num());
+	for (const FNoteIdentifier& NoteId : SelectedNotes)
+	{
+		const int32 NewNoteIndex = GetNewNoteIndex(NoteId.TrackIndex, NoteId.NoteIndex);
+		if (NewNoteIndex != INDEX_NONE)
+		{
+			RemappedSelection.Add({ NoteId.TrackIndex, NewNoteIndex });
+		}
+	}
+	SelectedNotes = MoveTemp(RemappedSelection);
+
+	// A drag keeps editing the same notes on every mouse move, so its start positions follow them too
+	TMap<FNoteIdentifier, FLinkedMidiNote> RemappedOriginals;
+	RemappedOriginals.Reserve(OriginalNotePositions.Num());
+	for (const TPair<FNoteIdentifier, FLinkedMidiNote>& OriginalNotePair : OriginalNotePositions)
+	{
+		const int32 NewNoteIndex = GetNewNoteIndex(OriginalNotePair.Key.TrackIndex, OriginalNotePair.Key.NoteIndex);
+		if (NewNoteIndex != INDEX_NONE)
+		{
+			RemappedOriginals.Add({ OriginalNotePair.Key.TrackIndex, NewNoteIndex }, OriginalNotePair.Value);
+		}
+	}
+	OriginalNotePositions = MoveTemp(RemappedOriginals);
+}
+
+EActiveTimerReturnType SMidiPianoroll::UpdatePlayhead(double InCurrentTime, float InDeltaTime)
+{
+	if (!PlaybackClock.IsValid())
+	{
+		PlayheadTimerHandle.Reset();
+		return EActiveTimerReturnType::Stop;
+	}
+
+	// The clock is published once per audio buffer, reading it extrapolates to now so the cursor moves every frame
+	const FMidiPlaybackClockSnapshot Snapshot = PlaybackClock->Read();
+	const double SongMs = PlaybackClock->GetSongPositionMs();
+	const double Tick = LinkedSongsMap.IsValid() ? LinkedSongsMap->MsToTick(SongMs) : 0.0;
+	double PlayheadX = TickToViewX(Tick);
+
+	const FVector2D ViewSize = GetTickSpaceGeometry().GetLocalSize();
+	const double AnchorX = ViewSize.X * PlayheadFollowAnchor;
+	if (bFollowPlayback && Snapshot.bIsPlaying && ViewSize.X > 0.0 && (PlayheadX > AnchorX || PlayheadX < 0.0))
+	{
+		const FVector2D CurrentOffset = Offset.Get();
+		const FVector2D NewOffset = ClampOffset(FVector2D(CurrentOffset.X + PlayheadX - AnchorX, CurrentOffset.Y), ViewSize);
+		if (!FMath::IsNearlyEqual(NewOffset.X, CurrentOffset.X))
+		{
+			Offset.Set(*this, NewOffset);
+			OnViewChanged.Broadcast();
+			PlayheadX = TickToViewX(Tick);
+		}
+	}
+
+	PlayheadWidget->SetPlayheadX(PlayheadX);
+	return EActiveTimerReturnType::Continue;
+}
 int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiPianoroll_OnPaint);
+    TRACE_CPUPROFILER_EVENT_SCOPE(SMidiPianoroll::OnPaint);
+
+    const double PaintStartTime = FPlatformTime::Seconds();
+    PaintStats.NotesConsidered = 0;
+    PaintStats.NotesCulled = 0;
+    PaintStats.DrawElements = 0;
+    PaintStats.TickToMsCalls = 0;
+
     const FSlateBrush* Brush = &PianorollStyle->GridBrush;
 	const FSlateBrush* NoteBrush = &PianorollStyle->NoteBrush;
 	const FSlateBrush* SelectedNoteBrush = &PianorollStyle->SelectedNoteBrush;
@@ -121,6 +271,7 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
                 continue;
             }
             
+            PaintStats.DrawElements++;
             if (IsAccidentalNote(i))
             {
                 FSlateDrawElement::MakeBox(
@@ -157,39 +308,18 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
     // Layer 3: Draw MIDI notes
     if(LinkedMidiData.IsValid())
     {
-        const FMidiFileVisualizationData& VisData = VisualizationData.Get();
         const float ContentStartY = TimelineHeight;
         
         for (int32 TrackIdx = 0; TrackIdx < LinkedMidiData->Tracks.Num(); ++TrackIdx)
         {
             const FMidiNotesTrack& Track = LinkedMidiData->Tracks[TrackIdx];
-            // Track color from visualization data if available
-            // Match by both TrackIndex AND ChannelIndex since one MIDI track can have multiple channels
-            FLinearColor TrackColor = FLinearColor::White;
-            int32 IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-            {
-                return Data.TrackIndex == Track.TrackIndex && Data.ChannelIndex == Track.ChannelIndex;
-            });
-
-            // If not found by exact match, fall back to just TrackIndex match (legacy/simple case)
-            if (IndexOfTrackVis == INDEX_NONE)
-            {
-                IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-                {
-                    return Data.TrackIndex == Track.TrackIndex;
-                });
-            }
-
-            const FMidiTrackVisualizationData* Vis = (IndexOfTrackVis != INDEX_NONE) 
-                ? &VisData.TrackVisualizations[IndexOfTrackVis] 
-                : nullptr;
-
-            if (Vis)
+            if (!IsTrackVisible(TrackIdx))
             {
-                if (!Vis->bIsVisible) { continue; }
-                TrackColor = Vis->TrackColor;
+                continue;
             }
+            const FLinearColor TrackColor = GetTrackColor(TrackIdx);
 
+            PaintStats.NotesConsidered += Track.Notes.Num();
             for (int32 NoteIdx = 0; NoteIdx < Track.Notes.Num(); ++NoteIdx)
             {
                 const FLinkedMidiNote& Note = Track.Notes[NoteIdx];
@@ -201,6 +331,7 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
 
                 if (X > LocalSize.X || X + W < 0.0f || Y > LocalSize.Y || Y + RowH < TimelineHeight)
                 {
+                    PaintStats.NotesCulled++;
                     continue;
                 }
 
@@ -210,6 +341,7 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
                // FLinearColor NoteColor = bIsSelected ? FLinearColor::White : TrackColor;
 
                 // Use TrackIdx for layer ordering to ensure consistent z-order
+                PaintStats.DrawElements++;
                 FSlateDrawElement::MakeBox(
                     OutDrawElements,
                     LayerId + TrackIdx,
@@ -236,6 +368,7 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
         );
         
         // Draw filled semi-transparent rectangle
+        PaintStats.DrawElements += 2;
         FSlateDrawElement::MakeBox(
             OutDrawElements,
             LayerId++,
@@ -273,25 +406,7 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
         if (TargetTrackIndex >= 0 && TargetTrackIndex < LinkedMidiData->Tracks.Num())
         {
             // Get track color for preview
-            const FMidiFileVisualizationData& VisData = VisualizationData.Get();
-            const FMidiNotesTrack& Track = LinkedMidiData->Tracks[TargetTrackIndex];
-            FLinearColor PreviewColor = FLinearColor::White;
-            
-            int32 IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-            {
-                return Data.TrackIndex == Track.TrackIndex && Data.ChannelIndex == Track.ChannelIndex;
-            });
-            if (IndexOfTrackVis == INDEX_NONE)
-            {
-                IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-                {
-                    return Data.TrackIndex == Track.TrackIndex;
-                });
-            }
-            if (IndexOfTrackVis != INDEX_NONE)
-            {
-                PreviewColor = VisData.TrackVisualizations[IndexOfTrackVis].TrackColor;
-            }
+            FLinearColor PreviewColor = GetTrackColor(TargetTrackIndex);
             
             // Make preview semi-transparent
             PreviewColor.A = 0.4f;
@@ -314,6 +429,7 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
             if (PreviewX <= LocalSize.X && PreviewX + PreviewW >= 0.0f && 
                 PreviewY <= LocalSize.Y && PreviewY + RowH >= TimelineHeight)
             {
+                PaintStats.DrawElements++;
                 FSlateDrawElement::MakeBox(
                     OutDrawElements,
                     LayerId++,
@@ -328,8 +444,17 @@ int32 SMidiPianoroll::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedG
 
     // Layer 6: Paint timeline header (on top of everything)
     LayerId = PaintTimeline(AllottedGeometry, OutDrawElements, LayerId);
- 
-    return LayerId;
+
+    PaintStats.PaintCount++;
+    PaintStats.LastPaintMs = (FPlatformTime::Seconds() - PaintStartTime) * 1000.0;
+    PaintStats.TotalPaintMs += PaintStats.LastPaintMs;
+    PaintStats.PeakPaintMs = FMath::Max(PaintStats.PeakPaintMs, PaintStats.LastPaintMs);
+    INC_DWORD_STAT_BY(STAT_MidiPianoroll_NotesConsidered, PaintStats.NotesConsidered);
+    INC_DWORD_STAT_BY(STAT_MidiPianoroll_NotesCulled, PaintStats.NotesCulled);
+    INC_DWORD_STAT_BY(STAT_MidiPianoroll_DrawElements, PaintStats.DrawElements);
+
+    // Children (the playhead) go over everything the roll painted
+    return SCompoundWidget::OnPaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
 }
 FReply SMidiPianoroll::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
 {
@@ -468,6 +593,7 @@ FReply SMidiPianoroll::OnMouseMove(const FGeometry& MyGeometry, const FPointerEv
             const FVector2D ClampedOffset = ClampOffset(NewOffset, MyGeometry.GetLocalSize());
             
             Offset.Set(*this, ClampedOffset);
+            OnViewChanged.Broadcast();
             bIsPanning = true;
             return FReply::Handled();
         }
@@ -523,7 +649,7 @@ FReply SMidiPianoroll::OnMouseButtonDown(const FGeometry& MyGeometry, const FPoi
                 NewNote.NoteOnTick = ClickTick;
                 NewNote.NoteOffTick = ClickTick + NoteDurationTicks;
                 NewNote.NoteNumber = ClickNoteNumber;
-                NewNote.Velocity = DefaultNoteVelocity.Get();
+                NewNote.Velocity = FLinkedMidiNote::ClampVelocity(DefaultNoteVelocity.Get());
                 
                 // Create an edit to add the note (use an invalid index to signal addition)
                 FNotesEditCallbackData Edit;
@@ -752,6 +878,7 @@ FReply SMidiPianoroll::OnMouseWheel(const FGeometry& MyGeometry, const FPointerE
     
     Zoom.Set(*this, NewZoom);
     Offset.Set(*this, ClampedOffset);
+    OnViewChanged.Broadcast();
     
     return FReply::Handled();
 }
@@ -818,6 +945,8 @@ double SMidiPianoroll::TickToPixel(double Tick) const
                 return (Tick * 0.5f) * Zoom.Get().X;
             }
             const FSongMaps& SongsMap = *LinkedSongsMap;
+            PaintStats.TickToMsCalls++;
+            INC_DWORD_STAT(STAT_MidiPianoroll_TickToMsCalls);
             const double Milliseconds = SongsMap.TickToMs(Tick);
             return Milliseconds * Zoom.Get().X;
         }
@@ -858,6 +987,9 @@ double SMidiPianoroll::PixelToTick(double Pixel) const
 
 void SMidiPianoroll::RecalculateGrid(const FGeometry& AllottedGeometry) const
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiPianoroll_RecalculateGrid);
+    TRACE_CPUPROFILER_EVENT_SCOPE(SMidiPianoroll::RecalculateGrid);
+
     GridPoints.Empty();
     
     const FVector2D LocalSize = AllottedGeometry.GetLocalSize();
@@ -1017,6 +1149,9 @@ bool SMidiPianoroll::ShouldShowBar(int32 BarNumber, EPianorollGridDensity Densit
 
 int32 SMidiPianoroll::PaintTimeline(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId) const
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiPianoroll_PaintTimeline);
+    TRACE_CPUPROFILER_EVENT_SCOPE(SMidiPianoroll::PaintTimeline);
+
     if (TimelineHeight <= 0.0f)
     {
         return LayerId;
@@ -1026,6 +1161,7 @@ int32 SMidiPianoroll::PaintTimeline(const FGeometry& AllottedGeometry, FSlateWin
     const FVector2D LocalOffset = Offset.Get();
     
     // Draw timeline background
+    PaintStats.DrawElements++;
     FSlateDrawElement::MakeBox(
         OutDrawElements,
         LayerId++,
@@ -1060,6 +1196,7 @@ int32 SMidiPianoroll::PaintTimeline(const FGeometry& AllottedGeometry, FSlateWin
             // Draw bar number text
             const FText BarText = FText::AsNumber(GridPoint.Bar);
             
+            PaintStats.DrawElements++;
             FSlateDrawElement::MakeText(
                 OutDrawElements,
                 LayerId,
@@ -1080,6 +1217,9 @@ int32 SMidiPianoroll::PaintTimeline(const FGeometry& AllottedGeometry, FSlateWin
 
 int32 SMidiPianoroll::PaintGridLines(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId) const
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiPianoroll_PaintGridLines);
+    TRACE_CPUPROFILER_EVENT_SCOPE(SMidiPianoroll::PaintGridLines);
+
     const FVector2D LocalSize = AllottedGeometry.GetLocalSize();
     const FVector2D LocalOffset = Offset.Get();
     
@@ -1114,6 +1254,7 @@ int32 SMidiPianoroll::PaintGridLines(const FGeometry& AllottedGeometry, FSlateWi
         }
         
         // Draw vertical line from below timeline to bottom
+        PaintStats.DrawElements++;
         FSlateDrawElement::MakeLines(
             OutDrawElements,
             LayerId,
@@ -1148,15 +1289,8 @@ float SMidiPianoroll::GetContentWidth() const
         return 10000.0f;
     }
     
-    // Find the last note end tick
-    int32 LastTick = 0;
-    for (const FMidiNotesTrack& Track : LinkedMidiData->Tracks)
-    {
-        for (const FLinkedMidiNote& Note : Track.Notes)
-        {
-            LastTick = FMath::Max(LastTick, Note.NoteOffTick);
-        }
-    }
+    // The last note end tick is cached on the notes data and maintained as notes are edited
+    const int32 LastTick = LinkedMidiData->LastNoteOffTick;
     
     // Add some buffer (one bar worth)
     const int32 TicksPerBar = LinkedSongsMap.IsValid() 
@@ -1193,6 +1327,9 @@ FVector2D SMidiPianoroll::ClampOffset(const FVector2D& InOffset, const FVector2D
 
 void SMidiPianoroll::PerformMarqueeSelection(const FGeometry& MyGeometry, bool bAddToSelection)
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiPianoroll_HitTest);
+    TRACE_CPUPROFILER_EVENT_SCOPE(SMidiPianoroll::PerformMarqueeSelection);
+
     if (!LinkedMidiData.IsValid())
     {
         return;
@@ -1217,30 +1354,11 @@ void SMidiPianoroll::PerformMarqueeSelection(const FGeometry& MyGeometry, bool b
     {
         const FMidiNotesTrack& Track = LinkedMidiData->Tracks[TrackIdx];
 
-		// Need to check if track is visible in visualization data
-		const FMidiFileVisualizationData& VisData = VisualizationData.Get();
-        int32 IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-            {
-                return Data.TrackIndex == Track.TrackIndex && Data.ChannelIndex == Track.ChannelIndex;
-            });
-
-        // If not found by exact match, fall back to just TrackIndex match (legacy/simple case)
-        if (IndexOfTrackVis == INDEX_NONE)
+		// Skip tracks hidden in the visualization data
+        if (!IsTrackVisible(TrackIdx))
         {
-            IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-                {
-                    return Data.TrackIndex == Track.TrackIndex;
-                });
+            continue;
         }
-
-        const FMidiTrackVisualizationData* Vis = (IndexOfTrackVis != INDEX_NONE) 
-            ? &VisData.TrackVisualizations[IndexOfTrackVis] 
-			: nullptr;
-        if (Vis)
-        {
-            if (!Vis->bIsVisible) { continue; }
-		}
-
         
         for (int32 NoteIdx = 0; NoteIdx < Track.Notes.Num(); ++NoteIdx)
         {
@@ -1272,6 +1390,73 @@ void SMidiPianoroll::PerformMarqueeSelection(const FGeometry& MyGeometry, bool b
     }
 }
 
+void SMidiPianoroll::RebuildTrackVisualizationLookup()
+{
+    TrackVisualizationSlots.Reset();
+    if (!LinkedMidiData.IsValid() || VisualizationData == nullptr)
+    {
+        return;
+    }
+
+    const FMidiFileVisualizationData& VisData = *VisualizationData;
+    TrackVisualizationSlots.Reserve(LinkedMidiData->Tracks.Num());
+
+    for (const FMidiNotesTrack& Track : LinkedMidiData->Tracks)
+    {
+        // Match by both TrackIndex AND ChannelIndex since one MIDI track can have multiple channels
+        int32 Slot = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
+        {
+            return Data.TrackIndex == Track.TrackIndex && Data.ChannelIndex == Track.ChannelIndex;
+        });
+
+        // If not found by exact match, fall back to just TrackIndex match (legacy/simple case)
+        if (Slot == INDEX_NONE)
+        {
+            Slot = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
+            {
+                return Data.TrackIndex == Track.TrackIndex;
+            });
+        }
+
+        TrackVisualizationSlots.Add(Slot);
+    }
+}
+
+const FMidiTrackVisualizationData* SMidiPianoroll::GetTrackVisualization(int32 TrackIndex) const
+{
+    const int32 Slot = TrackVisualizationSlots.IsValidIndex(TrackIndex) ? TrackVisualizationSlots[TrackIndex] : INDEX_NONE;
+    if (VisualizationData == nullptr || !VisualizationData->TrackVisualizations.IsValidIndex(Slot))
+    {
+        return nullptr;
+    }
+    return &VisualizationData->TrackVisualizations[Slot];
+}
+
+void SMidiPianoroll::SetVisualizationData(const FMidiFileVisualizationData* InVisualizationData, uint32 InVersion)
+{
+    if (VisualizationData == InVisualizationData && VisualizationDataVersion == InVersion)
+    {
+        return;
+    }
+
+    VisualizationData = InVisualizationData;
+    VisualizationDataVersion = InVersion;
+    RebuildTrackVisualizationLookup();
+    Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+bool SMidiPianoroll::IsTrackVisible(int32 TrackIndex) const
+{
+    const FMidiTrackVisualizationData* Vis = GetTrackVisualization(TrackIndex);
+    return Vis == nullptr || Vis->bIsVisible;
+}
+
+FLinearColor SMidiPianoroll::GetTrackColor(int32 TrackIndex) const
+{
+    const FMidiTrackVisualizationData* Vis = GetTrackVisualization(TrackIndex);
+    return Vis ? Vis->TrackColor : FLinearColor::White;
+}
+
 bool SMidiPianoroll::IsNoteSelected(int32 TrackIndex, int32 NoteIndex) const
 {
     FNoteIdentifier NoteId;
@@ -1302,6 +1487,9 @@ int32 SMidiPianoroll::ScreenYToNoteNumber(float ScreenY, const FGeometry& Allott
 
 bool SMidiPianoroll::FindNoteAtPosition(const FVector2D& ScreenPos, const FGeometry& AllottedGeometry, int32& OutTrackIndex, int32& OutNoteIndex) const
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiPianoroll_HitTest);
+    TRACE_CPUPROFILER_EVENT_SCOPE(SMidiPianoroll::FindNoteAtPosition);
+
     if (!LinkedMidiData.IsValid())
     {
         return false;
@@ -1312,32 +1500,13 @@ bool SMidiPianoroll::FindNoteAtPosition(const FVector2D& ScreenPos, const FGeome
     const float ContentStartY = TimelineHeight;
     const float RowH = 10.0f * LocalZoom.Y;
     
-    const FMidiFileVisualizationData& VisData = VisualizationData.Get();
-    
     // Search through all tracks and notes
     for (int32 TrackIdx = 0; TrackIdx < LinkedMidiData->Tracks.Num(); ++TrackIdx)
     {
         const FMidiNotesTrack& Track = LinkedMidiData->Tracks[TrackIdx];
         
         // Check track visibility
-        int32 IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-        {
-            return Data.TrackIndex == Track.TrackIndex && Data.ChannelIndex == Track.ChannelIndex;
-        });
-        
-        if (IndexOfTrackVis == INDEX_NONE)
-        {
-            IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-            {
-                return Data.TrackIndex == Track.TrackIndex;
-            });
-        }
-        
-        const FMidiTrackVisualizationData* Vis = (IndexOfTrackVis != INDEX_NONE) 
-            ? &VisData.TrackVisualizations[IndexOfTrackVis] 
-            : nullptr;
-            
-        if (Vis && !Vis->bIsVisible)
+        if (!IsTrackVisible(TrackIdx))
         {
             continue;
         }
@@ -1378,14 +1547,15 @@ int32 SMidiPianoroll::SnapTickToGrid(int32 Tick) const
         return FMath::RoundToInt((float)Tick / SnapInterval) * SnapInterval;
     }
     
-    // Use GridSubdivision for the snap interval
-    const int32 SnapInterval = LinkedSongsMap->SubdivisionToMidiTicks(GridSubdivision.Get(), 0);
-    
-    return FMath::RoundToInt((float)Tick / SnapInterval) * SnapInterval;
+    // Snap to the grid of the time signature at the tick rather than the one at the start of the song
+    return FMidiQuantizer::SnapTickToGrid(*LinkedSongsMap, Tick, GridSubdivision.Get());
 }
 
 SMidiPianoroll::ENoteResizeEdge SMidiPianoroll::GetNoteEdgeAtPosition(const FVector2D& ScreenPos, const FGeometry& AllottedGeometry, int32& OutTrackIndex, int32& OutNoteIndex) const
 {
+    SCOPE_CYCLE_COUNTER(STAT_MidiPianoroll_HitTest);
+    TRACE_CPUPROFILER_EVENT_SCOPE(SMidiPianoroll::GetNoteEdgeAtPosition);
+
     if (!LinkedMidiData.IsValid())
     {
         return ENoteResizeEdge::None;
@@ -1399,31 +1569,12 @@ SMidiPianoroll::ENoteResizeEdge SMidiPianoroll::GetNoteEdgeAtPosition(const FVec
     // Edge detection threshold in pixels
     constexpr float EdgeThreshold = 6.0f;
     
-    const FMidiFileVisualizationData& VisData = VisualizationData.Get();
-    
     for (int32 TrackIdx = 0; TrackIdx < LinkedMidiData->Tracks.Num(); ++TrackIdx)
     {
         const FMidiNotesTrack& Track = LinkedMidiData->Tracks[TrackIdx];
         
         // Check track visibility
-        int32 IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-        {
-            return Data.TrackIndex == Track.TrackIndex && Data.ChannelIndex == Track.ChannelIndex;
-        });
-        
-        if (IndexOfTrackVis == INDEX_NONE)
-        {
-            IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-            {
-                return Data.TrackIndex == Track.TrackIndex;
-            });
-        }
-        
-        const FMidiTrackVisualizationData* Vis = (IndexOfTrackVis != INDEX_NONE) 
-            ? &VisData.TrackVisualizations[IndexOfTrackVis] 
-            : nullptr;
-            
-        if (Vis && !Vis->bIsVisible)
+        if (!IsTrackVisible(TrackIdx))
         {
             continue;
         }
@@ -1477,6 +1628,14 @@ FReply SMidiPianoroll::OnKeyDown(const FGeometry& MyGeometry, const FKeyEvent& I
         }
     }
     
+    // Handle Up/Down to transpose the selection, by an octave with Shift
+    if ((InKeyEvent.GetKey() == EKeys::Up || InKeyEvent.GetKey() == EKeys::Down) && SelectedNotes.Num() > 0 && OnTransformSelectedNotes.IsBound())
+    {
+        const int32 Semitones = InKeyEvent.IsShiftDown() ? 12 : 1;
+        OnTransformSelectedNotes.Execute(FMidiNoteTransform::MakeTranspose(InKeyEvent.GetKey() == EKeys::Up ? Semitones : -Semitones));
+        return FReply::Handled();
+    }
+    
     // Handle Escape to clear selection
     if (InKeyEvent.GetKey() == EKeys::Escape)
     {
@@ -1490,31 +1649,13 @@ FReply SMidiPianoroll::OnKeyDown(const FGeometry& MyGeometry, const FKeyEvent& I
         if (LinkedMidiData.IsValid())
         {
             SelectedNotes.Empty();
-            const FMidiFileVisualizationData& VisData = VisualizationData.Get();
             
             for (int32 TrackIdx = 0; TrackIdx < LinkedMidiData->Tracks.Num(); ++TrackIdx)
             {
                 const FMidiNotesTrack& Track = LinkedMidiData->Tracks[TrackIdx];
                 
                 // Check visibility
-                int32 IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-                {
-                    return Data.TrackIndex == Track.TrackIndex && Data.ChannelIndex == Track.ChannelIndex;
-                });
-                
-                if (IndexOfTrackVis == INDEX_NONE)
-                {
-                    IndexOfTrackVis = VisData.TrackVisualizations.IndexOfByPredicate([&Track](const FMidiTrackVisualizationData& Data)
-                    {
-                        return Data.TrackIndex == Track.TrackIndex;
-                    });
-                }
-                
-                const FMidiTrackVisualizationData* Vis = (IndexOfTrackVis != INDEX_NONE) 
-                    ? &VisData.TrackVisualizations[IndexOfTrackVis] 
-                    : nullptr;
-                    
-                if (Vis && !Vis->bIsVisible)
+                if (!IsTrackVisible(TrackIdx))
                 {
                     continue;
                 }
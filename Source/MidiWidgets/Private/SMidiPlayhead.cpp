@@ -0,0 +1,44 @@
+// Copyright Amir Ben-Kiki 2025
+
+#include "SMidiPlayhead.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/AppStyle.h"
+
+void SMidiPlayhead::Construct(const FArguments& InArgs)
+{
+	Color = InArgs._Color;
+	Thickness = InArgs._Thickness;
+	TopOffset = InArgs._TopOffset;
+	SetVisibility(EVisibility::HitTestInvisible);
+}
+
+void SMidiPlayhead::SetPlayheadX(TOptional<double> InPlayheadX)
+{
+	// Sub-pixel moves below what the line can show are not worth a repaint
+	const bool bChanged = InPlayheadX.IsSet() != PlayheadX.IsSet()
+		|| (InPlayheadX.IsSet() && !FMath::IsNearlyEqual(InPlayheadX.GetValue(), PlayheadX.GetValue(), 0.1));
+	if (bChanged)
+	{
+		PlayheadX = InPlayheadX;
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
+
+int32 SMidiPlayhead::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	const FVector2D LocalSize = AllottedGeometry.GetLocalSize();
+	if (!PlayheadX.IsSet() || PlayheadX.GetValue() < -Thickness || PlayheadX.GetValue() > LocalSize.X + Thickness)
+	{
+		return LayerId;
+	}
+
+	FSlateDrawElement::MakeBox(
+		OutDrawElements,
+		LayerId,
+		AllottedGeometry.ToPaintGeometry(FVector2D(Thickness, FMath::Max(0.0, LocalSize.Y - TopOffset)), FSlateLayoutTransform(FVector2D(PlayheadX.GetValue() - Thickness * 0.5, TopOffset))),
+		FAppStyle::GetBrush("WhiteBrush"),
+		ESlateDrawEffect::None,
+		Color);
+
+	return LayerId + 1;
+}
@@ -0,0 +1,61 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MidiBenchmarkCommandlet.generated.h"
+
+class UMutableMidiFile;
+
+/**
+ * Headless benchmark for the MIDI data and piano roll hot paths, runs on synthetic MIDI files.
+ * 
+ * UnrealEditor-Cmd <Project> -run=MidiBenchmark -nullrhi [-Notes=1000,10000,100000,1000000] [-Tracks=1,16,128]
+ *     [-Iterations=5] [-Edits=1000] [-Seed=1234] [-Output=<path.csv>]
+ * 
+ * Results are written as CSV, one row per scenario, to Saved/Benchmarks unless -Output is given.
+ * The piano roll paint scenario brings up Slate with the null renderer when it is not running, so it also runs under
+ * -nullrhi. On machines without a display add -RenderOffScreen. If Slate still can't start, its rows are marked skipped.
+ */
+UCLASS()
+class MIDIWIDGETS_API UMidiBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMidiBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/** Creates a mutable MIDI file with NumNotes notes spread evenly over NumTracks tracks */
+	static UMutableMidiFile* CreateSyntheticMidiFile(int32 NumNotes, int32 NumTracks, int32 Seed);
+
+private:
+	struct FBenchmarkResult
+	{
+		FString Scenario;
+		int32 NumNotes = 0;
+		int32 NumTracks = 0;
+		int32 Iterations = 0;
+		double MeanMs = 0.0;
+		double MinMs = 0.0;
+		double MaxMs = 0.0;
+
+		/** Why the scenario did not run, empty if it did */
+		FString SkipReason;
+	};
+
+	TArray<FBenchmarkResult> Results;
+
+	/** Runs Body Iterations times, Setup runs before each iteration and is not timed */
+	void RunBenchmark(const FString& Scenario, int32 NumNotes, int32 NumTracks, int32 Iterations, TFunctionRef<void()> Setup, TFunctionRef<void()> Body);
+
+	/** Records a scenario that could not run in this environment, so it shows up in the results rather than missing */
+	void AddSkipped(const FString& Scenario, int32 NumNotes, int32 NumTracks, const FString& Reason);
+
+	/** Starts Slate with the null renderer for the offscreen paint pass, returns false if it could not be started */
+	bool InitializeOffscreenSlate();
+
+	bool WriteResults(const FString& OutputPath) const;
+};
@@ -0,0 +1,109 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Math/Interval.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiOverviewSummary.h"
+
+class UMidiFile;
+class FSongMaps;
+class FMidiNoteQueryIndex;
+struct FNotesEditCallbackData;
+struct FMidiNoteId;
+struct FMidiNoteTransform;
+struct FMidiQuantizeSettings;
+
+/**
+ * Data every view of one MIDI file needs, shared by all views of that file: the linked notes, a copy of the tempo
+ * map for Slate, a query index and the overview summary. Views get the model of a file from Get() and hold it by shared pointer, the
+ * model is destroyed with the last view releasing it, so memory and rebuild cost scale with open files, not widgets.
+ *
+ * Game thread only. For a mutable file the derived data is rebuilt lazily when its content version moves on, and
+ * OnChanged tells every view after each edit, whichever view made it.
+ */
+class MIDIWIDGETS_API FMidiFileViewModel : public TSharedFromThis<FMidiFileViewModel>
+{
+public:
+	/** The shared model of MidiFile, created on first use */
+	static TSharedRef<FMidiFileViewModel> Get(UMidiFile* MidiFile);
+
+	~FMidiFileViewModel();
+
+	FMidiFileViewModel(const FMidiFileViewModel&) = delete;
+	FMidiFileViewModel& operator=(const FMidiFileViewModel&) = delete;
+
+	UMidiFile* GetMidiFile() const { return MidiFile.Get(); }
+
+	/** Linked notes of the file, for a mutable file these are its own linked notes and follow its edits */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> GetNotesData();
+
+	/** Copy of the file's song maps, recopied only after the content changed */
+	TSharedPtr<FSongMaps, ESPMode::ThreadSafe> GetSongMaps();
+
+	/** Query index over GetNotesData(), built on first use and rebuilt after the notes were edited */
+	TSharedPtr<FMidiNoteQueryIndex, ESPMode::ThreadSafe> GetQueryIndex();
+
+	/** Bucketed summary of the notes for overviews, built on first use and updated in place after edits made through this model */
+	TSharedPtr<const FMidiOverviewSummary, ESPMode::ThreadSafe> GetOverviewSummary();
+
+	/**
+	 * Applies note edits to a mutable file, remembering the ticks they touch so the overview summary only
+	 * recomputes those. Edits made on the file directly are picked up too, with a full rebuild of the summary.
+	 * @return The ticks spanned by the old and new extents of the edited notes, unset if nothing was edited
+	 */
+	TOptional<FInt32Interval> ModifyNotes(const TArray<FNotesEditCallbackData>& Edits);
+
+	/** Transforms notes of a mutable file with its bulk TransformNotes, the dirty ticks come from the notes' old and new extents */
+	TOptional<FInt32Interval> TransformNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiNoteTransform& Transform);
+
+	/** Quantizes and humanizes notes of a mutable file as one ModifyNotes batch */
+	TOptional<FInt32Interval> QuantizeNotes(TConstArrayView<FMidiNoteId> NoteIds, const FMidiQuantizeSettings& Settings);
+
+	/** Ticks the file's latest change touched if it was made through this model, unset if unknown or not an edit */
+	TOptional<FInt32Interval> GetLastEditDirtyTicks() const;
+
+	/** Content version of the data the model currently holds, 0 for files that can't change */
+	uint32 GetContentVersion() const;
+
+	/** Broadcast after the file was edited, views refresh from the model */
+	FSimpleMulticastDelegate OnChanged;
+
+private:
+	explicit FMidiFileViewModel(UMidiFile* InMidiFile);
+
+	void HandleFileChanged();
+
+	/** Records the ticks an edit about to be made from FromVersion touches, for the summary and the views it notifies */
+	void BeginEdit(const TOptional<FInt32Interval>& DirtyTicks, uint32 FromVersion);
+
+	TWeakObjectPtr<UMidiFile> MidiFile;
+
+	/** Key of this model in Models, kept since MidiFile may already be gone when the model is destroyed */
+	TObjectKey<UMidiFile> ModelKey;
+
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> NotesData;
+
+	TSharedPtr<FSongMaps, ESPMode::ThreadSafe> SongMaps;
+	uint32 SongMapsVersion = 0;
+
+	TSharedPtr<FMidiNoteQueryIndex, ESPMode::ThreadSafe> QueryIndex;
+
+	TSharedPtr<FMidiOverviewSummary, ESPMode::ThreadSafe> OverviewSummary;
+	uint32 OverviewSummaryVersion = 0;
+
+	/** Ticks touched by the last edit made through this model and the content version it moved the file from */
+	TOptional<FInt32Interval> PendingSummaryDirtyTicks;
+	uint32 PendingSummaryFromVersion = 0;
+
+	/** Ticks touched by the last edit made through this model for views refreshing after it, and the content version it moved the file from */
+	TOptional<FInt32Interval> LastEditDirtyTicks;
+	uint32 LastEditFromVersion = 0;
+
+	FDelegateHandle FileChangedHandle;
+
+	/** Live models by file, entries are removed by the model's destructor */
+	static TMap<TObjectKey<UMidiFile>, FMidiFileViewModel*> Models;
+};
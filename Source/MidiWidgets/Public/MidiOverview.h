@@ -0,0 +1,65 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "MidiOverview.generated.h"
+
+class UMidiPianoroll;
+class SMidiOverview;
+
+/**
+ * Whole-song overview strip for a UMidiPianoroll. Shows the notes of the piano roll's file from the bucketed
+ * summary kept by the file's shared view model, and a viewport rectangle that follows and pans the piano roll.
+ */
+UCLASS(BlueprintType)
+class MIDIWIDGETS_API UMidiOverview : public UWidget
+{
+	GENERATED_BODY()
+
+public:
+	/** The piano roll whose file and view the overview shows */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MIDI", BlueprintSetter = SetPianoroll)
+	UMidiPianoroll* Pianoroll;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Appearance", BlueprintSetter = SetOverviewHeight, meta = (ClampMin = "8"))
+	float OverviewHeight = 48.0f;
+
+	/** Outline color of the rectangle marking the piano roll's view */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Appearance", BlueprintSetter = SetViewportColor)
+	FLinearColor ViewportColor = FLinearColor(1.0f, 1.0f, 1.0f, 0.8f);
+
+	UFUNCTION(BlueprintSetter)
+	void SetPianoroll(UMidiPianoroll* InPianoroll);
+
+	UFUNCTION(BlueprintSetter)
+	void SetOverviewHeight(float InOverviewHeight);
+
+	UFUNCTION(BlueprintSetter)
+	void SetViewportColor(FLinearColor InViewportColor);
+
+	TSharedRef<SWidget> RebuildWidget() override;
+
+	void SynchronizeProperties() override;
+
+	void ReleaseSlateResources(bool bReleaseChildren) override;
+
+#if WITH_EDITOR
+	void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	TSharedPtr<SMidiOverview> OverviewWidget;
+
+	/** Piano roll the refresh handler is bound to, may lag Pianoroll until the next refresh */
+	TWeakObjectPtr<UMidiPianoroll> BoundPianoroll;
+	FDelegateHandle PianorollRefreshedHandle;
+
+	void BindPianoroll();
+
+	void UnbindPianoroll();
+
+	/** Points the Slate overview at the piano roll's current Slate widget and summary */
+	void HandlePianorollRefreshed();
+};
@@ -0,0 +1,84 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Interval.h"
+#include "MidiFile/MidiNotesData.h"
+
+/**
+ * Coarse picture of a whole file for overview drawing: the song is cut into buckets of BucketTicks and every
+ * track keeps the pitch range and number of notes sounding in each bucket. A bucket is 4 bytes, so a file of any
+ * length summarizes into a few kilobytes per track and drawing it costs the same however many notes it holds.
+ */
+struct MIDIWIDGETS_API FMidiOverviewSummary
+{
+	struct FBucket
+	{
+		uint8 LowestNoteNumber = 127;
+		uint8 HighestNoteNumber = 0;
+
+		/** Notes sounding in the bucket, saturates rather than wraps */
+		uint16 NumNotes = 0;
+
+		bool IsEmpty() const { return NumNotes == 0; }
+
+		void Merge(const FBucket& Other)
+		{
+			LowestNoteNumber = FMath::Min(LowestNoteNumber, Other.LowestNoteNumber);
+			HighestNoteNumber = FMath::Max(HighestNoteNumber, Other.HighestNoteNumber);
+			NumNotes = static_cast<uint16>(FMath::Min<int32>(NumNotes + Other.NumNotes, TNumericLimits<uint16>::Max()));
+		}
+	};
+
+	/** Buckets a song is summarized into, longer songs get longer buckets rather than more */
+	static constexpr int32 TargetNumBuckets = 2048;
+
+	/** Shortest bucket, a sixteenth note at the Harmonix resolution */
+	static constexpr int32 MinBucketTicks = 120;
+
+	void Build(const FMidiNotesData& NotesData);
+
+	/**
+	 * Recomputes the buckets overlapping DirtyTicks after an edit, DirtyTicks must span the old and new extents of
+	 * every edited note. Falls back to Build when the tracks changed or the song outgrew the bucket size.
+	 */
+	void UpdateRange(const FMidiNotesData& NotesData, FInt32Interval DirtyTicks);
+
+	int32 GetBucketTicks() const { return BucketTicks; }
+
+	int32 GetNumBuckets() const { return NumBuckets; }
+
+	int32 GetNumTracks() const { return TrackBuckets.Num(); }
+
+	/** Ticks covered by the buckets */
+	int32 GetLengthTicks() const { return NumBuckets * BucketTicks; }
+
+	TConstArrayView<FBucket> GetTrackBuckets(int32 TrackIndex) const { return TrackBuckets[TrackIndex]; }
+
+	/** Merges the buckets of a track overlapping [StartTick, EndTick), returns false if they hold no notes */
+	bool GetRange(int32 TrackIndex, int32 StartTick, int32 EndTick, FBucket& OutBucket) const;
+
+	/** Largest note count of any bucket, to scale densities against */
+	int32 GetMaxNumNotes() const { return MaxNumNotes; }
+
+	/** Bumped on every Build and UpdateRange so widgets can tell when to repaint */
+	uint32 GetVersion() const { return Version; }
+
+private:
+	/** Adds the notes of a track overlapping buckets [FirstBucket, LastBucket] to those buckets */
+	void AddNotes(int32 TrackIndex, const FMidiNotesTrack& Track, int32 FirstBucket, int32 LastBucket);
+
+	void UpdateMaxNumNotes();
+
+	int32 BucketTicks = MinBucketTicks;
+	int32 NumBuckets = 0;
+	int32 MaxNumNotes = 0;
+	uint32 Version = 0;
+
+	/** Buckets of each track in FMidiNotesData order, all NumBuckets long */
+	TArray<TArray<FBucket>> TrackBuckets;
+
+	/** Longest note of each track seen so far, bounds how far before a dirty range AddNotes has to look */
+	TArray<int32> TrackMaxNoteTicks;
+};
@@ -6,6 +6,7 @@
 #include "Blueprint/UserWidget.h"
 #include "MidiPianorollWidgetStyle.h"
 #include "SMidiPianoroll.h"
+#include "MidiFile/MidiQuantize.h"
 #include "MidiPianoroll.generated.h"
 
 /**
@@ -23,14 +24,14 @@ public:
 	UPROPERTY(EditAnywhere, Category = "MIDI")
 	FMidiFileVisualizationData VisualizationData;
 
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI")
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI", BlueprintSetter = SetTimeDisplayMode)
 	EMidiTrackTimeMode TimeDisplayMode = EMidiTrackTimeMode::TimeLinear;
 
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI")
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI", BlueprintSetter = SetGridPointType)
 	EPianorollGridPointType GridPointType = EPianorollGridPointType::Subdivision;
 
 	/** Grid subdivision for visual grid lines (when GridPointType is Subdivision) */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI")
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI", BlueprintSetter = SetGridSubdivision)
 	EMidiClockSubdivisionQuantization GridSubdivision = EMidiClockSubdivisionQuantization::SixteenthNote;
 
 	/** The track index to edit when in paint mode. Set to -1 to allow editing any visible track. */
@@ -50,16 +51,25 @@ public:
 	int32 DefaultNoteDurationTicks = 480;
 
 	/** Whether to snap notes to the grid when editing */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI|Editing", meta = (EditCondition = "IsEditable"))
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI|Editing", BlueprintSetter = SetSnapToGrid, meta = (EditCondition = "IsEditable"))
 	bool bSnapToGrid = true;
 
 	/** Note duration quantization for painted notes */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI|Editing", meta = (EditCondition = "IsEditable"))
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI|Editing", BlueprintSetter = SetNoteDuration, meta = (EditCondition = "IsEditable"))
 	EMidiClockSubdivisionQuantization NoteDuration = EMidiClockSubdivisionQuantization::SixteenthNote;
 
+	/** Scroll the view to keep the playhead visible while playing */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MIDI|Playback", BlueprintSetter = SetFollowPlayback)
+	bool bFollowPlayback = true;
+
 	UPROPERTY(EditAnywhere, Category = "Appearance")
 	FMidiPianorollStyle PianorollStyle;
 
+	/** Velocity and controller lanes drawn under the piano roll, top to bottom */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Appearance", BlueprintSetter = SetLanes)
+	TArray<FMidiPianorollLane> Lanes;
+
+	/** Shows InMidiFile, the selection is cleared when it is a different file and kept when refreshing the same one */
 	UFUNCTION(BlueprintSetter)
 	void SetMidiFile(UMidiFile* InMidiFile);
 
@@ -75,6 +85,38 @@ public:
 	UFUNCTION(BlueprintSetter)
 	void SetDefaultNoteDurationTicks(int32 InDurationTicks);
 
+	UFUNCTION(BlueprintSetter)
+	void SetTimeDisplayMode(EMidiTrackTimeMode InTimeDisplayMode);
+
+	UFUNCTION(BlueprintSetter)
+	void SetGridPointType(EPianorollGridPointType InGridPointType);
+
+	UFUNCTION(BlueprintSetter)
+	void SetGridSubdivision(EMidiClockSubdivisionQuantization InGridSubdivision);
+
+	UFUNCTION(BlueprintSetter)
+	void SetSnapToGrid(bool bInSnapToGrid);
+
+	UFUNCTION(BlueprintSetter)
+	void SetNoteDuration(EMidiClockSubdivisionQuantization InNoteDuration);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFollowPlayback(bool bInFollowPlayback);
+
+	/** Show a playhead following the playback of a scheduler component, nullptr hides it */
+	UFUNCTION(BlueprintCallable, Category = "MIDI|Playback")
+	void SetPlaybackSource(class UMidiNoteEventSchedulerComponent* InScheduler);
+
+	/** Show a playhead following any playback clock, nullptr hides it */
+	void SetPlaybackClock(TSharedPtr<const FMidiPlaybackClock, ESPMode::ThreadSafe> InPlaybackClock);
+
+	UFUNCTION(BlueprintSetter)
+	void SetLanes(const TArray<FMidiPianorollLane>& InLanes);
+
+	/** Replace the per track visibility and colors */
+	UFUNCTION(BlueprintCallable, Category = "MIDI")
+	void SetVisualizationData(const FMidiFileVisualizationData& InVisualizationData);
+
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "MIDI")
 	void MakeEditableCopyOfLinkedMidiFile();
 
@@ -85,6 +127,30 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
 	void DeleteSelectedNotes();
 
+	/** Apply a tick/pitch/velocity transform to all currently selected notes in one batch */
+	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
+	void TransformSelectedNotes(const FMidiNoteTransform& Transform);
+
+	/** Transpose the selected notes by a number of semitones */
+	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
+	void TransposeSelectedNotes(int32 Semitones);
+
+	/** Move the selected notes in time by a number of ticks */
+	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
+	void ShiftSelectedNotes(int32 Ticks);
+
+	/** Stretch the selected notes in time around their earliest note-on */
+	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
+	void ScaleSelectedNotesTime(float Scale);
+
+	/** Scale the velocities of the selected notes */
+	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
+	void ScaleSelectedNotesVelocity(float Scale);
+
+	/** Quantize and humanize the selected notes in one batch */
+	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
+	void QuantizeSelectedNotes(const FMidiQuantizeSettings& Settings);
+
 	/** Clear the current note selection */
 	UFUNCTION(BlueprintCallable, Category = "MIDI|Editing")
 	void ClearSelection();
@@ -101,8 +167,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MIDI")
 	class UMidiFile* SaveMidiFileAsAsset(const FString& PackagePath, const FString& AssetName);
 
-	// Getter for attribute binding
-	const FMidiFileVisualizationData& GetVisualizationData() { return VisualizationData; }
+	const FMidiFileVisualizationData& GetVisualizationData() const { return VisualizationData; }
 
 	const EMidiTrackTimeMode GetTimeDisplayMode() const { return TimeDisplayMode; }
 
@@ -124,12 +189,73 @@ public:
 
 	TSharedRef<SWidget> RebuildWidget() override;
 
+	void SynchronizeProperties() override;
+
 	void ReleaseSlateResources(bool bReleaseChildren) override;
 
+	/** The Slate piano roll, null until the widget is built */
+	TSharedPtr<SMidiPianoroll> GetPianorollWidget() const { return PianorollWidget; }
+
+	/** Model of the displayed file shared with other views of it, null until the widget shows a file */
+	TSharedPtr<class FMidiFileViewModel> GetViewModel() const { return ViewModel; }
+
+	/** Broadcast after the Slate widget was rebuilt or pointed at new or edited data, for widgets following this one */
+	FSimpleMulticastDelegate OnDisplayRefreshed;
+
 #if WITH_EDITOR
 	void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
 private:
 	TSharedPtr<SMidiPianoroll> PianorollWidget;
+
+	TSharedPtr<class SVerticalBox> LanesBox;
+
+	TArray<TSharedPtr<class SMidiControllerLane>> LaneWidgets;
+
+	TSharedPtr<const FMidiPlaybackClock, ESPMode::ThreadSafe> PlaybackClock;
+
+	/** SetMidiFile for refreshes after an edit, DirtyTicks bounds the ticks the edit touched so lanes can update in place */
+	void SetMidiFileInternal(UMidiFile* InMidiFile, TOptional<FInt32Interval> DirtyTicks);
+
+	/** Recreates the lane widgets from Lanes */
+	void RebuildLaneWidgets();
+
+	/** Model of LinkedMidiFile shared with every other view of the same file, null without a file */
+	TSharedPtr<class FMidiFileViewModel> ViewModel;
+
+	FDelegateHandle ViewModelChangedHandle;
+
+	/** Set while this widget edits the file, its own edits refresh it directly rather than through the model */
+	bool bIsApplyingEdit = false;
+
+	/** Points ViewModel at the model of LinkedMidiFile, subscribing to its changes */
+	void UpdateViewModel();
+
+	void ReleaseViewModel();
+
+	/** Refreshes the display after another view edited the file */
+	void HandleViewModelChanged();
+
+	/**
+	 * Moves the widget's selection to the indices its notes have after the file's last edit. Every view of the file
+	 * keeps its own selection, edits made in another view only remap it.
+	 */
+	void RemapSelectionAfterEdit();
+
+	/** Notes shown by the Slate widget, shared through the view model with other views of the file */
+	TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> GetDisplayMidiData();
+
+	/** Rebuilds VisualizationData from MidiData unless it was already built for this file and content version */
+	void UpdateVisualizationDataForContent(FMidiNotesData& MidiData);
+
+	/** File and content version VisualizationData was last built for */
+	TWeakObjectPtr<UMidiFile> VisualizationDataSource;
+	uint32 VisualizationDataContentVersion = 0;
+
+	/** Bumped whenever VisualizationData changes so the Slate widget knows to rebuild its track lookup */
+	uint32 VisualizationDataVersion = 0;
+
+	/** Marks VisualizationData as changed and pushes it to the Slate widget */
+	void PushVisualizationData();
 };
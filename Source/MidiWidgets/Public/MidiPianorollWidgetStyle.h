@@ -5,11 +5,11 @@
 #include "CoreMinimal.h"
 #include "Styling/SlateWidgetStyle.h"
 #include "Styling/SlateWidgetStyleContainerBase.h"
+#include "MidiFile/MidiNotesData.h"
 
 #include "MidiPianorollWidgetStyle.generated.h"
 
 class UMidiFile;
-struct FMidiNotesData;
 
 UENUM(BlueprintType)
 /** Grid point type for timeline markings */
@@ -105,6 +105,44 @@ struct MIDIWIDGETS_API FMidiFileVisualizationData
 
 };
 
+UENUM(BlueprintType)
+/** What a lane under the piano roll shows */
+enum class EMidiPianorollLaneType : uint8
+{
+	Velocity,
+	Controller
+};
+
+/** A velocity or controller lane shown under the piano roll */
+USTRUCT(BlueprintType)
+struct MIDIWIDGETS_API FMidiPianorollLane
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lane")
+	EMidiPianorollLaneType LaneType = EMidiPianorollLaneType::Velocity;
+
+	/** Velocity lanes: index of the track in the linked MIDI data. Controller lanes: index of the MIDI track in the file */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lane")
+	int32 TrackIndex = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lane", meta = (EditCondition = "LaneType == EMidiPianorollLaneType::Controller", ClampMin = "0", ClampMax = "15"))
+	int32 ChannelIndex = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lane", meta = (EditCondition = "LaneType == EMidiPianorollLaneType::Controller"))
+	EMidiControllerType ControllerType = EMidiControllerType::ControlChange;
+
+	/** Controller number, or note number for poly aftertouch */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lane", meta = (EditCondition = "LaneType == EMidiPianorollLaneType::Controller", ClampMin = "0", ClampMax = "127"))
+	int32 ControllerNumber = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lane", meta = (ClampMin = "16"))
+	float Height = 80.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lane", meta = (HideAlphaChannel))
+	FLinearColor Color = FLinearColor(0.3f, 0.7f, 1.0f);
+};
+
 /**
  * 
  */
@@ -137,6 +175,9 @@ struct MIDIWIDGETS_API FMidiPianorollStyle : public FSlateWidgetStyle
 	UPROPERTY(EditAnywhere, Category = "Appearance")
 	FSlateBrush SelectedNoteBrush;
 
+	UPROPERTY(EditAnywhere, Category = "Appearance", meta = (HideAlphaChannel))
+	FLinearColor PlayheadColor = FLinearColor(1.0f, 0.85f, 0.2f);
+
 };
 
 /**
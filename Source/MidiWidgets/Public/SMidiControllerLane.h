@@ -0,0 +1,94 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "Math/Interval.h"
+#include "MidiFile/MidiNotesData.h"
+#include "MidiPianorollWidgetStyle.h"
+
+class SMidiPianoroll;
+
+/**
+ * Min/max mip chain over a value array.
+ * Level L holds the min and max of consecutive blocks of 2^L values, so the range of any span of values
+ * is read from O(log n) blocks however many values it covers, at any zoom level.
+ */
+struct MIDIWIDGETS_API FMidiLaneDecimationCache
+{
+	void Build(TConstArrayView<int16> InValues);
+
+	/** Refreshes the blocks covering Values[First, Last], the value count must be unchanged since Build */
+	void UpdateRange(TConstArrayView<int16> InValues, int32 First, int32 Last);
+
+	/** Min and max of Values[First, Last), returns false for an empty span */
+	bool GetMinMax(int32 First, int32 Last, int16& OutMin, int16& OutMax) const;
+
+	int32 Num() const { return Values.Num(); }
+
+	int16 GetValue(int32 Index) const { return Values[Index]; }
+
+private:
+	TArray<int16> Values;
+
+	/** Levels 1 and up, level 0 is Values itself */
+	TArray<TArray<int16>> MinLevels;
+	TArray<TArray<int16>> MaxLevels;
+};
+
+/**
+ * A velocity or controller lane drawn under a SMidiPianoroll, sharing its horizontal view.
+ * Each pixel column draws the min/max of the points it covers from a decimation cache, and the whole lane
+ * is submitted as one background box and one polyline regardless of how many points it holds.
+ */
+class MIDIWIDGETS_API SMidiControllerLane : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMidiControllerLane)
+		: _Lane()
+	{}
+		/** The piano roll whose view this lane follows */
+		SLATE_ARGUMENT(TSharedPtr<SMidiPianoroll>, Pianoroll)
+		/** What the lane shows */
+		SLATE_ARGUMENT(FMidiPianorollLane, Lane)
+	SLATE_END_ARGS()
+
+	virtual ~SMidiControllerLane();
+
+	void Construct(const FArguments& InArgs);
+
+	/**
+	 * Points the lane at new or edited data.
+	 * When DirtyTicks is set and the lane has the same number of points as before, only the cache blocks
+	 * covering the dirty range are refreshed, otherwise the cache is rebuilt.
+	 */
+	void SetMidiData(TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> InMidiData, TOptional<FInt32Interval> DirtyTicks = TOptional<FInt32Interval>());
+
+	void SetLane(const FMidiPianorollLane& InLane);
+
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	void HandleViewChanged() { Invalidate(EInvalidateWidgetReason::Paint); }
+
+	/** Copies the lane's points out of the MIDI data, sorted by tick */
+	void ExtractPoints(TArray<int32>& OutTicks, TArray<int16>& OutValues) const;
+
+	/** Value range of the lane type, used to scale values to the lane height */
+	void GetValueRange(int32& OutMin, int32& OutMax) const;
+
+	/** Value in effect before the first point */
+	int32 GetDefaultValue() const;
+
+	TWeakPtr<SMidiPianoroll> Pianoroll;
+	FDelegateHandle ViewChangedHandle;
+
+	FMidiPianorollLane Lane;
+	TSharedPtr<const FMidiNotesData, ESPMode::ThreadSafe> MidiData;
+
+	/** Point ticks, sorted, parallel to the values in the cache */
+	TArray<int32> PointTicks;
+	FMidiLaneDecimationCache Cache;
+};
@@ -0,0 +1,80 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "MidiOverviewSummary.h"
+
+class SMidiPianoroll;
+
+/**
+ * Strip showing a whole song at once with the part visible in a SMidiPianoroll framed by a viewport rectangle.
+ * Dragging the rectangle or clicking anywhere in the strip pans the piano roll, and the rectangle follows the
+ * piano roll's pan and zoom. Notes are drawn from a FMidiOverviewSummary, one box per run of equal pixel columns
+ * and track, never from the notes themselves.
+ * Time runs linearly in ticks over the summary's length whatever the piano roll's time mode.
+ */
+class MIDIWIDGETS_API SMidiOverview : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMidiOverview)
+		: _Height(48.0f)
+		, _ViewportColor(FLinearColor(1.0f, 1.0f, 1.0f, 0.8f))
+	{}
+		/** The piano roll whose view the overview shows and drives */
+		SLATE_ARGUMENT(TSharedPtr<SMidiPianoroll>, Pianoroll)
+		/** Summary of the notes the piano roll shows, tracks are in the same order */
+		SLATE_ARGUMENT(TSharedPtr<const FMidiOverviewSummary, ESPMode::ThreadSafe>, Summary)
+		SLATE_ARGUMENT(float, Height)
+		/** Color of the viewport rectangle's outline, its fill uses a fraction of the alpha */
+		SLATE_ARGUMENT(FLinearColor, ViewportColor)
+	SLATE_END_ARGS()
+
+	virtual ~SMidiOverview();
+
+	void Construct(const FArguments& InArgs);
+
+	void SetPianoroll(TSharedPtr<SMidiPianoroll> InPianoroll);
+
+	/** Points the overview at a new or updated summary, summaries are updated in place so calls with the same one repaint too */
+	void SetSummary(TSharedPtr<const FMidiOverviewSummary, ESPMode::ThreadSafe> InSummary);
+
+	void SetHeight(float InHeight);
+
+	void SetViewportColor(const FLinearColor& InViewportColor);
+
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual TOptional<EMouseCursor::Type> GetCursor() const override;
+
+private:
+	void HandleViewChanged() { Invalidate(EInvalidateWidgetReason::Paint); }
+
+	/** Ticks spanned by the strip's width */
+	double GetLengthTicks() const;
+
+	double LocalXToTick(double LocalX, double Width) const { return Width > 0.0 ? LocalX / Width * GetLengthTicks() : 0.0; }
+
+	double TickToLocalX(double Tick, double Width) const { return Tick / GetLengthTicks() * Width; }
+
+	/** Ticks at the left and right edges of the piano roll, false without a piano roll */
+	bool GetViewTickRange(double& OutStartTick, double& OutEndTick) const;
+
+	TWeakPtr<SMidiPianoroll> Pianoroll;
+	FDelegateHandle ViewChangedHandle;
+
+	TSharedPtr<const FMidiOverviewSummary, ESPMode::ThreadSafe> Summary;
+
+	float Height = 48.0f;
+	FLinearColor ViewportColor;
+
+	bool bIsDragging = false;
+
+	/** Ticks between the left edge of the viewport and the point it was grabbed at */
+	double DragGrabTicks = 0.0;
+};
@@ -5,13 +5,16 @@
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
 #include "MidiFile/MidiNotesData.h"
+#include "MidiFile/MidiNoteTransform.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "HarmonixMidi/MidiFile.h"
 #include "HarmonixMidi/SongMaps.h"
 #include "MidiPianorollWidgetStyle.h"
 #include "Misc/Optional.h"
+#include "Playback/MidiPlaybackClock.h"
 
 struct FNotesEditCallbackData;
+class SMidiPlayhead;
 
 
 
@@ -34,6 +37,19 @@ enum class EPianorollGridDensity : uint8
 	VerySparseBars	// Show every 4th bar
 };
 
+/** Paint counters for a single piano roll, counts are for the most recent paint */
+struct FPianorollPaintStats
+{
+	uint64 PaintCount = 0;
+	double LastPaintMs = 0.0;
+	double TotalPaintMs = 0.0;
+	double PeakPaintMs = 0.0;
+	int32 NotesConsidered = 0;
+	int32 NotesCulled = 0;
+	int32 DrawElements = 0;
+	int32 TickToMsCalls = 0;
+};
+
 /**
  * 
  */
@@ -47,8 +63,8 @@ public:
 	{}
            /** The MIDI data to visualize */
            SLATE_ARGUMENT(TSharedPtr<FMidiNotesData>, LinkedMidiData)
-           /** The visualization data for the MIDI file - use ATTRIBUTE for live binding */
-           SLATE_ATTRIBUTE(FMidiFileVisualizationData, VisualizationData)
+           /** The visualization data for the MIDI file, shared by reference - the owner must outlive the widget and call SetVisualizationData when it changes */
+           SLATE_ARGUMENT(const FMidiFileVisualizationData*, VisualizationData)
         /** The song maps associated with the MIDI file */
         SLATE_ARGUMENT(TSharedPtr<FSongMaps>, LinkedSongsMap)
         /** The style set for this widget */
@@ -82,6 +98,7 @@ public:
 	SLATE_END_ARGS()
 
 	SMidiPianoroll();
+	virtual ~SMidiPianoroll();
 	/** Constructs this widget with InArgs */
 	void Construct(const FArguments& InArgs);
 
@@ -89,6 +106,12 @@ public:
 
     const FMidiPianorollStyle* PianorollStyle = nullptr;
 
+	/** Paint statistics for this widget */
+	const FPianorollPaintStats& GetPaintStats() const { return PaintStats; }
+
+	/** Logs the paint statistics of every live piano roll, bound to the MidiPianoroll.DumpPaintStats console command */
+	static void DumpAllPaintStats();
+
 	
 
 protected:
@@ -96,8 +119,11 @@ TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe> LinkedMidiData;
 
 TSharedPtr<FSongMaps, ESPMode::ThreadSafe> LinkedSongsMap;
 
-// Changed from TSharedPtr to TSlateAttribute for live binding
-TSlateAttribute<FMidiFileVisualizationData> VisualizationData;
+/** Visualization data owned by the caller, nullptr shows all tracks in white */
+const FMidiFileVisualizationData* VisualizationData = nullptr;
+
+/** Version of the visualization data the track lookup was last built against */
+uint32 VisualizationDataVersion = 0;
 
 
 	TSlateAttribute<FVector2D> Offset;
@@ -133,6 +159,20 @@ TSlateAttribute<FMidiFileVisualizationData> VisualizationData;
 	/** Current grid density based on zoom level */
 	mutable EPianorollGridDensity CurrentGridDensity = EPianorollGridDensity::Bars;
 
+	/** Counters gathered while painting */
+	mutable FPianorollPaintStats PaintStats;
+
+	TSharedPtr<const FMidiPlaybackClock, ESPMode::ThreadSafe> PlaybackClock;
+
+	TSharedPtr<SMidiPlayhead> PlayheadWidget;
+
+	TSharedPtr<FActiveTimerHandle> PlayheadTimerHandle;
+
+	bool bFollowPlayback = true;
+
+	/** Reads the clock, moves the playhead and follows it if needed */
+	EActiveTimerReturnType UpdatePlayhead(double InCurrentTime, float InDeltaTime);
+
 public:
 
 //SWidget interface
@@ -153,8 +193,44 @@ public:
         {
             LinkedSongsMap = InSongsMap;
         }
+        RebuildTrackVisualizationLookup();
+        Invalidate(EInvalidateWidgetReason::Paint);
 	}
 
+	/**
+	 * Points the widget at new or changed visualization data.
+	 * The owner bumps InVersion whenever the contents change, calls with an unchanged pointer and version are free.
+	 */
+	void SetVisualizationData(const FMidiFileVisualizationData* InVisualizationData, uint32 InVersion);
+
+	/** Push-style property setters, each invalidates only what the property affects */
+	void SetTimeMode(EMidiTrackTimeMode InTimeMode) { TimeMode.Set(*this, InTimeMode); OnViewChanged.Broadcast(); }
+	void SetGridPointType(EPianorollGridPointType InGridPointType) { GridPointType.Set(*this, InGridPointType); }
+	void SetEditMode(EPianorollEditMode InEditMode) { EditMode.Set(*this, InEditMode); }
+	void SetEditingTrackIndex(int32 InTrackIndex) { EditingTrackIndex.Set(*this, InTrackIndex); }
+	void SetDefaultNoteVelocity(int32 InVelocity) { DefaultNoteVelocity.Set(*this, InVelocity); }
+	void SetDefaultNoteDurationTicks(int32 InDurationTicks) { DefaultNoteDurationTicks.Set(*this, InDurationTicks); }
+	void SetGridSubdivision(EMidiClockSubdivisionQuantization InSubdivision) { GridSubdivision.Set(*this, InSubdivision); }
+	void SetSnapToGrid(bool bInSnapToGrid) { bSnapToGrid.Set(*this, bInSnapToGrid); }
+	void SetNoteDuration(EMidiClockSubdivisionQuantization InNoteDuration) { NoteDuration.Set(*this, InNoteDuration); }
+	void SetIsEditable(bool bInIsEditable) { bIsEditable.Set(*this, bInIsEditable); }
+
+	/**
+	 * Shows a playhead following Clock, nullptr hides it.
+	 * The position is read from the clock on an active timer and only the playhead layer is repainted as it moves,
+	 * unless following scrolls the view.
+	 */
+	void SetPlaybackClock(TSharedPtr<const FMidiPlaybackClock, ESPMode::ThreadSafe> InPlaybackClock);
+
+	/** While playing, keeps the playhead in view by scrolling once it passes PlayheadFollowAnchor of the width */
+	void SetFollowPlayback(bool bInFollowPlayback) { bFollowPlayback = bInFollowPlayback; }
+
+	/** Fraction of the view width the playhead is held at while following */
+	static constexpr double PlayheadFollowAnchor = 0.33;
+
+	/** Rate the playhead is updated at while a clock is set */
+	static constexpr float PlayheadUpdateRate = 120.0f;
+
 
 private:
 bool bIsPanning = false;
@@ -210,6 +286,15 @@ return HashCombine(GetTypeHash(Key.TrackIndex), GetTypeHash(Key.NoteIndex));
 TSet<FNoteIdentifier> SelectedNotes;
 TMap<FNoteIdentifier, FLinkedMidiNote> OriginalNotePositions;
 
+	/** Index into VisualizationData's TrackVisualizations for each track in LinkedMidiData, INDEX_NONE if the track has none */
+	TArray<int32> TrackVisualizationSlots;
+
+	/** Rebuilds TrackVisualizationSlots, called whenever the visualization data or the MIDI data changes */
+	void RebuildTrackVisualizationLookup();
+
+	/** Returns the visualization data for a track in LinkedMidiData, or nullptr if it has none */
+	const FMidiTrackVisualizationData* GetTrackVisualization(int32 TrackIndex) const;
+
 	/** Uses the current zoom, the song map, and the time mode to convert a tick to a pixel position */
 	double TickToPixel(double Tick) const;
 
@@ -262,12 +347,39 @@ TMap<FNoteIdentifier, FLinkedMidiNote> OriginalNotePositions;
 	static constexpr int32 MinNoteDurationTicks = 60;
 
 public:
+	/** Converts a tick to a horizontal position in the widget's local space, with the current pan and zoom */
+	double TickToViewX(double Tick) const { return TickToPixel(Tick) - Offset.Get().X; }
+
+	/** Converts a horizontal position in the widget's local space to a tick, with the current pan and zoom */
+	double ViewXToTick(double ViewX) const { return PixelToTick(ViewX); }
+
+	/** Tracks without visualization data are visible */
+	bool IsTrackVisible(int32 TrackIndex) const;
+
+	/** Tracks without visualization data are drawn white */
+	FLinearColor GetTrackColor(int32 TrackIndex) const;
+
+	/** Pans horizontally so Tick is at the left edge of the view, clamped to the content like any other pan */
+	void ScrollToTick(double Tick);
+
+	/** Broadcast whenever the pan, zoom or time mode changes, lets widgets that share the horizontal view follow it */
+	FSimpleMulticastDelegate OnViewChanged;
+
+	/** The notes data the widget displays, selection indices refer to it */
+	const TSharedPtr<FMidiNotesData, ESPMode::ThreadSafe>& GetMidiData() const { return LinkedMidiData; }
+
 	/** Gets the current selected notes */
 	const TSet<FNoteIdentifier>& GetSelectedNotes() const { return SelectedNotes; }
 
 	/** Clears all selected notes */
 	void ClearSelection() { SelectedNotes.Empty(); }
 
+	/**
+	 * Moves the selection and an in-flight drag to the notes' new indices after an edit reordered them, see
+	 * UMutableMidiFile::GetNoteIndexAfterLastEdit. Notes mapped to INDEX_NONE are dropped.
+	 */
+	void RemapNoteIndices(TFunctionRef<int32(int32 TrackIndex, int32 NoteIndex)> GetNewNoteIndex);
+
 	/** Delegate called when notes need to be modified */
 	DECLARE_DELEGATE_OneParam(FOnNotesModified, const TArray<struct FNotesEditCallbackData>&);
 	FOnNotesModified OnNotesModified;
@@ -276,6 +388,10 @@ public:
 	DECLARE_DELEGATE(FOnDeleteSelectedNotes);
 	FOnDeleteSelectedNotes OnDeleteSelectedNotes;
 
+	/** Delegate called when the selected notes should be transformed as a whole, e.g. transposed from the keyboard */
+	DECLARE_DELEGATE_OneParam(FOnTransformSelectedNotes, const FMidiNoteTransform&);
+	FOnTransformSelectedNotes OnTransformSelectedNotes;
+
 	virtual FReply OnKeyDown(const FGeometry& MyGeometry, const FKeyEvent& InKeyEvent) override;
 
 	virtual bool SupportsKeyboardFocus() const override { return true; }
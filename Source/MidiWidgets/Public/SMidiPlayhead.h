@@ -0,0 +1,41 @@
+// Copyright Amir Ben-Kiki 2025
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+
+/**
+ * The playback cursor of a SMidiPianoroll, a vertical line over the note area.
+ * Kept as its own widget so moving it invalidates only this layer, the notes under it are not repainted.
+ */
+class MIDIWIDGETS_API SMidiPlayhead : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMidiPlayhead)
+		: _Color(FLinearColor(1.0f, 0.85f, 0.2f))
+		, _Thickness(2.0f)
+		, _TopOffset(0.0f)
+	{}
+		SLATE_ARGUMENT(FLinearColor, Color)
+		SLATE_ARGUMENT(float, Thickness)
+		/** The line starts this far from the top, e.g. below a timeline header */
+		SLATE_ARGUMENT(float, TopOffset)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	/** Moves the line to a horizontal position in local space, unset hides it */
+	void SetPlayheadX(TOptional<double> InPlayheadX);
+
+	TOptional<double> GetPlayheadX() const { return PlayheadX; }
+
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override { return FVector2D::ZeroVector; }
+
+private:
+	TOptional<double> PlayheadX;
+	FLinearColor Color;
+	float Thickness = 2.0f;
+	float TopOffset = 0.0f;
+};